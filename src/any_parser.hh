@@ -0,0 +1,309 @@
+#pragma once
+
+#include "dodo.hh"
+#include <algorithm>
+#include <any>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <shared_mutex>
+#include <unordered_map>
+
+// Parsers and commands whose type is only known at run time, for commands registered by plugins when they are loaded. dodo::AnyParser and
+// dodo::AnyCommand can hold any parser or command. Small ones are stored inline and bigger ones on the heap. The result of parsing is a std::any
+// that holds the parse result of the wrapped parser. dodo::CommandRegistry is a set of commands that can change at run time and finds the command
+// to parse with a single hash lookup. dodo::RegisteredCommands lets a registry be one more command of a static command selector.
+//
+// dodo::CommandRegistry registry;
+// registry.add(dodo::Command("spawn", "Spawn an entity.", dodo_Opt(std::string, name)["--name"]));
+// auto const result = registry.parse(args);
+// auto const & spawn = std::any_cast<SpawnArgs const &>(*result);
+
+namespace dodo
+{
+
+    namespace detail
+    {
+        struct erased_storage
+        {
+            static constexpr size_t buffer_size = 64;
+
+            template <typename T>
+            static constexpr bool fits_in_buffer =
+                sizeof(T) <= buffer_size && alignof(T) <= alignof(std::max_align_t) && std::is_nothrow_move_constructible_v<T>;
+
+            void * get() noexcept { return heap ? heap : buffer; }
+            void const * get() const noexcept { return heap ? heap : buffer; }
+
+            alignas(std::max_align_t) std::byte buffer[buffer_size];
+            void * heap = nullptr;
+        };
+
+        struct lifetime_ops
+        {
+            void (*copy)(void const * from, erased_storage & to);
+            // Leaves from without an object.
+            void (*move)(erased_storage & from, erased_storage & to) noexcept;
+            void (*destroy)(erased_storage & storage) noexcept;
+        };
+
+        template <typename T>
+        constexpr lifetime_ops lifetime_ops_for = {
+            .copy = [](void const * from, erased_storage & to)
+            {
+                if constexpr (erased_storage::fits_in_buffer<T>)
+                    ::new (static_cast<void *>(to.buffer)) T(*static_cast<T const *>(from));
+                else
+                    to.heap = new T(*static_cast<T const *>(from));
+            },
+            .move = [](erased_storage & from, erased_storage & to) noexcept
+            {
+                if constexpr (erased_storage::fits_in_buffer<T>)
+                {
+                    T & object = *std::launder(reinterpret_cast<T *>(from.buffer));
+                    ::new (static_cast<void *>(to.buffer)) T(std::move(object));
+                    object.~T();
+                }
+                else
+                {
+                    to.heap = std::exchange(from.heap, nullptr);
+                }
+            },
+            .destroy = [](erased_storage & storage) noexcept
+            {
+                if constexpr (erased_storage::fits_in_buffer<T>)
+                    std::launder(reinterpret_cast<T *>(storage.buffer))->~T();
+                else
+                    delete static_cast<T *>(storage.heap);
+            },
+        };
+
+        // Owns an object of a type that is only known through Vtable, which must have a lifetime_ops member called lifetime.
+        template <typename Vtable>
+        struct erased_object
+        {
+            template <typename T>
+            erased_object(T object, Vtable const & vtable_) : vtable(&vtable_)
+            {
+                if constexpr (erased_storage::fits_in_buffer<T>)
+                    ::new (static_cast<void *>(storage.buffer)) T(std::move(object));
+                else
+                    storage.heap = new T(std::move(object));
+            }
+
+            erased_object(erased_object const & other) : vtable(other.vtable)
+            {
+                if (vtable)
+                    vtable->lifetime.copy(other.storage.get(), storage);
+            }
+
+            erased_object(erased_object && other) noexcept : vtable(std::exchange(other.vtable, nullptr))
+            {
+                if (vtable)
+                    vtable->lifetime.move(other.storage, storage);
+            }
+
+            erased_object & operator = (erased_object other) noexcept
+            {
+                reset();
+                vtable = std::exchange(other.vtable, nullptr);
+                if (vtable)
+                    vtable->lifetime.move(other.storage, storage);
+                return *this;
+            }
+
+            ~erased_object() { reset(); }
+
+            void reset() noexcept
+            {
+                if (vtable)
+                    vtable->lifetime.destroy(storage);
+                storage.heap = nullptr;
+                vtable = nullptr;
+            }
+
+            erased_storage storage;
+            Vtable const * vtable;
+        };
+
+        template <typename T>
+        auto erase_result(expected<T, std::string> result) noexcept -> expected<std::any, std::string>
+        {
+            static_assert(std::is_copy_constructible_v<T>, "The result of a type erased parser must be copy constructible to be stored in a std::any.");
+
+            if (!result)
+                return Error(std::move(result.error()));
+            return std::any(std::move(*result));
+        }
+
+        struct parser_vtable
+        {
+            lifetime_ops lifetime;
+            auto (*parse)(void const * parser, ArgsView args) noexcept -> expected<std::any, std::string>;
+            std::string (*to_string)(void const * parser, int indentation);
+        };
+
+        template <Parser P>
+        constexpr parser_vtable parser_vtable_for = {
+            .lifetime = lifetime_ops_for<P>,
+            .parse = [](void const * parser, ArgsView args) noexcept { return erase_result(static_cast<P const *>(parser)->parse(args)); },
+            .to_string = [](void const * parser, int indentation)
+            {
+                if constexpr (requires(P const & p) { {p.to_string(indentation)} -> std::convertible_to<std::string>; })
+                    return std::string(static_cast<P const *>(parser)->to_string(indentation));
+                else
+                    return std::string();
+            },
+        };
+
+        struct command_vtable
+        {
+            lifetime_ops lifetime;
+            bool (*match)(void const * command, std::string_view text) noexcept;
+            auto (*parse_command)(void const * command, ArgsView args) noexcept -> expected<std::any, std::string>;
+            std::string (*to_string)(void const * command, int indentation);
+            std::string_view (*name)(void const * command) noexcept;
+        };
+
+        template <CommandType C>
+        constexpr command_vtable command_vtable_for = {
+            .lifetime = lifetime_ops_for<C>,
+            .match = [](void const * command, std::string_view text) noexcept { return static_cast<C const *>(command)->match(text); },
+            .parse_command = [](void const * command, ArgsView args) noexcept { return erase_result(static_cast<C const *>(command)->parse_command(args)); },
+            .to_string = [](void const * command, int indentation) { return static_cast<C const *>(command)->to_string(indentation); },
+            .name = [](void const * command) noexcept { return command_name(*static_cast<C const *>(command)); },
+        };
+
+        struct string_hash
+        {
+            using is_transparent = void;
+            size_t operator () (std::string_view text) const noexcept { return std::hash<std::string_view>()(text); }
+        };
+    } // namespace detail
+
+    // Holds any parser. Parsers up to 64 bytes are stored inline. Moved from objects hold no parser and can only be assigned or destroyed.
+    struct AnyParser
+    {
+        using parse_result_type = std::any;
+
+        template <Parser P> requires(!std::same_as<P, AnyParser>)
+        AnyParser(P parser) : object(std::move(parser), detail::parser_vtable_for<P>) {}
+
+        auto parse(ArgsView args) const noexcept -> expected<std::any, std::string> { return object.vtable->parse(object.storage.get(), args); }
+        // Empty for parsers without to_string.
+        std::string to_string(int indentation = 0) const { return object.vtable->to_string(object.storage.get(), indentation); }
+
+    private:
+        detail::erased_object<detail::parser_vtable> object;
+    };
+
+    // Holds any command. Commands up to 64 bytes are stored inline. Moved from objects hold no command and can only be assigned or destroyed.
+    struct AnyCommand
+    {
+        using parse_result_type = std::any;
+
+        template <CommandType C> requires(!std::same_as<C, AnyCommand>)
+        AnyCommand(C command) : object(std::move(command), detail::command_vtable_for<C>) {}
+
+        bool match(std::string_view text) const noexcept { return object.vtable->match(object.storage.get(), text); }
+        auto parse_command(ArgsView args) const noexcept -> expected<std::any, std::string> { return object.vtable->parse_command(object.storage.get(), args); }
+        std::string to_string(int indentation) const { return object.vtable->to_string(object.storage.get(), indentation); }
+        // Empty for command types without a name member.
+        std::string_view name() const noexcept { return object.vtable->name(object.storage.get()); }
+
+    private:
+        detail::erased_object<detail::command_vtable> object;
+    };
+
+    // A set of named commands that can be added and removed at run time. Commands are looked up by name, which is the first argument. Adding and
+    // removing commands is safe while other threads parse, which only take a shared lock.
+    struct CommandRegistry
+    {
+        using parse_result_type = std::any;
+
+        // Fails if the command has no name or a command with the same name is already registered.
+        auto add(AnyCommand command) -> expected<void, std::string>
+        {
+            std::string_view const name = command.name();
+            if (name.empty())
+                return detail::make_error("Registered commands must have a name");
+
+            std::unique_lock const lock(mutex);
+            if (!commands.try_emplace(std::string(name), std::move(command)).second)
+                return detail::make_error("Command \"", name, "\" is already registered");
+            return success;
+        }
+
+        bool remove(std::string_view name)
+        {
+            std::unique_lock const lock(mutex);
+            auto const it = commands.find(name);
+            if (it == commands.end())
+                return false;
+            commands.erase(it);
+            return true;
+        }
+
+        bool contains(std::string_view name) const noexcept
+        {
+            std::shared_lock const lock(mutex);
+            return commands.find(name) != commands.end();
+        }
+
+        size_t size() const noexcept
+        {
+            std::shared_lock const lock(mutex);
+            return commands.size();
+        }
+
+        auto parse(ArgsView args) const noexcept -> expected<std::any, std::string>
+        {
+            if (args.size() <= 0)
+                return detail::make_error("Expected command.");
+
+            std::shared_lock const lock(mutex);
+            auto const it = commands.find(args[0]);
+            if (it == commands.end())
+                return detail::make_error("Unrecognized command \"", args[0], '"');
+            return it->second.parse_command(args);
+        }
+
+        // Commands are listed in alphabetical order.
+        std::string to_string(int indentation = 0) const
+        {
+            std::shared_lock const lock(mutex);
+
+            std::vector<decltype(commands)::const_pointer> sorted;
+            sorted.reserve(commands.size());
+            for (auto const & entry : commands)
+                sorted.push_back(&entry);
+            std::sort(sorted.begin(), sorted.end(), [](auto a, auto b) { return a->first < b->first; });
+
+            std::string out;
+            for (auto const entry : sorted)
+                out += entry->second.to_string(indentation);
+            return out;
+        }
+
+    private:
+        mutable std::shared_mutex mutex;
+        std::unordered_map<std::string, AnyCommand, detail::string_hash, std::equal_to<>> commands;
+    };
+
+    // Makes the commands of a registry one more command of a command selector, as in dodo::Command("help", ...) | dodo::RegisteredCommands(registry).
+    // Its parse result is a std::any. The registry must outlive it.
+    struct RegisteredCommands
+    {
+        using parse_result_type = std::any;
+
+        explicit RegisteredCommands(CommandRegistry const & registry_) noexcept : registry(&registry_) {}
+
+        bool match(std::string_view text) const noexcept { return registry->contains(text); }
+        auto parse_command(ArgsView args) const noexcept -> expected<std::any, std::string> { return registry->parse(args); }
+        std::string to_string(int indentation) const { return registry->to_string(indentation); }
+
+    private:
+        CommandRegistry const * registry;
+    };
+
+} // namespace dodo
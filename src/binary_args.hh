@@ -0,0 +1,239 @@
+#pragma once
+
+#include "dodo.hh"
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+#if defined(__linux__)
+    #include <algorithm>
+    #include <cerrno>
+    #include <climits>
+    #include <sys/uio.h>
+    #include <unistd.h>
+#endif
+
+// A binary format for arguments sent between processes, so that they do not need to be quoted to text and split again with
+// Args::from_command_line at every hop. A block is the size of the rest of the block, the number of arguments and the size of each argument,
+// as 32 bit integers in the byte order of the machine, followed by the bytes of the arguments one after another. Arguments may contain any
+// byte, including quotes, spaces and zeros, and are read back exactly as they were written. Reading a block returns arguments that point into
+// it, without copying them. On Linux, dodo::write_binary_args writes a block to a file descriptor with a single writev, straight from the memory
+// of the arguments, and dodo::read_binary_args reads one into a buffer that can be reused for the next block.
+//
+// dodo::write_binary_args(pipe_fd, dodo::Args(argc, argv));     // In the launcher.
+// std::string buffer;
+// auto const args = dodo::read_binary_args(pipe_fd, buffer);   // In the worker. args point into buffer.
+// auto const config = cli.parse(*args);
+
+namespace dodo
+{
+
+    namespace detail
+    {
+        constexpr size_t binary_args_word = sizeof(uint32_t);
+
+        // Size of the part of a block before the bytes of the arguments.
+        constexpr size_t binary_args_header_size(size_t count) noexcept
+        {
+            return (2 + count) * binary_args_word;
+        }
+
+        inline void write_binary_word(char * out, size_t value) noexcept
+        {
+            uint32_t const word = static_cast<uint32_t>(value);
+            std::memcpy(out, &word, binary_args_word);
+        }
+
+        // Blocks received from other processes are not necessarily aligned.
+        inline uint32_t read_binary_word(char const * in) noexcept
+        {
+            uint32_t word;
+            std::memcpy(&word, in, binary_args_word);
+            return word;
+        }
+
+        // Writes the header of the block of args to out, which must have room for binary_args_header_size(args.size()) bytes.
+        inline void write_binary_args_header(ArgsView args, size_t block_size, char * out) noexcept
+        {
+            write_binary_word(out, block_size - binary_args_word);
+            write_binary_word(out + binary_args_word, args.size());
+            for (size_t i = 0; i < args.size(); ++i)
+                write_binary_word(out + binary_args_header_size(i), args[i].size());
+        }
+
+        inline auto binary_args_too_big() -> Error<std::string>
+        {
+            return make_error("Arguments are too big to be written as binary arguments");
+        }
+    } // namespace detail
+
+    // Size of the block that holds args.
+    inline size_t binary_args_size(ArgsView args) noexcept
+    {
+        size_t size = detail::binary_args_header_size(args.size());
+        for (std::string_view const arg : args)
+            size += arg.size();
+        return size;
+    }
+
+    // Fails if the block would be 4 GiB or bigger.
+    inline auto to_binary_args(ArgsView args) -> expected<std::string, std::string>
+    {
+        size_t const size = binary_args_size(args);
+        if (size - detail::binary_args_word > std::numeric_limits<uint32_t>::max())
+            return detail::binary_args_too_big();
+
+        std::string block(size, '\0');
+        detail::write_binary_args_header(args, size, block.data());
+        char * out = block.data() + detail::binary_args_header_size(args.size());
+        for (std::string_view const arg : args)
+        {
+            std::memcpy(out, arg.data(), arg.size());
+            out += arg.size();
+        }
+        return block;
+    }
+
+    // Arguments that point into block, which must hold exactly one block and outlive them.
+    inline auto from_binary_args(std::string_view block) -> expected<Args, std::string>
+    {
+        if (block.size() < detail::binary_args_header_size(0) || detail::read_binary_word(block.data()) != block.size() - detail::binary_args_word)
+            return detail::make_error("Binary arguments have the wrong size");
+
+        size_t const count = detail::read_binary_word(block.data() + detail::binary_args_word);
+        if (count > (block.size() - detail::binary_args_header_size(0)) / detail::binary_args_word)
+            return detail::make_error("Binary arguments are truncated");
+
+        std::vector<std::string_view> args;
+        args.reserve(count);
+        size_t offset = detail::binary_args_header_size(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            size_t const size = detail::read_binary_word(block.data() + detail::binary_args_header_size(i));
+            if (size > block.size() - offset)
+                return detail::make_error("Binary arguments are truncated");
+            args.push_back(block.substr(offset, size));
+            offset += size;
+        }
+        if (offset != block.size())
+            return detail::make_error("Binary arguments have the wrong size");
+
+        return Args(std::move(args));
+    }
+
+#if defined(__linux__)
+
+    namespace detail
+    {
+        // Writes all of the buffers, retrying after partial writes and interruptions. Only lists with more buffers than IOV_MAX or writes that
+        // the kernel splits take more than one call.
+        inline bool write_all(int fd, iovec * buffers, size_t count) noexcept
+        {
+            while (count > 0)
+            {
+                ssize_t written = writev(fd, buffers, static_cast<int>(std::min<size_t>(count, IOV_MAX)));
+                if (written < 0)
+                {
+                    if (errno == EINTR)
+                        continue;
+                    return false;
+                }
+                while (count > 0 && static_cast<size_t>(written) >= buffers->iov_len)
+                {
+                    written -= buffers->iov_len;
+                    ++buffers;
+                    --count;
+                }
+                if (count > 0)
+                {
+                    buffers->iov_base = static_cast<char *>(buffers->iov_base) + written;
+                    buffers->iov_len -= written;
+                }
+            }
+            return true;
+        }
+
+        // Returns the number of bytes read, which is less than size only at the end of the file, or -1 on errors.
+        inline ssize_t read_all(int fd, char * out, size_t size) noexcept
+        {
+            size_t total = 0;
+            while (total < size)
+            {
+                ssize_t const bytes = read(fd, out + total, size - total);
+                if (bytes == 0)
+                    break;
+                if (bytes < 0)
+                {
+                    if (errno == EINTR)
+                        continue;
+                    return -1;
+                }
+                total += bytes;
+            }
+            return static_cast<ssize_t>(total);
+        }
+    } // namespace detail
+
+    namespace detail
+    {
+        // Gives the block of args to write_buffers as a list of buffers, which returns whether it wrote all of them. The header is in a
+        // separate buffer and the arguments are where they are, so their bytes are not copied.
+        template <typename WriteBuffers>
+        auto write_binary_args_with(ArgsView args, WriteBuffers write_buffers) -> expected<void, std::string>
+        {
+            size_t const size = binary_args_size(args);
+            if (size - binary_args_word > std::numeric_limits<uint32_t>::max())
+                return binary_args_too_big();
+
+            std::vector<char> header(binary_args_header_size(args.size()));
+            write_binary_args_header(args, size, header.data());
+
+            std::vector<iovec> buffers;
+            buffers.reserve(args.size() + 1);
+            buffers.push_back({header.data(), header.size()});
+            for (std::string_view const arg : args)
+                buffers.push_back({const_cast<char *>(arg.data()), arg.size()});
+
+            if (!write_buffers(buffers.data(), buffers.size()))
+                return make_error("Could not write binary arguments");
+            return success;
+        }
+    } // namespace detail
+
+    // Writes the block of args to fd without copying the bytes of the arguments.
+    inline auto write_binary_args(int fd, ArgsView args) -> expected<void, std::string>
+    {
+        return detail::write_binary_args_with(args, [fd](iovec * buffers, size_t count) { return detail::write_all(fd, buffers, count); });
+    }
+
+    // Reads a block from fd into buffer and returns arguments that point into it, which stay valid until buffer is changed. Reusing the same
+    // buffer for every block only allocates when a block is bigger than all the ones before it. Blocks bigger than max_size bytes are rejected
+    // before anything is allocated for them, so that a peer that is not trusted cannot make the reader allocate up to 4 GiB.
+    inline auto read_binary_args(int fd, std::string & buffer, size_t max_size = std::numeric_limits<size_t>::max()) -> expected<Args, std::string>
+    {
+        char prefix[detail::binary_args_word];
+        ssize_t const prefix_bytes = detail::read_all(fd, prefix, sizeof(prefix));
+        if (prefix_bytes < 0)
+            return detail::make_error("Could not read binary arguments");
+        if (prefix_bytes == 0)
+            return detail::make_error("No binary arguments to read");
+        if (prefix_bytes < static_cast<ssize_t>(sizeof(prefix)))
+            return detail::make_error("Binary arguments are truncated");
+
+        size_t const rest = detail::read_binary_word(prefix);
+        if (sizeof(prefix) + rest > max_size)
+            return detail::make_error("Binary arguments are too big to be read");
+        buffer.resize(sizeof(prefix) + rest);
+        std::memcpy(buffer.data(), prefix, sizeof(prefix));
+        ssize_t const rest_bytes = detail::read_all(fd, buffer.data() + sizeof(prefix), rest);
+        if (rest_bytes < 0)
+            return detail::make_error("Could not read binary arguments");
+        if (static_cast<size_t>(rest_bytes) < rest)
+            return detail::make_error("Binary arguments are truncated");
+
+        return from_binary_args(buffer);
+    }
+
+#endif // defined(__linux__)
+
+} // namespace dodo
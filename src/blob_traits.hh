@@ -0,0 +1,334 @@
+#pragma once
+
+#include "parse_traits.hh"
+#include <array>
+#include <cstdint>
+
+namespace dodo
+{
+
+	enum struct blob_encoding { hex, base64 };
+
+	// Binary value of a fixed amount of bytes, such as a key or a salt, written in hex or base64. Providing more or less bytes is an error.
+	template <blob_encoding Encoding, size_t N>
+	struct fixed_blob
+	{
+		std::array<uint8_t, N> bytes = {};
+
+		constexpr bool operator == (fixed_blob const & other) const noexcept = default;
+	};
+
+	// Binary value of any size, written in hex or base64. The size is computed from the text before decoding, so only one allocation is made.
+	template <blob_encoding Encoding>
+	struct blob
+	{
+		std::vector<uint8_t> bytes;
+
+		bool operator == (blob const & other) const noexcept = default;
+	};
+
+	template <size_t N> using hex_key = fixed_blob<blob_encoding::hex, N>;
+	template <size_t N> using base64_key = fixed_blob<blob_encoding::base64, N>;
+	using hex_blob = blob<blob_encoding::hex>;
+	using base64_blob = blob<blob_encoding::base64>;
+
+	namespace detail
+	{
+		// Position in the text of the first error found while decoding, and what is wrong with it.
+		struct decode_error
+		{
+			size_t offset;
+			std::string_view reason;
+		};
+
+		inline std::string decode_error_to_string(decode_error error, std::string_view text)
+		{
+			std::string result(error.reason);
+			if (error.offset < text.size())
+			{
+				result += " '";
+				result += text[error.offset];
+				result += '\'';
+			}
+			result += " at offset ";
+			result += std::to_string(error.offset);
+			return result;
+		}
+
+		// Characters that are not part of the alphabet have the high bit set, so that checking for errors can be done once for many characters.
+		constexpr uint8_t invalid_digit = 0x80;
+
+		constexpr std::array<uint8_t, 256> make_decode_table(std::string_view alphabet) noexcept
+		{
+			std::array<uint8_t, 256> table = {};
+			for (uint8_t & value : table)
+				value = invalid_digit;
+			for (size_t i = 0; i < alphabet.size(); ++i)
+				table[static_cast<unsigned char>(alphabet[i])] = static_cast<uint8_t>(i);
+			return table;
+		}
+
+		constexpr std::string_view hex_alphabet = "0123456789abcdef";
+		constexpr std::string_view base64_alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+		constexpr std::array<uint8_t, 256> hex_decode_table = []()
+		{
+			std::array<uint8_t, 256> table = make_decode_table(hex_alphabet);
+			for (uint8_t i = 0; i < 6; ++i)
+				table['A' + i] = static_cast<uint8_t>(10 + i);
+			return table;
+		}();
+		constexpr std::array<uint8_t, 256> base64_decode_table = make_decode_table(base64_alphabet);
+
+		constexpr uint8_t decode_digit(std::array<uint8_t, 256> const & table, char c) noexcept
+		{
+			return table[static_cast<unsigned char>(c)];
+		}
+
+		// Only reached once an invalid character is known to be in the text after the given position.
+		constexpr decode_error find_invalid_digit(std::array<uint8_t, 256> const & table, std::string_view text, size_t from) noexcept
+		{
+			while (from < text.size() && decode_digit(table, text[from]) != invalid_digit)
+				++from;
+			return decode_error{from, "Invalid character"};
+		}
+
+		template <blob_encoding Encoding>
+		struct blob_codec;
+
+		template <>
+		struct blob_codec<blob_encoding::hex>
+		{
+			static constexpr std::string_view hint = "hex";
+
+			static constexpr size_t encoded_size(size_t byte_count) noexcept { return byte_count * 2; }
+
+			static constexpr std::optional<size_t> decoded_size(std::string_view text) noexcept
+			{
+				if (text.size() % 2 != 0)
+					return std::nullopt;
+				return text.size() / 2;
+			}
+
+			static constexpr std::optional<decode_error> decode(std::string_view text, uint8_t * out) noexcept
+			{
+				if (text.size() % 2 != 0)
+					return decode_error{text.size(), "Odd number of hex digits"};
+
+				// Blocks of 16 digits, checked for errors once per block.
+				constexpr size_t block_size = 16;
+				size_t i = 0;
+				for (; i + block_size <= text.size(); i += block_size)
+				{
+					uint8_t invalid = 0;
+					for (size_t j = i; j < i + block_size; j += 2)
+					{
+						uint8_t const high = decode_digit(hex_decode_table, text[j]);
+						uint8_t const low = decode_digit(hex_decode_table, text[j + 1]);
+						invalid |= high | low;
+						out[j / 2] = static_cast<uint8_t>(high << 4 | low);
+					}
+					if (invalid & invalid_digit)
+						return find_invalid_digit(hex_decode_table, text, i);
+				}
+
+				for (; i < text.size(); i += 2)
+				{
+					uint8_t const high = decode_digit(hex_decode_table, text[i]);
+					uint8_t const low = decode_digit(hex_decode_table, text[i + 1]);
+					if ((high | low) & invalid_digit)
+						return find_invalid_digit(hex_decode_table, text, i);
+					out[i / 2] = static_cast<uint8_t>(high << 4 | low);
+				}
+
+				return std::nullopt;
+			}
+
+			static std::string encode(std::span<uint8_t const> bytes)
+			{
+				std::string result(encoded_size(bytes.size()), '\0');
+				for (size_t i = 0; i < bytes.size(); ++i)
+				{
+					result[2 * i] = hex_alphabet[bytes[i] >> 4];
+					result[2 * i + 1] = hex_alphabet[bytes[i] & 0xF];
+				}
+				return result;
+			}
+		};
+
+		// Standard alphabet of RFC 4648 with padding. Encodings with bits set after the end of the data are rejected, so each value has only one
+		// valid text.
+		template <>
+		struct blob_codec<blob_encoding::base64>
+		{
+			static constexpr std::string_view hint = "base64";
+
+			static constexpr size_t encoded_size(size_t byte_count) noexcept { return (byte_count + 2) / 3 * 4; }
+
+			static constexpr size_t padding(std::string_view text) noexcept
+			{
+				if (text.ends_with("=="))
+					return 2;
+				else if (text.ends_with('='))
+					return 1;
+				else
+					return 0;
+			}
+
+			static constexpr std::optional<size_t> decoded_size(std::string_view text) noexcept
+			{
+				if (text.size() % 4 != 0)
+					return std::nullopt;
+				return text.size() / 4 * 3 - padding(text);
+			}
+
+			static constexpr std::optional<decode_error> decode(std::string_view text, uint8_t * out) noexcept
+			{
+				if (text.size() % 4 != 0)
+					return decode_error{text.size(), "Length is not a multiple of 4"};
+
+				size_t const padding_size = padding(text);
+				size_t const full_quartets_end = padding_size > 0 ? text.size() - 4 : text.size();
+
+				for (size_t i = 0; i < full_quartets_end; i += 4, out += 3)
+				{
+					uint8_t const a = decode_digit(base64_decode_table, text[i]);
+					uint8_t const b = decode_digit(base64_decode_table, text[i + 1]);
+					uint8_t const c = decode_digit(base64_decode_table, text[i + 2]);
+					uint8_t const d = decode_digit(base64_decode_table, text[i + 3]);
+					if ((a | b | c | d) & invalid_digit)
+						return find_invalid_digit(base64_decode_table, text, i);
+
+					uint32_t const bits = uint32_t(a) << 18 | uint32_t(b) << 12 | uint32_t(c) << 6 | d;
+					out[0] = static_cast<uint8_t>(bits >> 16);
+					out[1] = static_cast<uint8_t>(bits >> 8);
+					out[2] = static_cast<uint8_t>(bits);
+				}
+
+				if (padding_size == 0)
+					return std::nullopt;
+
+				// Last quartet, with 2 or 3 characters of data.
+				std::string_view const last = text.substr(full_quartets_end, 4 - padding_size);
+				uint8_t digits[3] = {};
+				for (size_t i = 0; i < last.size(); ++i)
+				{
+					digits[i] = decode_digit(base64_decode_table, last[i]);
+					if (digits[i] & invalid_digit)
+						return decode_error{full_quartets_end + i, "Invalid character"};
+				}
+
+				uint32_t const bits = uint32_t(digits[0]) << 18 | uint32_t(digits[1]) << 12 | uint32_t(digits[2]) << 6;
+				uint32_t const unused_bits_mask = padding_size == 2 ? 0xFFFF : 0xFF;
+				if (bits & unused_bits_mask)
+					return decode_error{full_quartets_end + last.size() - 1, "Nonzero padding bits in character"};
+
+				out[0] = static_cast<uint8_t>(bits >> 16);
+				if (padding_size == 1)
+					out[1] = static_cast<uint8_t>(bits >> 8);
+
+				return std::nullopt;
+			}
+
+			static std::string encode(std::span<uint8_t const> bytes)
+			{
+				std::string result;
+				result.reserve(encoded_size(bytes.size()));
+
+				size_t i = 0;
+				for (; i + 3 <= bytes.size(); i += 3)
+				{
+					uint32_t const bits = uint32_t(bytes[i]) << 16 | uint32_t(bytes[i + 1]) << 8 | bytes[i + 2];
+					result += base64_alphabet[bits >> 18];
+					result += base64_alphabet[(bits >> 12) & 0x3F];
+					result += base64_alphabet[(bits >> 6) & 0x3F];
+					result += base64_alphabet[bits & 0x3F];
+				}
+
+				size_t const remaining = bytes.size() - i;
+				if (remaining > 0)
+				{
+					uint32_t const bits = uint32_t(bytes[i]) << 16 | (remaining == 2 ? uint32_t(bytes[i + 1]) << 8 : 0);
+					result += base64_alphabet[bits >> 18];
+					result += base64_alphabet[(bits >> 12) & 0x3F];
+					result += remaining == 2 ? base64_alphabet[(bits >> 6) & 0x3F] : '=';
+					result += '=';
+				}
+
+				return result;
+			}
+		};
+	} // namespace detail
+
+	template <blob_encoding Encoding, size_t N>
+	struct parse_traits<fixed_blob<Encoding, N>>
+	{
+		using codec = detail::blob_codec<Encoding>;
+
+		static constexpr std::string_view hint = codec::hint;
+
+		static constexpr std::optional<fixed_blob<Encoding, N>> parse(std::string_view text) noexcept
+		{
+			if (text.size() != codec::encoded_size(N) || codec::decoded_size(text) != N)
+				return std::nullopt;
+
+			fixed_blob<Encoding, N> result;
+			if (codec::decode(text, result.bytes.data()))
+				return std::nullopt;
+			return result;
+		}
+
+		static std::string parse_error(std::string_view text)
+		{
+			if (text.size() != codec::encoded_size(N))
+				return "Expected " + std::to_string(codec::encoded_size(N)) + " characters, found " + std::to_string(text.size());
+
+			// Text of the right length may still decode to more bytes than N, as in base64 without padding, so it is decoded into a buffer
+			// sized from the text.
+			std::vector<uint8_t> bytes(text.size());
+			if (std::optional<detail::decode_error> const error = codec::decode(text, bytes.data()))
+				return detail::decode_error_to_string(*error, text);
+
+			return "Expected " + std::to_string(N) + " bytes, found " + std::to_string(codec::decoded_size(text).value_or(0));
+		}
+
+		static std::string to_string(fixed_blob<Encoding, N> const & b)
+		{
+			return codec::encode(b.bytes);
+		}
+	};
+
+	template <blob_encoding Encoding>
+	struct parse_traits<blob<Encoding>>
+	{
+		using codec = detail::blob_codec<Encoding>;
+
+		static constexpr std::string_view hint = codec::hint;
+
+		static std::optional<blob<Encoding>> parse(std::string_view text) noexcept
+		{
+			std::optional<size_t> const size = codec::decoded_size(text);
+			if (!size)
+				return std::nullopt;
+
+			blob<Encoding> result;
+			result.bytes.resize(*size);
+			if (codec::decode(text, result.bytes.data()))
+				return std::nullopt;
+			return result;
+		}
+
+		static std::string parse_error(std::string_view text)
+		{
+			std::vector<uint8_t> bytes(text.size());
+			std::optional<detail::decode_error> const error = codec::decode(text, bytes.data());
+			return error ? detail::decode_error_to_string(*error, text) : std::string();
+		}
+
+		static std::string to_string(blob<Encoding> const & b)
+		{
+			return codec::encode(b.bytes);
+		}
+	};
+
+} // namespace dodo
@@ -0,0 +1,433 @@
+#pragma once
+
+#include "parse_traits.hh"
+#include "unit_traits.hh"
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <ratio>
+#include <type_traits>
+#include <utility>
+
+namespace dodo
+{
+
+	namespace detail
+	{
+		struct duration_unit
+		{
+			std::string_view name;
+			uint64_t num;   // Length of the unit in ticks of the target duration, as num / den.
+			uint64_t den;
+		};
+
+		template <typename Unit, typename Period>
+		constexpr duration_unit make_duration_unit(std::string_view name) noexcept
+		{
+			using ticks = std::ratio_divide<Unit, Period>;
+			return duration_unit{name, static_cast<uint64_t>(ticks::num), static_cast<uint64_t>(ticks::den)};
+		}
+
+		// Units from largest to smallest. Parsing requires units to appear in this order.
+		template <typename Period>
+		constexpr std::array<duration_unit, 7> duration_units = {{
+			make_duration_unit<std::ratio<86400>, Period>("d"),
+			make_duration_unit<std::ratio<3600>, Period>("h"),
+			make_duration_unit<std::ratio<60>, Period>("m"),
+			make_duration_unit<std::ratio<1>, Period>("s"),
+			make_duration_unit<std::milli, Period>("ms"),
+			make_duration_unit<std::micro, Period>("us"),
+			make_duration_unit<std::nano, Period>("ns"),
+		}};
+
+		// Parses the unit at the beginning of the text and removes it. Returns its index in duration_units, or -1.
+		constexpr int parse_duration_unit(std::string_view & text) noexcept
+		{
+			constexpr std::array<std::string_view, 9> names = {"ms", "us", "ns", "min", "d", "h", "m", "s", "\xC2\xB5s"};
+			constexpr std::array<int, 9> indices = {4, 5, 6, 2, 0, 1, 2, 3, 5};
+
+			for (size_t i = 0; i < names.size(); ++i)
+			{
+				if (text.starts_with(names[i]))
+				{
+					text.remove_prefix(names[i].size());
+					return indices[i];
+				}
+			}
+			return -1;
+		}
+
+		// Multiplies a decimal by num / den. Fails if the result overflows or is not a whole number.
+		constexpr std::optional<uint64_t> scale_decimal(unsigned_decimal number, uint64_t num, uint64_t den) noexcept
+		{
+			uint64_t const common = std::gcd(num, number.scale);
+			num /= common;
+			number.scale /= common;
+
+			std::optional<uint64_t> const divisor = checked_multiply(number.scale, den);
+			if (!divisor)
+				return number.digits == 0 ? std::optional<uint64_t>(0) : std::nullopt;
+
+			if (number.digits % *divisor != 0)
+				return std::nullopt;
+
+			return checked_multiply(number.digits / *divisor, num);
+		}
+
+		constexpr bool is_digit(char c) noexcept
+		{
+			return c >= '0' && c <= '9';
+		}
+
+		// Reads 8 bytes starting at text[i] as a little endian integer. Works in constant expressions, unlike memcpy.
+		constexpr uint64_t load_8_bytes(std::string_view text, size_t i) noexcept
+		{
+			uint64_t word = 0;
+			for (size_t j = 0; j < 8; ++j)
+				word |= uint64_t(static_cast<unsigned char>(text[i + j])) << (8 * j);
+			return word;
+		}
+
+		// Checks 8 characters at once against a pattern where 'd' is a digit and anything else must match exactly.
+		// After xoring with the pattern (with '0' in place of digits) every byte must be at most 9 where a digit is expected and 0 elsewhere.
+		// Returns the xored word, in which each digit position holds the value of the digit.
+		struct swar_pattern
+		{
+			uint64_t reference;
+			uint64_t headroom;  // 0x7F - maximum allowed value for each byte.
+
+			constexpr explicit swar_pattern(char const (&pattern)[9]) noexcept : reference(0), headroom(0)
+			{
+				for (size_t i = 0; i < 8; ++i)
+				{
+					bool const digit = pattern[i] == 'd';
+					reference |= uint64_t(static_cast<unsigned char>(digit ? '0' : pattern[i])) << (8 * i);
+					headroom |= uint64_t(digit ? 0x7F - 9 : 0x7F) << (8 * i);
+				}
+			}
+
+			constexpr std::optional<uint64_t> match(uint64_t word) const noexcept
+			{
+				constexpr uint64_t high_bits = 0x8080808080808080ull;
+				uint64_t const values = word ^ reference;
+				if (((values | (values + headroom)) & high_bits) != 0)
+					return std::nullopt;
+				return values;
+			}
+		};
+
+		constexpr int swar_byte(uint64_t values, int i) noexcept
+		{
+			return static_cast<int>((values >> (8 * i)) & 0xFF);
+		}
+
+		// Whole seconds and a fraction of a second in ticks of Duration, or nothing if the result does not fit in its rep or the fraction is not a
+		// whole number of ticks. The seconds are converted on their own, since a duration in nanoseconds only reaches some 292 years from its epoch.
+		template <typename Duration>
+		constexpr std::optional<Duration> seconds_to_duration(std::chrono::seconds whole, std::chrono::nanoseconds fraction) noexcept
+		{
+			using Rep = typename Duration::rep;
+
+			if constexpr (std::chrono::treat_as_floating_point_v<Rep>)
+				return std::chrono::duration_cast<Duration>(whole) + std::chrono::duration_cast<Duration>(fraction);
+			else
+			{
+				using ticks_per_second = std::ratio_divide<std::ratio<1>, typename Duration::period>;
+
+				// Before the epoch, the fraction is taken from the next second, so that both parts have the same sign and the earliest time
+				// point can be reached.
+				int64_t count = whole.count();
+				if (count < 0 && fraction.count() > 0)
+				{
+					count += 1;
+					fraction -= std::chrono::seconds(1);
+				}
+
+				if (count > std::numeric_limits<int64_t>::max() / ticks_per_second::num || count < std::numeric_limits<int64_t>::min() / ticks_per_second::num)
+					return std::nullopt;
+				int64_t const scaled = count * ticks_per_second::num;
+				if (scaled % ticks_per_second::den != 0)
+					return std::nullopt;
+				int64_t const whole_ticks = scaled / ticks_per_second::den;
+
+				Duration const fraction_ticks = std::chrono::duration_cast<Duration>(fraction);
+				if (fraction_ticks != fraction)
+					return std::nullopt;
+
+				int64_t const fraction_count = static_cast<int64_t>(fraction_ticks.count());
+				if ((fraction_count > 0 && whole_ticks > std::numeric_limits<int64_t>::max() - fraction_count)
+					|| (fraction_count < 0 && whole_ticks < std::numeric_limits<int64_t>::min() - fraction_count)
+					|| !std::in_range<Rep>(whole_ticks + fraction_count))
+					return std::nullopt;
+				return Duration(static_cast<Rep>(whole_ticks + fraction_count));
+			}
+		}
+	} // namespace detail
+
+	// Durations are written as a sequence of numbers with units, from largest to smallest, as in 2h30m, 150ms or 1.5s. Units are d, h, m (or min),
+	// s, ms, us (or µs) and ns. Numbers may have a fractional part as long as the result is a whole number of ticks of the duration type.
+	template <typename Rep, typename Period>
+	struct parse_traits<std::chrono::duration<Rep, Period>>
+	{
+		using duration = std::chrono::duration<Rep, Period>;
+
+		static constexpr std::string_view hint = "duration";
+
+		static constexpr std::optional<duration> parse(std::string_view text) noexcept
+		{
+			bool negative = false;
+			if constexpr (std::is_signed_v<Rep>)
+			{
+				if (text.starts_with('-'))
+				{
+					negative = true;
+					text.remove_prefix(1);
+				}
+			}
+
+			if (text == "0")
+				return duration::zero();
+
+			if constexpr (std::is_floating_point_v<Rep>)
+			{
+				Rep total = 0;
+				int previous_unit = -1;
+
+				do
+				{
+					std::optional<detail::unsigned_decimal> const number = detail::parse_unsigned_decimal(text);
+					int const unit = detail::parse_duration_unit(text);
+					if (!number || unit <= previous_unit)
+						return std::nullopt;
+					previous_unit = unit;
+
+					detail::duration_unit const & u = detail::duration_units<Period>[unit];
+					total += static_cast<Rep>(number->digits) / static_cast<Rep>(number->scale) * static_cast<Rep>(u.num) / static_cast<Rep>(u.den);
+				} while (!text.empty());
+
+				return duration(negative ? -total : total);
+			}
+			else
+			{
+				uint64_t total = 0;
+				int previous_unit = -1;
+
+				do
+				{
+					std::optional<detail::unsigned_decimal> const number = detail::parse_unsigned_decimal(text);
+					int const unit = detail::parse_duration_unit(text);
+					if (!number || unit <= previous_unit)
+						return std::nullopt;
+					previous_unit = unit;
+
+					detail::duration_unit const & u = detail::duration_units<Period>[unit];
+					std::optional<uint64_t> const ticks = detail::scale_decimal(*number, u.num, u.den);
+					if (!ticks || *ticks > std::numeric_limits<uint64_t>::max() - total)
+						return std::nullopt;
+					total += *ticks;
+				} while (!text.empty());
+
+				if (total > static_cast<uint64_t>(std::numeric_limits<Rep>::max()))
+					return std::nullopt;
+
+				Rep const count = static_cast<Rep>(total);
+				return duration(negative ? static_cast<Rep>(-count) : count);
+			}
+		}
+
+		static std::string to_string(duration d)
+		{
+			std::string result;
+
+			if (d < duration::zero())
+			{
+				result += '-';
+				d = -d;
+			}
+
+			if constexpr (std::is_floating_point_v<Rep>)
+			{
+				result += std::to_string(std::chrono::duration<double>(d).count());
+				result += 's';
+			}
+			else
+			{
+				auto remaining = static_cast<uint64_t>(d.count());
+				for (detail::duration_unit const & unit : detail::duration_units<Period>)
+				{
+					// Skip units that are not a whole number of ticks.
+					if (unit.den != 1 || remaining < unit.num)
+						continue;
+
+					result += std::to_string(remaining / unit.num);
+					result += unit.name;
+					remaining %= unit.num;
+				}
+
+				if (result.empty() || result == "-")
+					result += "0s";
+			}
+
+			return result;
+		}
+	};
+
+	// Timestamps in ISO 8601 format: 2021-03-14T15:09:26Z, with an optional fractional part of the second (2021-03-14T15:09:26.535Z) and an
+	// optional offset from UTC instead of Z (2021-03-14T16:09:26+01:00). A space may be used instead of the T. If the offset is omitted the time
+	// is assumed to be in UTC. A date without time (2021-03-14) is the midnight at the start of that day. No locale is involved.
+	template <typename Duration>
+	struct parse_traits<std::chrono::time_point<std::chrono::system_clock, Duration>>
+	{
+		using time_point = std::chrono::time_point<std::chrono::system_clock, Duration>;
+
+		static constexpr std::string_view hint = "timestamp";
+
+		static constexpr std::optional<time_point> parse(std::string_view text) noexcept
+		{
+			using namespace std::chrono;
+
+			constexpr size_t date_length = 10;     // YYYY-MM-DD
+			constexpr size_t date_time_length = 19; // YYYY-MM-DDTHH:MM:SS
+
+			if (text.size() != date_length && text.size() < date_time_length)
+				return std::nullopt;
+
+			// Pad the date so that it can be validated with the same three words.
+			char padded[date_time_length] = {'0', '0', '0', '0', '-', '0', '0', '-', '0', '0', 'T', '0', '0', ':', '0', '0', ':', '0', '0'};
+			for (size_t i = 0; i < std::min(text.size(), date_time_length); ++i)
+				padded[i] = text[i];
+			if (padded[10] == ' ')
+				padded[10] = 'T';
+			std::string_view const fixed(padded, date_time_length);
+
+			// YYYY-MM-DDTHH:MM:SS is checked with three overlapping 8 byte words, at 0, 8 and 11.
+			constexpr detail::swar_pattern pattern_0("dddd-dd-");
+			constexpr detail::swar_pattern pattern_8("ddTdd:dd");
+			constexpr detail::swar_pattern pattern_11("dd:dd:dd");
+
+			std::optional<uint64_t> const v0 = pattern_0.match(detail::load_8_bytes(fixed, 0));
+			std::optional<uint64_t> const v8 = pattern_8.match(detail::load_8_bytes(fixed, 8));
+			std::optional<uint64_t> const v11 = pattern_11.match(detail::load_8_bytes(fixed, 11));
+			if (!v0 || !v8 || !v11)
+				return std::nullopt;
+
+			auto const two_digits = [](uint64_t v, int i) { return detail::swar_byte(v, i) * 10 + detail::swar_byte(v, i + 1); };
+
+			int const y = two_digits(*v0, 0) * 100 + two_digits(*v0, 2);
+			int const mo = two_digits(*v0, 5);
+			int const d = two_digits(*v8, 0);
+			int const h = two_digits(*v11, 0);
+			int const mi = two_digits(*v11, 3);
+			int const s = two_digits(*v11, 6);
+
+			year_month_day const date{year(y), month(static_cast<unsigned>(mo)), day(static_cast<unsigned>(d))};
+			if (!date.ok() || h > 23 || mi > 59 || s > 59)
+				return std::nullopt;
+
+			sys_seconds whole = sys_days(date) + hours(h) + minutes(mi) + seconds(s);
+			nanoseconds fraction(0);
+
+			text.remove_prefix(std::min(text.size(), date_time_length));
+
+			// Fractional part of the second. Up to nanoseconds.
+			if (text.starts_with('.'))
+			{
+				text.remove_prefix(1);
+				int64_t nanos = 0;
+				int digits = 0;
+				while (!text.empty() && detail::is_digit(text[0]))
+				{
+					if (++digits > 9)
+						return std::nullopt;
+					nanos = nanos * 10 + (text[0] - '0');
+					text.remove_prefix(1);
+				}
+				if (digits == 0)
+					return std::nullopt;
+				for (; digits < 9; ++digits)
+					nanos *= 10;
+				fraction = nanoseconds(nanos);
+			}
+
+			// Offset from UTC.
+			if (text == "Z")
+				text.remove_prefix(1);
+			else if (text.size() == 6 && (text[0] == '+' || text[0] == '-') && text[3] == ':'
+				&& detail::is_digit(text[1]) && detail::is_digit(text[2]) && detail::is_digit(text[4]) && detail::is_digit(text[5]))
+			{
+				int const offset_hours = (text[1] - '0') * 10 + (text[2] - '0');
+				int const offset_minutes = (text[4] - '0') * 10 + (text[5] - '0');
+				if (offset_hours > 23 || offset_minutes > 59)
+					return std::nullopt;
+
+				minutes const offset = hours(offset_hours) + minutes(offset_minutes);
+				whole += text[0] == '+' ? -offset : offset;
+				text = std::string_view();
+			}
+
+			if (!text.empty())
+				return std::nullopt;
+
+			// Fails if the time is out of the range of the time point or the fractional part is not representable in its duration.
+			std::optional<Duration> const since_epoch = detail::seconds_to_duration<Duration>(whole.time_since_epoch(), fraction);
+			if (!since_epoch)
+				return std::nullopt;
+			return time_point(*since_epoch);
+		}
+
+		static std::string to_string(time_point t)
+		{
+			using namespace std::chrono;
+
+			sys_days const date = floor<days>(t);
+			year_month_day const ymd(date);
+			hh_mm_ss const time(t - date);
+
+			char buffer[32];
+			auto const write = [&buffer](size_t at, int value, int digits)
+			{
+				for (int i = digits - 1; i >= 0; --i)
+				{
+					buffer[at + static_cast<size_t>(i)] = static_cast<char>('0' + value % 10);
+					value /= 10;
+				}
+			};
+
+			// Years outside of 0000 to 9999 are written with a sign or more digits, as in the expanded representation of ISO 8601.
+			int const y = static_cast<int>(ymd.year());
+			std::string result = y < 0 ? "-" : "";
+			std::string const year_digits = std::to_string(y < 0 ? -y : y);
+			result.append(year_digits.size() < 4 ? 4 - year_digits.size() : 0, '0');
+			result += year_digits;
+
+			buffer[0] = '-';
+			write(1, static_cast<int>(static_cast<unsigned>(ymd.month())), 2);
+			buffer[3] = '-';
+			write(4, static_cast<int>(static_cast<unsigned>(ymd.day())), 2);
+			buffer[6] = 'T';
+			write(7, static_cast<int>(time.hours().count()), 2);
+			buffer[9] = ':';
+			write(10, static_cast<int>(time.minutes().count()), 2);
+			buffer[12] = ':';
+			write(13, static_cast<int>(time.seconds().count()), 2);
+			result.append(buffer, 15);
+
+			if constexpr (decltype(time)::fractional_width > 0)
+			{
+				if (time.subseconds().count() != 0)
+				{
+					std::string fraction = std::to_string(time.subseconds().count());
+					result += '.';
+					result.append(decltype(time)::fractional_width - fraction.size(), '0');
+					result += fraction;
+				}
+			}
+
+			result += 'Z';
+			return result;
+		}
+	};
+
+} // namespace dodo
@@ -0,0 +1,306 @@
+#pragma once
+
+#include "dodo.hh"
+#include <array>
+#include <cstdint>
+#include <vector>
+
+// Parsing with one shared engine instead of code generated for every option. dodo::compact reduces each option of a parser to a descriptor with
+// its patterns, hint and description, and pointers to the few functions that depend on the type of the option: converting and checking a value,
+// storing the default value and writing the extra lines of the help text. Matching, error messages and the help text are done by functions that
+// are not templates, so their code is in the program once no matter how many options it has. Results and error messages are the same as those
+// of the parser it is made from.
+//
+// constexpr auto cli = dodo_Opt(int, width)["--width"]("Width of the window.") | dodo_Opt(int, height)["--height"]("Height of the window.");
+// auto const compact_cli = dodo::compact(cli);
+// auto const result = compact_cli.parse(dodo::Args(argc, argv));
+
+namespace dodo
+{
+
+    enum struct conversion_status : uint8_t { converted, conversion_failed, validation_failed };
+
+    struct option_descriptor
+    {
+        uint32_t first_pattern;
+        uint32_t pattern_count;
+        std::string_view hint;
+        std::string_view type_name;
+        std::string_view description;
+        // Converts the matched text and stores the value in the result. On failure, explanation receives the text that follows the error message.
+        conversion_status (*convert)(void const * parser, std::string_view matched, void * result, std::string & explanation);
+        // Null for options without default value.
+        void (*store_default)(void const * parser, void * result);
+        // Null for options whose help text is a single line.
+        void (*append_details)(void const * parser, std::string & out, int column_width);
+    };
+
+    namespace detail
+    {
+        struct option_table
+        {
+            std::span<option_descriptor const> options;
+            std::span<std::string_view const> patterns;
+        };
+
+        inline std::string patterns_to_string(option_table table, option_descriptor const & option)
+        {
+            std::string out;
+            for (std::string_view const pattern : table.patterns.subspan(option.first_pattern, option.pattern_count))
+            {
+                if (!out.empty())
+                    out += ", ";
+                out += pattern;
+            }
+            return out;
+        }
+
+        inline std::optional<std::string_view> match_patterns(option_table table, option_descriptor const & option, std::string_view text) noexcept
+        {
+            for (std::string_view const pattern : table.patterns.subspan(option.first_pattern, option.pattern_count))
+            {
+                if (text.starts_with(pattern))
+                {
+                    if (text.size() == pattern.size())
+                        return "";
+                    else if (text[pattern.size()] == '=')
+                        return text.substr(pattern.size() + 1);
+                }
+            }
+            return std::nullopt;
+        }
+
+        // Same rules as CompoundOption::parse. An unrecognized argument stops parsing. Otherwise a missing option is reported before any option
+        // that failed to parse, and of those, the first in the order of the parser.
+        inline bool parse_compact(option_table table, void const * parser, ArgsView args, void * result, std::span<bool> given, std::string & error)
+        {
+            size_t const option_count = table.options.size();
+            size_t error_index = option_count;
+            std::string explanation;
+
+            auto const fail = [&](size_t index, std::string message)
+            {
+                if (index <= error_index)
+                {
+                    error_index = index;
+                    error = std::move(message);
+                }
+            };
+
+            for (std::string_view const arg : args)
+            {
+                size_t index = 0;
+                std::optional<std::string_view> matched;
+                for (; index < option_count; ++index)
+                {
+                    matched = match_patterns(table, table.options[index], arg);
+                    if (matched)
+                        break;
+                }
+
+                if (!matched)
+                {
+                    error = make_error("Unrecognized argument \"", arg, '"').value;
+                    return false;
+                }
+
+                option_descriptor const & option = table.options[index];
+                if (given[index])
+                {
+                    fail(index, make_error("Option ", patterns_to_string(table, option), " was given more than once").value);
+                    continue;
+                }
+                given[index] = true;
+
+                explanation.clear();
+                switch (option.convert(parser, *matched, result, explanation))
+                {
+                    case conversion_status::converted:
+                        break;
+                    case conversion_status::conversion_failed:
+                        fail(index, conversion_error(*matched, option.type_name, explanation).value);
+                        break;
+                    case conversion_status::validation_failed:
+                        fail(index, make_error(
+                            "Validation check failed for option ", patterns_to_string(table, option), "with argument \"", *matched, "\":\n\t",
+                            explanation).value);
+                        break;
+                }
+            }
+
+            bool all_given = true;
+            for (size_t i = 0; i < option_count; ++i)
+            {
+                if (given[i])
+                    continue;
+                else if (table.options[i].store_default)
+                    table.options[i].store_default(parser, result);
+                else
+                    all_given = false;
+            }
+
+            if (!all_given)
+            {
+                error = "Unmatched option";
+                return false;
+            }
+
+            return error_index == option_count;
+        }
+
+        inline std::string compact_to_string(option_table table, void const * parser, int indentation)
+        {
+            constexpr int column_width = 40;
+
+            std::string out;
+            for (option_descriptor const & option : table.options)
+            {
+                size_t const line_start = out.size();
+                out.append(indentation, ' ');
+                out += patterns_to_string(table, option);
+                out += " <";
+                out += option.hint;
+                out += ">";
+                while (out.size() - line_start < column_width) out.push_back(' ');
+                out += option.description;
+                if (option.append_details)
+                    option.append_details(parser, out, column_width);
+                out += '\n';
+            }
+            return out;
+        }
+
+        template <typename Result, typename Part>
+        void store_part(Result & result, Part part)
+        {
+            if constexpr (MemberBound<Part>)
+                result.*Part::member = std::move(part.value);
+            else
+                static_cast<Part &>(result) = std::move(part);
+        }
+
+        template <typename P, typename Option>
+        conversion_status convert_option(void const * parser, std::string_view matched, void * result, std::string & explanation)
+        {
+            Option const & option = static_cast<P const *>(parser)->template access_option<Option>();
+            auto & parsed_result = *static_cast<typename P::parse_result_type *>(result);
+
+            if constexpr (HasImplicitValue<Option>)
+            {
+                if (matched.empty())
+                {
+                    store_part(parsed_result, make_parse_result<typename Option::parse_result_type>(option.implicit_value));
+                    return conversion_status::converted;
+                }
+            }
+
+            auto parsed = option.parse_impl(matched);
+            if (!parsed)
+            {
+                explanation = option.parse_error_text(matched);
+                return conversion_status::conversion_failed;
+            }
+
+            if constexpr (HasDeferredChecks<Option>)
+            {
+                // Deferred checks write their message while they run, so that slow checks are not run again to explain a failure.
+                if (!option.passes_immediate_checks(parsed->_get()))
+                {
+                    explanation = option.validation_error(parsed->_get());
+                    return conversion_status::validation_failed;
+                }
+                if (std::optional<std::string> error = defer_checks(option, parsed->_get(), std::string()))
+                {
+                    explanation = std::move(*error);
+                    return conversion_status::validation_failed;
+                }
+            }
+            else if constexpr (HasValidationCheck<Option>)
+            {
+                if (!option.passes(parsed->_get()))
+                {
+                    explanation = option.validation_error(parsed->_get());
+                    return conversion_status::validation_failed;
+                }
+            }
+
+            store_part(parsed_result, std::move(*parsed));
+            return conversion_status::converted;
+        }
+
+        template <typename P, typename Option>
+        void store_default_value(void const * parser, void * result)
+        {
+            Option const & option = static_cast<P const *>(parser)->template access_option<Option>();
+            store_part(*static_cast<typename P::parse_result_type *>(result), make_parse_result<typename Option::parse_result_type>(option.default_value));
+        }
+
+        template <typename P, typename Option>
+        void append_option_details(void const * parser, std::string & out, int column_width)
+        {
+            static_cast<P const *>(parser)->template access_option<Option>().append_details(out, column_width);
+        }
+
+        template <typename P, typename Option>
+        option_descriptor make_descriptor(Option const & option, std::vector<std::string_view> & patterns)
+        {
+            option_descriptor descriptor = {};
+            descriptor.first_pattern = static_cast<uint32_t>(patterns.size());
+            option.for_each_pattern([&patterns](std::string_view pattern) { patterns.push_back(pattern); });
+            descriptor.pattern_count = static_cast<uint32_t>(patterns.size() - descriptor.first_pattern);
+            descriptor.hint = option.hint_text();
+            descriptor.type_name = option.type_name;
+            if constexpr (HasDescription<Option>)
+                descriptor.description = option.description;
+            descriptor.convert = convert_option<P, Option>;
+            if constexpr (HasDefaultValue<Option>)
+                descriptor.store_default = store_default_value<P, Option>;
+            if constexpr (TraitEnumerable<typename Option::value_type> || HasValidationCheck<Option> || HasDefaultValue<Option> || HasImplicitValue<Option>)
+                descriptor.append_details = append_option_details<P, Option>;
+            return descriptor;
+        }
+
+        template <typename ... Options>
+        std::array<option_descriptor, sizeof...(Options)> make_descriptors(CompoundOption<Options...> const & parser, std::vector<std::string_view> & patterns)
+        {
+            return {make_descriptor<CompoundOption<Options...>>(parser.template access_option<Options>(), patterns)...};
+        }
+    } // namespace detail
+
+    template <instantiation_of<CompoundOption> P>
+    struct CompactParser
+    {
+        using parse_result_type = typename P::parse_result_type;
+
+        static_assert(std::is_default_constructible_v<parse_result_type>, "Compact parsers need the types of all options to be default constructible.");
+
+        explicit CompactParser(P parser_) : parser(parser_), descriptors(detail::make_descriptors(parser, patterns)) {}
+
+        auto parse(ArgsView args) const noexcept -> expected<parse_result_type, std::string>
+        {
+            parse_result_type result{};
+            std::array<bool, P::option_count> given = {};
+            std::string error;
+            if (!detail::parse_compact({descriptors, patterns}, &parser, args, &result, given, error))
+                return Error(std::move(error));
+            return result;
+        }
+
+        std::string to_string(int indentation = 0) const
+        {
+            return detail::compact_to_string({descriptors, patterns}, &parser, indentation);
+        }
+
+    private:
+        P parser;
+        std::vector<std::string_view> patterns;
+        std::array<option_descriptor, P::option_count> descriptors;
+    };
+
+    template <instantiation_of<CompoundOption> P>
+    CompactParser<P> compact(P parser)
+    {
+        return CompactParser<P>(parser);
+    }
+
+} // namespace dodo
@@ -0,0 +1,250 @@
+#pragma once
+
+#include "parse_traits.hh"
+#include <algorithm>
+#include <array>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace dodo
+{
+
+	namespace detail
+	{
+		// Splits the text in N fields by the separator. The last field takes the rest of the text, even if it contains the separator.
+		template <size_t N>
+		constexpr std::optional<std::array<std::string_view, N>> split_fields(std::string_view text, char separator) noexcept
+		{
+			std::array<std::string_view, N> fields;
+
+			for (size_t i = 0; i + 1 < N; ++i)
+			{
+				size_t const end = text.find(separator);
+				if (end == std::string_view::npos)
+					return std::nullopt;
+				fields[i] = text.substr(0, end);
+				text.remove_prefix(end + 1);
+			}
+			fields[N - 1] = text;
+
+			return fields;
+		}
+
+		// Parses each field with the parse traits of its type. Returns the parsed values as a tuple.
+		template <char Separator, typename ... Ts>
+		constexpr std::optional<std::tuple<Ts...>> parse_fields(std::string_view text) noexcept
+		{
+			std::optional<std::array<std::string_view, sizeof...(Ts)>> const fields = split_fields<sizeof...(Ts)>(text, Separator);
+			if (!fields)
+				return std::nullopt;
+
+			return [&fields]<size_t ... Is>(std::index_sequence<Is...>) -> std::optional<std::tuple<Ts...>>
+			{
+				std::tuple<std::optional<Ts>...> values(parse_traits<Ts>::parse((*fields)[Is])...);
+				if (!(std::get<Is>(values) && ...))
+					return std::nullopt;
+				return std::tuple<Ts...>(std::move(*std::get<Is>(values))...);
+			}(std::index_sequence_for<Ts...>());
+		}
+
+		template <char Separator, typename ... Ts>
+		std::string fields_to_string(Ts const & ... fields)
+		{
+			std::string result;
+			((result += dodo::to_string(fields), result += Separator), ...);
+			result.pop_back();
+			return result;
+		}
+
+		// Converts to anything. Used to count the fields of an aggregate by trying to initialize it with more and more of these.
+		struct any_field
+		{
+			template <typename T>
+			constexpr operator T() const noexcept;
+		};
+
+		template <typename T, typename ... Fields>
+		constexpr size_t aggregate_field_count() noexcept
+		{
+			if constexpr (requires { T{Fields()..., any_field()}; })
+				return aggregate_field_count<T, Fields..., any_field>();
+			else
+				return sizeof...(Fields);
+		}
+
+		// Tuple of references to the fields of an aggregate, in order of declaration.
+		template <typename T>
+		constexpr auto tie_fields(T & t) noexcept
+		{
+			constexpr size_t field_count = aggregate_field_count<std::remove_const_t<T>>();
+			static_assert(field_count >= 1 && field_count <= 8, "aggregate_parse_traits supports aggregates of 1 to 8 fields.");
+
+			if constexpr (field_count == 1) { auto & [a] = t; return std::tie(a); }
+			else if constexpr (field_count == 2) { auto & [a, b] = t; return std::tie(a, b); }
+			else if constexpr (field_count == 3) { auto & [a, b, c] = t; return std::tie(a, b, c); }
+			else if constexpr (field_count == 4) { auto & [a, b, c, d] = t; return std::tie(a, b, c, d); }
+			else if constexpr (field_count == 5) { auto & [a, b, c, d, e] = t; return std::tie(a, b, c, d, e); }
+			else if constexpr (field_count == 6) { auto & [a, b, c, d, e, f] = t; return std::tie(a, b, c, d, e, f); }
+			else if constexpr (field_count == 7) { auto & [a, b, c, d, e, f, g] = t; return std::tie(a, b, c, d, e, f, g); }
+			else { auto & [a, b, c, d, e, f, g, h] = t; return std::tie(a, b, c, d, e, f, g, h); }
+		}
+
+		template <typename T>
+		struct aggregate_field_types;
+
+		template <typename ... Ts>
+		struct aggregate_field_types<std::tuple<Ts & ...>>
+		{
+			template <typename Aggregate, char Separator>
+			static constexpr std::optional<Aggregate> parse(std::string_view text) noexcept
+			{
+				std::optional<std::tuple<Ts...>> fields = parse_fields<Separator, Ts...>(text);
+				if (!fields)
+					return std::nullopt;
+				return std::apply([](Ts & ... values) { return Aggregate{std::move(values)...}; }, *fields);
+			}
+		};
+	} // namespace detail
+
+	// Parse traits for tuple-like types (those with std::tuple_size and std::get) whose elements are separated by a character, as in 1920x1080.
+	template <typename T, char Separator>
+	struct tuple_parse_traits
+	{
+		static constexpr std::optional<T> parse(std::string_view text) noexcept
+		{
+			return [text]<size_t ... Is>(std::index_sequence<Is...>) -> std::optional<T>
+			{
+				auto fields = detail::parse_fields<Separator, std::tuple_element_t<Is, T>...>(text);
+				if (!fields)
+					return std::nullopt;
+				return T(std::move(std::get<Is>(*fields))...);
+			}(std::make_index_sequence<std::tuple_size_v<T>>());
+		}
+
+		static std::string to_string(T const & t)
+		{
+			return std::apply([](auto const & ... fields) { return detail::fields_to_string<Separator>(fields...); }, t);
+		}
+	};
+
+	// Parse traits for aggregates whose fields are separated by a character, as in 1920x1080. The fields are given in order of declaration.
+	//
+	// struct Resolution { int width, height; };
+	// template <> struct dodo::parse_traits<Resolution> : dodo::aggregate_parse_traits<Resolution, 'x'> {};
+	template <typename T, char Separator>
+	struct aggregate_parse_traits
+	{
+		static_assert(std::is_aggregate_v<T>, "aggregate_parse_traits can only be used with aggregates.");
+
+		static constexpr std::optional<T> parse(std::string_view text) noexcept
+		{
+			using references = decltype(detail::tie_fields(std::declval<T &>()));
+			return detail::aggregate_field_types<references>::template parse<T, Separator>(text);
+		}
+
+		static std::string to_string(T const & t)
+		{
+			return std::apply([](auto const & ... fields) { return detail::fields_to_string<Separator>(fields...); }, detail::tie_fields(t));
+		}
+	};
+
+	template <typename A, typename B>
+	struct parse_traits<std::pair<A, B>> : public tuple_parse_traits<std::pair<A, B>, ','> {};
+
+	template <typename ... Ts>
+	struct parse_traits<std::tuple<Ts...>> : public tuple_parse_traits<std::tuple<Ts...>, ','> {};
+
+	// Map stored as a vector of key-value pairs sorted by key. Parsed from key=value pairs separated by commas, as in a=1,b=2. Repeating a key is
+	// an error. The vector is allocated once, then sorted.
+	template <typename Key, typename Value>
+	struct flat_map
+	{
+		using value_type = std::pair<Key, Value>;
+		using const_iterator = typename std::vector<value_type>::const_iterator;
+
+		const_iterator begin() const noexcept { return entries.begin(); }
+		const_iterator end() const noexcept { return entries.end(); }
+		size_t size() const noexcept { return entries.size(); }
+		bool empty() const noexcept { return entries.empty(); }
+
+		template <typename K>
+		const_iterator find(K const & key) const noexcept
+		{
+			auto const it = std::lower_bound(entries.begin(), entries.end(), key, [](value_type const & entry, K const & k) { return entry.first < k; });
+			if (it != entries.end() && !(key < it->first))
+				return it;
+			else
+				return entries.end();
+		}
+
+		template <typename K>
+		bool contains(K const & key) const noexcept { return find(key) != end(); }
+
+		bool operator == (flat_map const & other) const noexcept = default;
+
+		std::vector<value_type> entries;
+	};
+
+	template <typename Key, typename Value>
+	struct parse_traits<flat_map<Key, Value>>
+	{
+		static std::optional<flat_map<Key, Value>> parse(std::string_view text) noexcept
+		{
+			flat_map<Key, Value> map;
+			if (text.empty())
+				return map;
+
+			map.entries.reserve(size_t(std::count(text.begin(), text.end(), ',')) + 1);
+
+			size_t index = 0;
+			while (index <= text.size())
+			{
+				size_t end = text.find(',', index);
+				if (end == std::string_view::npos)
+					end = text.size();
+
+				std::optional<std::array<std::string_view, 2>> const key_value = detail::split_fields<2>(text.substr(index, end - index), '=');
+				if (!key_value)
+					return std::nullopt;
+
+				std::optional<Key> key = parse_traits<Key>::parse((*key_value)[0]);
+				std::optional<Value> value = parse_traits<Value>::parse((*key_value)[1]);
+				if (!key || !value)
+					return std::nullopt;
+				map.entries.emplace_back(std::move(*key), std::move(*value));
+
+				index = end + 1;
+			}
+
+			std::sort(map.entries.begin(), map.entries.end(), [](auto const & a, auto const & b) { return a.first < b.first; });
+
+			auto const repeated = std::adjacent_find(map.entries.begin(), map.entries.end(), [](auto const & a, auto const & b) { return !(a.first < b.first); });
+			if (repeated != map.entries.end())
+				return std::nullopt;
+
+			return map;
+		}
+
+		static std::string to_string(flat_map<Key, Value> const & map)
+		{
+			std::string result;
+
+			for (auto const & [key, value] : map)
+			{
+				result += dodo::to_string(key);
+				result += '=';
+				result += dodo::to_string(value);
+				result += ',';
+			}
+
+			// Remove last separator.
+			if (!result.empty())
+				result.pop_back();
+
+			return result;
+		}
+	};
+
+} // namespace dodo
@@ -0,0 +1,422 @@
+#pragma once
+
+#include "binary_args.hh"
+
+#if defined(__linux__)
+
+#include <atomic>
+#include <exception>
+#include <filesystem>
+#include <functional>
+#include <list>
+#include <optional>
+#include <thread>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// Daemon mode for programs with expensive initialization. A resident server process initializes once and listens on a Unix socket. Every run
+// of the program forwards its arguments, working directory and environment to it with dodo::forward_to_daemon and exits with the code that
+// the server returns, and whatever the server writes to the output and error streams of the request is written to the standard output and
+// error of the client as it arrives. The server parses the arguments with the same parser as the program would and calls a handler with the
+// result on a thread of its own. If no server is listening, forward_to_daemon fails without sending anything and the program can run the
+// command itself. If the connection fails after that, the server may have run part of the command, so running it again is not safe.
+//
+// int main(int argc, char const * argv[], char const * envp[])
+// {
+//     auto const exit_code = dodo::forward_to_daemon("/run/user/1000/tool.sock", argc, argv, envp);
+//     if (exit_code)
+//         return *exit_code;
+//     if (exit_code.error().connected)
+//     {
+//         std::cerr << exit_code.error().message << '\n';
+//         return 1;
+//     }
+//     ...  // Run locally.
+// }
+//
+// dodo::DaemonServer server(cli, [&](auto const & args, dodo::DaemonRequest & request) { return run_command(args, request); });
+// server.listen("/run/user/1000/tool.sock");
+// server.run();
+
+namespace dodo
+{
+
+    namespace detail
+    {
+        // Messages from the server to the client are a byte with the kind of message, the size of the payload as a 32 bit integer and the
+        // payload. The exit code is the last message of a request.
+        enum class daemon_message : char { out, err, exit };
+
+        constexpr size_t daemon_message_header_size = 1 + binary_args_word;
+
+        // Like write_all, but for sockets. MSG_NOSIGNAL, so that a peer that goes away does not kill the client or the server with SIGPIPE.
+        inline bool send_all(int fd, iovec * buffers, size_t count) noexcept
+        {
+            while (count > 0)
+            {
+                msghdr message = {};
+                message.msg_iov = buffers;
+                message.msg_iovlen = std::min<size_t>(count, IOV_MAX);
+                ssize_t sent = sendmsg(fd, &message, MSG_NOSIGNAL);
+                if (sent < 0)
+                {
+                    if (errno == EINTR)
+                        continue;
+                    return false;
+                }
+                while (count > 0 && static_cast<size_t>(sent) >= buffers->iov_len)
+                {
+                    sent -= buffers->iov_len;
+                    ++buffers;
+                    --count;
+                }
+                if (count > 0)
+                {
+                    buffers->iov_base = static_cast<char *>(buffers->iov_base) + sent;
+                    buffers->iov_len -= sent;
+                }
+            }
+            return true;
+        }
+
+        inline bool send_daemon_message(int fd, daemon_message kind, std::string_view payload) noexcept
+        {
+            char header[daemon_message_header_size];
+            header[0] = static_cast<char>(kind);
+            write_binary_word(header + 1, payload.size());
+
+            iovec buffers[2] = {{header, sizeof(header)}, {const_cast<char *>(payload.data()), payload.size()}};
+            return send_all(fd, buffers, 2);
+        }
+
+        inline auto send_binary_args(int fd, ArgsView args) -> expected<void, std::string>
+        {
+            return write_binary_args_with(args, [fd](iovec * buffers, size_t count) { return send_all(fd, buffers, count); });
+        }
+
+        inline bool write_all(int fd, std::string_view text) noexcept
+        {
+            iovec buffer = {const_cast<char *>(text.data()), text.size()};
+            return write_all(fd, &buffer, 1);
+        }
+
+        inline auto make_socket_address(std::filesystem::path const & socket_path) -> expected<sockaddr_un, std::string>
+        {
+            sockaddr_un address = {};
+            address.sun_family = AF_UNIX;
+            std::string const & path = socket_path.native();
+            if (path.size() >= sizeof(address.sun_path))
+                return make_error("Socket path \"", path, "\" is too long");
+            std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+            return address;
+        }
+
+        // Returns the connected socket, or -1.
+        inline int connect_to(sockaddr_un const & address) noexcept
+        {
+            int const fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+            if (fd < 0)
+                return -1;
+            if (connect(fd, reinterpret_cast<sockaddr const *>(&address), sizeof(address)) < 0)
+            {
+                close(fd);
+                return -1;
+            }
+            return fd;
+        }
+    } // namespace detail
+
+    // A run of the program forwarded to the server. The arguments, working directory and environment point into buffers owned by the
+    // connection and are valid until the handler returns. The server does not change its own working directory or environment, which are
+    // shared by all threads, so handlers must resolve relative paths against working_directory and read variables with environment_variable.
+    // A request must only be written to from one thread at a time.
+    struct DaemonRequest
+    {
+        DaemonRequest(int socket_fd_, Args arguments_, std::string_view working_directory_, Args environment_) noexcept
+            : arguments(std::move(arguments_))
+            , working_directory(working_directory_)
+            , environment(std::move(environment_))
+            , socket_fd(socket_fd_)
+        {}
+
+        // Write to the standard output and error of the client. Return false if the client is gone.
+        bool out(std::string_view text) const noexcept { return detail::send_daemon_message(socket_fd, detail::daemon_message::out, text); }
+        bool err(std::string_view text) const noexcept { return detail::send_daemon_message(socket_fd, detail::daemon_message::err, text); }
+
+        // The value of a variable in the environment of the client.
+        std::optional<std::string_view> environment_variable(std::string_view name) const noexcept
+        {
+            for (std::string_view const variable : environment)
+                if (variable.size() > name.size() && variable[name.size()] == '=' && variable.starts_with(name))
+                    return variable.substr(name.size() + 1);
+            return std::nullopt;
+        }
+
+        // The arguments the client was run with, without the name of the program.
+        Args arguments;
+        std::string_view working_directory;
+        // Variables as NAME=value.
+        Args environment;
+
+    private:
+        int socket_fd;
+    };
+
+    // Serves requests of clients that call dodo::forward_to_daemon. Each request is parsed with the parser and handled on a thread of its own
+    // by calling the handler with the parse result and the request. The handler returns the exit code of the client. If the arguments do not
+    // parse, the error is written to the standard error of the client, which exits with code 1, and so is the message of an exception thrown
+    // while handling it. Requests are handled concurrently, so the handler must be safe to call from several threads at once. Requests whose
+    // arguments, working directory and environment take more than max_request_size bytes are dropped without reading them.
+    template <Parser P, typename Handler>
+        requires std::invocable<Handler const &, typename P::parse_result_type const &, DaemonRequest &>
+    struct DaemonServer
+    {
+        static constexpr size_t default_max_request_size = 16 * 1024 * 1024;
+
+        DaemonServer(P parser_, Handler handler_, size_t max_request_size_ = default_max_request_size)
+            : parser(std::move(parser_))
+            , handler(std::move(handler_))
+            , max_request_size(max_request_size_)
+        {}
+
+        DaemonServer(DaemonServer const &) = delete;
+        DaemonServer & operator = (DaemonServer const &) = delete;
+
+        // Shuts down the connections of the clients, so that requests that are still being read fail and handlers can no longer write to
+        // theirs, and waits for the handlers that are running to return.
+        ~DaemonServer()
+        {
+            for (connection const & c : connections)
+                shutdown(c.fd, SHUT_RDWR);
+            connections.clear();
+            if (listen_fd >= 0)
+            {
+                close(listen_fd);
+                unlink(socket_path.c_str());
+            }
+            if (wake_fd >= 0)
+                close(wake_fd);
+        }
+
+        // Creates the socket. A socket file left by a server that is no longer running is replaced. Fails if another server is listening on it.
+        auto listen(std::filesystem::path const & socket_path_) -> expected<void, std::string>
+        {
+            auto const address = detail::make_socket_address(socket_path_);
+            if (!address)
+                return Error(address.error());
+
+            if (int const running = detail::connect_to(*address); running >= 0)
+            {
+                close(running);
+                return detail::make_error("A daemon is already listening on \"", socket_path_.string(), '"');
+            }
+            unlink(socket_path_.c_str());
+
+            wake_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+            listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+            if (wake_fd < 0 || listen_fd < 0
+                || bind(listen_fd, reinterpret_cast<sockaddr const *>(&*address), sizeof(*address)) < 0
+                || ::listen(listen_fd, SOMAXCONN) < 0)
+            {
+                if (listen_fd >= 0) close(listen_fd);
+                if (wake_fd >= 0) close(wake_fd);
+                listen_fd = wake_fd = -1;
+                return detail::make_error("Could not listen on \"", socket_path_.string(), '"');
+            }
+            socket_path = socket_path_;
+            return success;
+        }
+
+        // Accepts and handles requests until stop is called. listen must have succeeded.
+        void run()
+        {
+            pollfd fds[2] = {{wake_fd, POLLIN, 0}, {listen_fd, POLLIN, 0}};
+            while (true)
+            {
+                if (poll(fds, 2, -1) < 0)
+                {
+                    if (errno == EINTR)
+                        continue;
+                    return;
+                }
+                if (fds[0].revents & POLLIN)
+                {
+                    uint64_t count;
+                    [[maybe_unused]] auto const read_bytes = read(wake_fd, &count, sizeof(count));
+                    return;
+                }
+                if (fds[1].revents & POLLIN)
+                {
+                    int const client = accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+                    if (client < 0)
+                        continue;
+
+                    connections.remove_if([](connection const & c) { return c.done.load(std::memory_order_acquire); });
+                    connection & added = connections.emplace_back(client);
+                    added.thread = std::jthread([this, client, &done = added.done]()
+                    {
+                        // An exception that escapes the thread would terminate the server. Those thrown while handling the request are
+                        // reported to the client by serve, and any other, like running out of memory while reading it, drops the connection.
+                        try
+                        {
+                            serve(client);
+                        }
+                        catch (...)
+                        {
+                        }
+                        // The socket is closed when the connection is removed, so that the destructor never shuts down a reused descriptor.
+                        shutdown(client, SHUT_RDWR);
+                        done.store(true, std::memory_order_release);
+                    });
+                }
+            }
+        }
+
+        // Makes run return. Async signal safe, so it can be called from a SIGTERM handler.
+        void stop() const noexcept
+        {
+            uint64_t const one = 1;
+            [[maybe_unused]] auto const written = write(wake_fd, &one, sizeof(one));
+        }
+
+    private:
+        void serve(int client) const
+        {
+            // Arguments parsed by the handler point into these buffers.
+            std::string arguments_buffer;
+            std::string directory_buffer;
+            std::string environment_buffer;
+            auto arguments = read_binary_args(client, arguments_buffer, max_request_size);
+            if (!arguments)
+                return;
+            auto directory = read_binary_args(client, directory_buffer, max_request_size - arguments_buffer.size());
+            if (!directory || directory->size() != 1)
+                return;
+            auto environment = read_binary_args(client, environment_buffer, max_request_size - arguments_buffer.size() - directory_buffer.size());
+            if (!environment)
+                return;
+
+            DaemonRequest request(client, std::move(*arguments), (*directory)[0], std::move(*environment));
+            int exit_code = 1;
+            try
+            {
+                if (auto const parsed = parser.parse(request.arguments))
+                    exit_code = static_cast<int>(std::invoke(handler, *parsed, request));
+                else
+                    request.err(parsed.error() + '\n');
+            }
+            catch (std::exception const & e)
+            {
+                exit_code = 1;
+                request.err(std::string("The daemon failed to handle the command: ") + e.what() + '\n');
+            }
+            catch (...)
+            {
+                exit_code = 1;
+                request.err("The daemon failed to handle the command\n");
+            }
+
+            char code[detail::binary_args_word];
+            detail::write_binary_word(code, static_cast<uint32_t>(exit_code));
+            detail::send_daemon_message(client, detail::daemon_message::exit, std::string_view(code, sizeof(code)));
+        }
+
+        struct connection
+        {
+            explicit connection(int fd_) noexcept : fd(fd_) {}
+
+            ~connection()
+            {
+                if (thread.joinable())
+                    thread.join();
+                close(fd);
+            }
+
+            int fd;
+            std::atomic<bool> done = false;
+            std::jthread thread;
+        };
+
+        P parser;
+        Handler handler;
+        size_t max_request_size;
+        std::filesystem::path socket_path;
+        int listen_fd = -1;
+        int wake_fd = -1;
+        // Destroyed first, which joins the threads of the requests that are still being handled.
+        std::list<connection> connections;
+    };
+
+    struct forward_error
+    {
+        // False if no server could be reached, in which case nothing was sent and the program can run the command itself. True if the
+        // connection failed after that, when the server may already have run part of the command and running it again could repeat it.
+        bool connected;
+        std::string message;
+    };
+
+    // Sends the arguments, working directory and environment of this run of the program to the server listening on socket_path, copies what
+    // the server writes for it to out_fd and err_fd, and returns the exit code it returns. envp may be null to forward environ. Only a failure
+    // that is not connected is safe to retry by handling the command locally.
+    inline auto forward_to_daemon(std::filesystem::path const & socket_path, int argc, char const * const argv[], char const * const envp[] = nullptr,
+        int out_fd = STDOUT_FILENO, int err_fd = STDERR_FILENO) -> expected<int, forward_error>
+    {
+        auto const fail = [](bool connected, Error<std::string> error) { return Error(forward_error{connected, std::move(error.value)}); };
+
+        auto const address = detail::make_socket_address(socket_path);
+        if (!address)
+            return fail(false, Error(address.error()));
+
+        int const fd = detail::connect_to(*address);
+        if (fd < 0)
+            return fail(false, detail::make_error("Could not connect to daemon at \"", socket_path.string(), '"'));
+
+        std::error_code error;
+        std::string const directory = std::filesystem::current_path(error).string();
+        std::string_view const directory_view = directory;
+
+        if (envp == nullptr)
+            envp = const_cast<char const * const *>(environ);
+        std::vector<std::string_view> environment;
+        for (char const * const * variable = envp; *variable != nullptr; ++variable)
+            environment.push_back(*variable);
+
+        if (!detail::send_binary_args(fd, Args(argc, argv)) || !detail::send_binary_args(fd, std::span(&directory_view, 1))
+            || !detail::send_binary_args(fd, std::span<std::string_view const>(environment)))
+        {
+            close(fd);
+            return fail(true, detail::make_error("Could not send the command to daemon at \"", socket_path.string(), '"'));
+        }
+
+        std::string payload;
+        while (true)
+        {
+            char header[detail::daemon_message_header_size];
+            if (detail::read_all(fd, header, sizeof(header)) != sizeof(header))
+                break;
+
+            payload.resize(detail::read_binary_word(header + 1));
+            if (detail::read_all(fd, payload.data(), payload.size()) != static_cast<ssize_t>(payload.size()))
+                break;
+
+            switch (static_cast<detail::daemon_message>(header[0]))
+            {
+                case detail::daemon_message::out: detail::write_all(out_fd, payload); break;
+                case detail::daemon_message::err: detail::write_all(err_fd, payload); break;
+                case detail::daemon_message::exit:
+                    close(fd);
+                    if (payload.size() != detail::binary_args_word)
+                        return fail(true, detail::make_error("Daemon at \"", socket_path.string(), "\" sent an invalid exit code"));
+                    return static_cast<int>(detail::read_binary_word(payload.data()));
+            }
+        }
+        close(fd);
+        return fail(true, detail::make_error("Daemon at \"", socket_path.string(), "\" closed the connection before the command finished"));
+    }
+
+} // namespace dodo
+
+#endif // defined(__linux__)
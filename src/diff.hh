@@ -0,0 +1,214 @@
+#pragma once
+
+#include "dodo.hh"
+#include <array>
+#include <bitset>
+#include <cstring>
+#include <optional>
+#include <ranges>
+
+// Comparison and hashing of parse results, field by field. dodo::diff returns the set of positional arguments and options whose values differ
+// between two results of the same parser, as a bitset where arguments come first and then options, in the order they were declared.
+// dodo::field_index gives the position of an argument or option in that bitset. dodo::content_hash is a 64 bit hash of the values of a result
+// that does not depend on the run of the program, for use as a cache key.
+//
+// auto const changed = dodo::diff(cli, old_config, new_config);
+// if (changed[dodo::field_index(cli, "--threads")])
+//     restart_thread_pool();
+
+namespace dodo
+{
+
+    namespace detail
+    {
+        template <typename ... Parts>
+        struct field_list
+        {
+            static constexpr size_t size = sizeof...(Parts);
+        };
+
+        template <typename ... Options>
+        field_list<get_parse_result_type<Options>...> fields_of(CompoundOption<Options...> const &);
+
+        template <typename ... Arguments>
+        field_list<get_parse_result_type<Arguments>...> fields_of(CompoundArgument<Arguments...> const &);
+
+        template <typename ... Arguments, typename ... Options>
+        field_list<get_parse_result_type<Arguments>..., get_parse_result_type<Options>...> fields_of(CompoundParser<CompoundArgument<Arguments...>, CompoundOption<Options...>> const &);
+
+        template <typename P>
+        using fields_t = decltype(fields_of(std::declval<P const &>()));
+
+        template <typename Part, typename Result>
+        constexpr auto const & field_value(Result const & result) noexcept
+        {
+            if constexpr (MemberBound<Part>)
+                return result.*Part::member;
+            else
+                return static_cast<Part const &>(result)._get();
+        }
+
+        // Types whose values are equal exactly when their bytes are, which are compared with memcmp and hashed as bytes. Only integers, enums
+        // and arrays of those, since other types without padding, like std::string_view or arrays of it, may hold pointers and are compared
+        // by the values they point to.
+        template <typename T>
+        constexpr bool compared_as_bytes = (std::is_integral_v<T> || std::is_enum_v<T>) && std::has_unique_object_representations_v<T>;
+
+        template <typename T, size_t N>
+        constexpr bool compared_as_bytes<T[N]> = compared_as_bytes<T>;
+
+        template <typename T, size_t N>
+        constexpr bool compared_as_bytes<std::array<T, N>> = compared_as_bytes<T>;
+
+        template <typename T>
+        bool field_equal(T const & a, T const & b) noexcept
+        {
+            if constexpr (compared_as_bytes<T>)
+                return std::memcmp(std::addressof(a), std::addressof(b), sizeof(T)) == 0;
+            else
+            {
+                static_assert(std::equality_comparable<T>, "dodo::diff needs the types of all fields to be equality comparable.");
+                return a == b;
+            }
+        }
+
+        template <typename Result, typename ... Parts>
+        auto diff_fields(Result const & a, Result const & b, field_list<Parts...>) noexcept -> std::bitset<sizeof...(Parts)>
+        {
+            std::bitset<sizeof...(Parts)> changed;
+            size_t index = 0;
+            ((changed[index++] = !field_equal(field_value<Parts>(a), field_value<Parts>(b))), ...);
+            return changed;
+        }
+
+        // FNV-1a, which is fixed, so hashes can be stored and compared across runs and builds for the same platform.
+        struct content_hasher
+        {
+            void add_bytes(void const * data, size_t size) noexcept
+            {
+                unsigned char const * bytes = static_cast<unsigned char const *>(data);
+                for (size_t i = 0; i < size; ++i)
+                {
+                    hash ^= bytes[i];
+                    hash *= 0x100000001b3;
+                }
+            }
+
+            template <typename T>
+            void add(T const & value)
+            {
+                if constexpr (compared_as_bytes<T>)
+                    add_bytes(std::addressof(value), sizeof(T));
+                else if constexpr (std::is_floating_point_v<T>)
+                {
+                    // 0.0 and -0.0 are equal, so they must hash the same.
+                    T const normalized = value == T(0) ? T(0) : value;
+                    add_bytes(&normalized, sizeof(T));
+                }
+                else if constexpr (std::is_convertible_v<T const &, std::string_view>)
+                {
+                    std::string_view const text = value;
+                    add(uint64_t(text.size()));
+                    add_bytes(text.data(), text.size());
+                }
+                else if constexpr (std::ranges::sized_range<T const>)
+                {
+                    add(uint64_t(std::ranges::size(value)));
+                    for (auto const & element : value)
+                        add(element);
+                }
+                else
+                {
+                    static_assert(TraitPrintable<T>, "dodo::content_hash needs the types of all fields to be ranges, strings, integers, enums, or have parse_traits<T>::to_string.");
+                    add(std::string(dodo::to_string(value)));
+                }
+            }
+
+            uint64_t hash = 0xcbf29ce484222325;
+        };
+
+        template <typename Result, typename ... Parts>
+        uint64_t hash_fields(Result const & result, field_list<Parts...>)
+        {
+            content_hasher hasher;
+            (hasher.add(field_value<Parts>(result)), ...);
+            return hasher.hash;
+        }
+    } // namespace detail
+
+    // Number of positional arguments and options of a parser.
+    template <typename P>
+    constexpr size_t field_count = detail::fields_t<P>::size;
+
+    template <typename P>
+    using field_set = std::bitset<field_count<P>>;
+
+    // Fields whose value differs between a and b. When the result type has no padding, results whose bytes are all equal are found with a
+    // single memcmp. Results with different bytes are compared field by field, since views in them may point to equal values elsewhere.
+    template <typename P>
+    auto diff(P const & parser, typename P::parse_result_type const & a, typename P::parse_result_type const & b) noexcept -> field_set<P>
+    {
+        static_cast<void>(parser);
+
+        using Result = typename P::parse_result_type;
+        if constexpr (std::has_unique_object_representations_v<Result>)
+            if (std::memcmp(std::addressof(a), std::addressof(b), sizeof(Result)) == 0)
+                return field_set<P>();
+
+        return detail::diff_fields(a, b, detail::fields_t<P>());
+    }
+
+    template <typename P>
+    bool equal(P const & parser, typename P::parse_result_type const & a, typename P::parse_result_type const & b) noexcept
+    {
+        return diff(parser, a, b).none();
+    }
+
+    // Position of the positional argument with the given name, or of the option that has the given pattern, in the results of dodo::diff.
+    // Only evaluated at compile time, where a name that no argument or option has fails to compile.
+    template <typename P>
+    consteval size_t field_index(P const & parser, std::string_view name) noexcept
+    {
+        std::optional<size_t> argument_index;
+        size_t argument_count = 0;
+        auto const find_argument = [&](std::string_view argument_name)
+        {
+            if (!argument_index && argument_name == name)
+                argument_index = argument_count;
+            ++argument_count;
+        };
+
+        if constexpr (requires { parser.access_arguments(); })
+            parser.access_arguments().for_each_name(find_argument);
+        else if constexpr (requires { parser.for_each_name(find_argument); })
+            parser.for_each_name(find_argument);
+
+        if (argument_index)
+            return *argument_index;
+
+        if constexpr (requires { parser.access_options(); })
+        {
+            size_t const option_index = parser.access_options().find_option(name);
+            if (option_index < parser.access_options().option_count)
+                return argument_count + option_index;
+        }
+        else if constexpr (requires { parser.find_option(name); })
+        {
+            size_t const option_index = parser.find_option(name);
+            if (option_index < parser.option_count)
+                return option_index;
+        }
+
+        detail::definition_error("No argument or option has this name.");
+        return argument_count;
+    }
+
+    // 64 bit hash of the values of all fields of a result. It is the same in every run of the program and in every build for the same platform.
+    template <typename P>
+    uint64_t content_hash(P const & parser, typename P::parse_result_type const & result)
+    {
+        static_cast<void>(parser);
+        return detail::hash_fields(result, detail::fields_t<P>());
+    }
+
+} // namespace dodo
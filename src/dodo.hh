@@ -1,10 +1,25 @@
 #pragma once
 
 #include "parse_traits.hh"
+#include "enum_traits.hh"
+#include "unit_traits.hh"
+#include "chrono_traits.hh"
+#include "network_traits.hh"
+#include "compound_traits.hh"
+#include "blob_traits.hh"
+#include "static_vector.hh"
+#include "validators.hh"
+#include "regex.hh"
+#include "fixed_string.hh"
 #include "expected.hh"
+#include <bit>
 #include <concepts>
+#include <memory>
+#include <optional>
 #include <span>
+#include <string>
 #include <type_traits>
+#include <vector>
 
 namespace dodo
 {
@@ -67,36 +82,240 @@ namespace dodo
     {
         ArgsView(Args const & args) noexcept : std::span<std::string_view const>(args.begin(), args.end()) {}
         constexpr ArgsView(std::span<std::string_view const> args) noexcept : std::span<std::string_view const>(args) {}
+
+        // For argument lists known at compile time, which can be parsed in constant expressions.
+        template <size_t N>
+        constexpr ArgsView(std::array<std::string_view, N> const & args) noexcept : std::span<std::string_view const>(args) {}
     };
 
     template <typename T>
-    concept HasValidationCheck = requires(T option, typename T::parse_result_type parse_result) {
-        {option.validate(parse_result)} -> std::same_as<std::optional<std::string_view>>;
+    concept HasValidationCheck = requires(T option, typename T::value_type const & value) {
+        {option.passes(value)} -> std::same_as<bool>;
+        {option.validation_error(value)} -> std::same_as<std::string>;
     };
 
-    template <typename Base, typename Predicate>
-    struct WithCheck : public Base
+    // Error message of a check, either a fixed string or a function that writes it from the value that failed the check.
+    template <typename T, typename ValueType>
+    concept ValidationMessageFor = std::convertible_to<T, std::string_view> || std::is_invocable_r_v<std::string, T const &, ValueType const &>;
+
+    // Predicates that describe the condition they check, for the help text, and write their own error message with an error_message function,
+    // which may take the value that failed the check.
+    template <typename T>
+    concept Validator = requires(T const validator) {
+        {validator.description()} -> std::convertible_to<std::string>;
+    };
+
+    namespace detail
     {
-        constexpr explicit WithCheck(Base base, Predicate predicate_, std::string_view error_message_) : Base(base), validation_predicate(predicate_), error_message(error_message_) {}
+        template <Validator V>
+        struct validator_error_message
+        {
+            template <typename T>
+            constexpr std::string operator () (T const & value) const
+            {
+                if constexpr (requires { validator.error_message(value); })
+                    return validator.error_message(value);
+                else
+                    return validator.error_message();
+            }
+
+            V validator;
+        };
 
-        constexpr std::optional<std::string_view> validate(typename Base::parse_result_type t) const noexcept
+        template <typename Batch>
+        inline constexpr char deferred_batch_kind = 0;
+
+        // Checks that are slow one by one but cheap in bulk, such as checking that paths exist, are not run while each argument is parsed but
+        // collected here and run together when the outermost parse that may defer them finishes. Each kind of check collects into a batch
+        // of its own type, which has a resolve member that runs all of its checks and returns the error of the first one that fails.
+        struct deferred_checks
         {
-            if constexpr (HasValidationCheck<Base>)
+            deferred_checks() noexcept = default;
+            deferred_checks(deferred_checks const &) = delete;
+            deferred_checks & operator = (deferred_checks const &) = delete;
+
+            ~deferred_checks()
+            {
+                for (batch const & b : batches)
+                    b.destroy(b.object);
+            }
+
+            // The batch for checks of type Batch, created the first time a check of that type is deferred.
+            template <typename Batch>
+            Batch & get()
             {
-                auto const base_check_error_message = Base::validate(t);
-                if (base_check_error_message)
-                    return base_check_error_message;
+                for (batch const & b : batches)
+                    if (b.kind == &deferred_batch_kind<Batch>)
+                        return *static_cast<Batch *>(b.object);
+
+                std::unique_ptr<Batch> created = std::make_unique<Batch>();
+                batches.push_back(batch{
+                    .kind = &deferred_batch_kind<Batch>,
+                    .object = created.get(),
+                    .destroy = [](void * object) noexcept { delete static_cast<Batch *>(object); },
+                    .resolve = [](void * object) { return static_cast<Batch *>(object)->resolve(); },
+                });
+                return *created.release();
             }
 
-            if (validation_predicate(t._get()))
+            std::optional<std::string> resolve()
+            {
+                for (batch const & b : batches)
+                    if (std::optional<std::string> error = b.resolve(b.object))
+                        return error;
                 return std::nullopt;
+            }
+
+        private:
+            struct batch
+            {
+                char const * kind;
+                void * object;
+                void (*destroy)(void * object) noexcept;
+                std::optional<std::string> (*resolve)(void * object);
+            };
+
+            std::vector<batch> batches;
+        };
+
+        inline thread_local deferred_checks * active_deferred_checks = nullptr;
+
+        // Makes its checks the active ones for the thread if there were none, so that only the outermost scope resolves them.
+        struct deferred_checks_scope
+        {
+            deferred_checks_scope() noexcept : owner(active_deferred_checks == nullptr)
+            {
+                if (owner)
+                    active_deferred_checks = &checks;
+            }
+
+            deferred_checks_scope(deferred_checks_scope const &) = delete;
+            deferred_checks_scope & operator = (deferred_checks_scope const &) = delete;
+
+            ~deferred_checks_scope()
+            {
+                if (owner)
+                    active_deferred_checks = nullptr;
+            }
+
+            // Nothing for nested scopes, whose checks are resolved by the outermost one.
+            std::optional<std::string> resolve() { return owner ? checks.resolve() : std::nullopt; }
+
+        private:
+            bool owner;
+            deferred_checks checks;
+        };
+
+        template <typename Parse>
+        auto parse_and_resolve_deferred_checks(Parse parse) noexcept -> decltype(parse())
+        {
+            deferred_checks_scope scope;
+            auto result = parse();
+            if (result)
+                if (std::optional<std::string> error = scope.resolve())
+                    return Error(std::move(*error));
+            return result;
+        }
+
+        // Runs parse and then the checks it deferred, unless it is nested in another parse that will run them. Parsers that can not defer
+        // checks, and parsing at compile time, pay nothing for it.
+        template <bool MayDeferChecks, typename Parse>
+        constexpr auto resolving_deferred_checks(Parse parse) noexcept -> decltype(parse())
+        {
+            if constexpr (MayDeferChecks)
+                if (!std::is_constant_evaluated())
+                    return parse_and_resolve_deferred_checks(std::move(parse));
+            return parse();
+        }
+
+        // Defers the checks of an option or argument on its value. They are resolved right away if no parse that can collect them is running.
+        template <typename Checked, typename Value>
+        std::optional<std::string> defer_checks(Checked const & checked, Value const & value, std::string const & context) noexcept
+        {
+            deferred_checks_scope scope;
+            checked.defer_checks(value, *active_deferred_checks, context);
+            return scope.resolve();
+        }
+    } // namespace detail
+
+    // Validators whose checks are resolved in batches, with a defer member that adds the check of a value to a batch of the deferred checks.
+    // The context is the beginning of the error message, which names the option and the argument.
+    template <typename T, typename ValueType>
+    concept DeferredValidator = Validator<T> && requires(T const validator, ValueType const & value, detail::deferred_checks & checks, std::string const & context) {
+        validator.defer(value, checks, context);
+    };
+
+    template <typename T>
+    concept HasDeferredChecks = HasValidationCheck<T> && T::has_deferred_checks;
+
+    // Chained checks are fused into one call to passes, which evaluates all predicates on a reference to the value. The error message is only
+    // resolved after a check fails, by searching for the first check that does not pass.
+    template <typename Base, typename Predicate, ValidationMessageFor<typename Base::value_type> Message = std::string_view>
+    struct WithCheck : public Base
+    {
+        constexpr explicit WithCheck(Base base, Predicate predicate_, Message error_message_) : Base(base), validation_predicate(predicate_), error_message(error_message_) {}
+
+        constexpr bool passes(typename Base::value_type const & value) const noexcept
+        {
+            if constexpr (HasValidationCheck<Base>)
+                return Base::passes(value) && static_cast<bool>(validation_predicate(value));
+            else
+                return static_cast<bool>(validation_predicate(value));
+        }
+
+        // Same as passes, without the checks that are deferred, which are given to defer_checks instead.
+        constexpr bool passes_immediate_checks(typename Base::value_type const & value) const noexcept
+        {
+            bool base_passes = true;
+            if constexpr (HasValidationCheck<Base>)
+                base_passes = Base::passes_immediate_checks(value);
+
+            if constexpr (DeferredValidator<Predicate, typename Base::value_type>)
+                return base_passes;
+            else
+                return base_passes && static_cast<bool>(validation_predicate(value));
+        }
+
+        static constexpr bool has_deferred_checks = DeferredValidator<Predicate, typename Base::value_type> || HasDeferredChecks<Base>;
+
+        void defer_checks(typename Base::value_type const & value, detail::deferred_checks & checks, std::string const & context) const
+        {
+            if constexpr (HasDeferredChecks<Base>)
+                Base::defer_checks(value, checks, context);
+
+            if constexpr (DeferredValidator<Predicate, typename Base::value_type>)
+                validation_predicate.defer(value, checks, context);
+        }
+
+        constexpr std::string validation_error(typename Base::value_type const & value) const
+        {
+            if constexpr (HasValidationCheck<Base>)
+                if (!Base::passes(value))
+                    return Base::validation_error(value);
+
+            if constexpr (std::convertible_to<Message, std::string_view>)
+                return std::string(std::string_view(error_message));
             else
-                return error_message;
+                return error_message(value);
+        }
+
+        // Adds a line to the help text for each check that is a validator.
+        void append_check_descriptions(std::string & out, int column_width) const
+        {
+            if constexpr (HasValidationCheck<Base>)
+                Base::append_check_descriptions(out, column_width);
+
+            if constexpr (Validator<Predicate>)
+            {
+                out += '\n';
+                out.append(static_cast<size_t>(column_width), ' ');
+                out += validation_predicate.description();
+            }
         }
 
     private:
         Predicate validation_predicate;
-        std::string_view error_message;
+        Message error_message;
     };
 
     template <typename Base, explicitly_convertible_to<typename Base::value_type> T>
@@ -131,6 +350,14 @@ namespace dodo
         std::string_view description;
     };
 
+    template <typename Base, fixed_string Description>
+    struct WithStaticDescription : public Base
+    {
+        constexpr explicit WithStaticDescription(Base base) noexcept : Base(base) {}
+
+        static constexpr std::string_view description = Description.view();
+    };
+
     template <typename T>
     concept HasDescription = requires(T option) {
         {option.description} -> std::convertible_to<std::string_view>;
@@ -139,10 +366,45 @@ namespace dodo
     template <typename T>
     concept Pattern = requires (T pattern, std::string_view text) { { pattern.match(text) } -> std::same_as<std::optional<std::string_view>>; };
 
+    namespace detail
+    {
+        // Patterns start with '-' and can not contain '=' or spaces, so no pattern can match an argument meant for another one.
+        constexpr bool is_valid_pattern(std::string_view pattern) noexcept
+        {
+            if (pattern.size() < 2 || pattern[0] != '-' || pattern == "--")
+                return false;
+            for (char const c : pattern)
+                if (c == '=' || c <= ' ')
+                    return false;
+            return true;
+        }
+
+        template <typename T, typename F>
+        constexpr void for_each_pattern(T const & option, F f) noexcept
+        {
+            if constexpr (requires { option.for_each_pattern(f); })
+                option.for_each_pattern(f);
+        }
+    } // namespace detail
+
     template <typename Base>
     struct WithPattern : public Base
     {
-        constexpr explicit WithPattern(Base base, std::string_view pattern_) : Base(base), pattern(pattern_) { assert(pattern[0] == '-'); }
+        constexpr explicit WithPattern(Base base, std::string_view pattern_) : Base(base), pattern(pattern_)
+        {
+            if (!detail::is_valid_pattern(pattern))
+                detail::definition_error("Invalid pattern. Patterns start with '-' and can not contain '=' or spaces.");
+            if constexpr (Pattern<Base>)
+                if (Base::match(pattern))
+                    detail::definition_error("The option already has this pattern.");
+        }
+
+        template <typename F>
+        constexpr void for_each_pattern(F f) const noexcept
+        {
+            detail::for_each_pattern(static_cast<Base const &>(*this), f);
+            f(pattern);
+        }
 
         constexpr std::optional<std::string_view> match(std::string_view text) const noexcept
         {
@@ -164,7 +426,7 @@ namespace dodo
             return std::nullopt;
         }
 
-        std::string patterns_to_string() const
+        constexpr std::string patterns_to_string() const
         {
             std::string out;
 
@@ -182,6 +444,62 @@ namespace dodo
         std::string_view pattern;
     };
 
+    // Pattern given as a template argument. It takes no space in the parser and is matched against a literal of known length.
+    template <typename Base, fixed_string StaticPattern>
+    struct WithStaticPattern : public Base
+    {
+        static_assert(detail::is_valid_pattern(StaticPattern.view()), "Invalid pattern. Patterns start with '-' and can not contain '=' or spaces.");
+
+        constexpr explicit WithStaticPattern(Base base) : Base(base)
+        {
+            if constexpr (Pattern<Base>)
+                if (Base::match(StaticPattern.view()))
+                    detail::definition_error("The option already has this pattern.");
+        }
+
+        template <typename F>
+        constexpr void for_each_pattern(F f) const noexcept
+        {
+            detail::for_each_pattern(static_cast<Base const &>(*this), f);
+            f(StaticPattern.view());
+        }
+
+        constexpr std::optional<std::string_view> match(std::string_view text) const noexcept
+        {
+            if constexpr (Pattern<Base>)
+            {
+                std::optional<std::string_view> const matched = Base::match(text);
+                if (matched)
+                    return matched;
+            }
+
+            constexpr size_t size = StaticPattern.size();
+            if (text.size() >= size && std::char_traits<char>::compare(text.data(), StaticPattern.data, size) == 0)
+            {
+                if (text.size() == size)
+                    return "";
+                else if (text[size] == '=')
+                    return text.substr(size + 1);
+            }
+
+            return std::nullopt;
+        }
+
+        constexpr std::string patterns_to_string() const
+        {
+            std::string out;
+
+            if constexpr (Pattern<Base>)
+            {
+                out = Base::patterns_to_string();
+                out += ", ";
+            }
+
+            out += StaticPattern.view();
+            return out;
+        }
+    };
+
     template <typename T, typename ValueType>
     concept ParserFor = requires(T t, std::string_view text) { {t(text)} -> std::same_as<std::optional<ValueType>>; };
 
@@ -199,6 +517,8 @@ namespace dodo
                 return std::nullopt;
         }
 
+        constexpr std::string parse_error_text(std::string_view) const { return std::string(); }
+
     private:
         ParserFunction custom_parser;
     };
@@ -214,31 +534,116 @@ namespace dodo
         std::string_view custom_hint;
     };
 
+    template <typename Base, fixed_string Hint>
+    struct WithStaticHint : public Base
+    {
+        constexpr explicit WithStaticHint(Base base) noexcept : Base(base) {}
+
+        static constexpr std::string_view hint_text() noexcept { return Hint.view(); }
+    };
+
     template <typename T>
     concept OptionStruct = requires(T a) { { a._get() } -> std::same_as<typename T::value_type const &>; };
 
-    template <OptionStruct T>
-    struct Option
+    namespace detail
     {
-        using parse_result_type = T;
-        using value_type = typename T::value_type;
-
-        constexpr explicit Option(std::string_view type_name_) noexcept : type_name(type_name_) {}
-
-        constexpr std::optional<T> parse_impl(std::string_view argument_text) const noexcept
+        // Name of a type as the compiler writes it, for the hint of options that are not declared with a macro that can stringify the type.
+        template <typename T>
+        constexpr std::string_view type_name() noexcept
         {
-            std::optional<value_type> value = parse_traits<value_type>::parse(argument_text);
-            if (value)
-                return T{std::move(*value)};
+            if constexpr (std::is_same_v<T, std::string>)
+                return "std::string";
+            else if constexpr (std::is_same_v<T, std::string_view>)
+                return "std::string_view";
             else
-                return std::nullopt;
+            {
+            #if defined(_MSC_VER) && !defined(__clang__)
+                std::string_view const signature = __FUNCSIG__;
+                size_t const begin = signature.find("type_name<") + 10;
+                std::string_view name = signature.substr(begin, signature.rfind(">(void)") - begin);
+                for (std::string_view const keyword : {"class ", "struct ", "enum "})
+                    if (name.starts_with(keyword))
+                        name.remove_prefix(keyword.size());
+                return name;
+            #else
+                std::string_view const signature = __PRETTY_FUNCTION__;
+                size_t const begin = signature.find("T = ") + 4;
+                return signature.substr(begin, signature.find_first_of(";]", begin) - begin);
+            #endif
+            }
         }
 
-        constexpr std::string_view hint_text() const noexcept { return type_name; }
+        // Option struct of an option bound to a member of a user class, as in dodo::opt<&Config::width>.
+        template <auto Member>
+        struct member_value;
+
+        template <typename Class, typename T, T Class::* Member>
+        struct member_value<Member>
+        {
+            using value_type = T;
+            using bound_type = Class;
+            static constexpr T Class::* member = Member;
+
+            T value;
+            constexpr T const & _get() const noexcept { return value; }
+        };
+    } // namespace detail
+
+    template <typename T>
+    concept MemberBound = OptionStruct<T> && requires { typename T::bound_type; T::member; };
+
+    namespace detail
+    {
+        // Conversion of the text of an option or positional argument to its option struct, shared by all of them. Derived has a type_name
+        // member, either stored or static, which is the hint when the type has none.
+        template <OptionStruct T, typename Derived>
+        struct value_parser
+        {
+            using parse_result_type = T;
+            using value_type = typename T::value_type;
+
+            constexpr std::optional<T> parse_impl(std::string_view argument_text) const noexcept
+            {
+                std::optional<value_type> value = parse_traits<value_type>::parse(argument_text);
+                if (value)
+                    return T{std::move(*value)};
+                else
+                    return std::nullopt;
+            }
+
+            constexpr std::string_view hint_text() const noexcept
+            {
+                if constexpr (TraitHinted<value_type>)
+                    return parse_traits<value_type>::hint;
+                else
+                    return static_cast<Derived const &>(*this).type_name;
+            }
+
+            constexpr std::string parse_error_text(std::string_view argument_text) const
+            {
+                if constexpr (TraitDiagnosed<value_type>)
+                    return parse_traits<value_type>::parse_error(argument_text);
+                else
+                    return std::string();
+            }
+        };
+    } // namespace detail
+
+    template <OptionStruct T>
+    struct Option : public detail::value_parser<T, Option<T>>
+    {
+        constexpr explicit Option(std::string_view type_name_) noexcept : type_name(type_name_) {}
 
         std::string_view type_name;
     };
 
+    // Option that takes its type name from the compiler, so that it takes no space in the parser.
+    template <OptionStruct T>
+    struct StaticOption : public detail::value_parser<T, StaticOption<T>>
+    {
+        static constexpr std::string_view type_name = detail::type_name<typename T::value_type>();
+    };
+
     template <typename T>
     concept SingleOption = requires(T option, std::string_view arg) {
         {option.match(arg)} -> std::same_as<std::optional<std::string_view>>;
@@ -266,9 +671,11 @@ namespace dodo
     {
         explicit constexpr OptionInterface(Base base) noexcept : Base(base) {}
 
-        auto parse(std::string_view matched_arg) const noexcept -> expected<typename Base::parse_result_type, std::string>;
-        auto parse(ArgsView args) const noexcept -> expected<typename Base::parse_result_type, std::string>;
+        constexpr auto parse(std::string_view matched_arg) const noexcept -> expected<typename Base::parse_result_type, std::string>;
+        constexpr auto parse(ArgsView args) const noexcept -> expected<typename Base::parse_result_type, std::string>;
         std::string to_string(int indentation = 0) const requires HasDescription<Base>;
+        // Lines of the help text after the first one: possible values, checks, default and implicit values.
+        void append_details(std::string & out, int column_width) const;
 
         constexpr OptionInterface<WithDescription<Base>> operator () (std::string_view description) const noexcept requires(!HasDescription<Base>)
         {
@@ -280,6 +687,18 @@ namespace dodo
             return OptionInterface<WithPattern<Base>>(WithPattern<Base>(*this, pattern));
         }
 
+        template <fixed_string Description>
+        constexpr OptionInterface<WithStaticDescription<Base, Description>> describe() const noexcept requires(!HasDescription<Base>)
+        {
+            return OptionInterface<WithStaticDescription<Base, Description>>(WithStaticDescription<Base, Description>(*this));
+        }
+
+        template <fixed_string StaticPattern>
+        constexpr OptionInterface<WithStaticPattern<Base, StaticPattern>> pattern() const noexcept
+        {
+            return OptionInterface<WithStaticPattern<Base, StaticPattern>>(WithStaticPattern<Base, StaticPattern>(*this));
+        }
+
         template <explicitly_convertible_to<typename Base::value_type> T>
         constexpr OptionInterface<WithDefaultValue<Base, T>> by_default(T default_value) const noexcept requires(!HasDefaultValue<Base>)
         {
@@ -310,6 +729,19 @@ namespace dodo
             return OptionInterface<WithCheck<Base, Predicate>>(WithCheck<Base, Predicate>(*this, predicate, error_message));
         }
 
+        template <typename Predicate, std::invocable<typename Base::value_type const &> MessageFunction>
+        constexpr OptionInterface<WithCheck<Base, Predicate, MessageFunction>> check(Predicate predicate, MessageFunction error_message) const noexcept
+        {
+            return OptionInterface<WithCheck<Base, Predicate, MessageFunction>>(WithCheck<Base, Predicate, MessageFunction>(*this, predicate, error_message));
+        }
+
+        template <Validator V>
+        constexpr OptionInterface<WithCheck<Base, V, detail::validator_error_message<V>>> check(V validator) const noexcept
+        {
+            return OptionInterface<WithCheck<Base, V, detail::validator_error_message<V>>>(
+                WithCheck<Base, V, detail::validator_error_message<V>>(*this, validator, detail::validator_error_message<V>{validator}));
+        }
+
         template <ParserFor<typename Base::value_type> ParserFunction>
         constexpr OptionInterface<WithCustomParser<Base, ParserFunction>> custom_parser(ParserFunction parser_function) const noexcept
         {
@@ -320,38 +752,37 @@ namespace dodo
         {
             return OptionInterface<WithCustomHint<Base>>(WithCustomHint<Base>(*this, custom_hint));
         }
+
+        template <fixed_string Hint>
+        constexpr OptionInterface<WithStaticHint<Base, Hint>> hint() const noexcept
+        {
+            return OptionInterface<WithStaticHint<Base, Hint>>(WithStaticHint<Base, Hint>(*this));
+        }
     };
 
     template <OptionStruct T>
-    struct PositionalArgument
+    struct PositionalArgument : public detail::value_parser<T, PositionalArgument<T>>
     {
-        using parse_result_type = T;
-        using value_type = typename T::value_type;
-
         constexpr explicit PositionalArgument(std::string_view name_, std::string_view type_name_) noexcept : name(name_), type_name(type_name_) {}
 
-        constexpr std::optional<T> parse_impl(std::string_view argument_text) const noexcept
-        {
-            std::optional<value_type> value = parse_traits<value_type>::parse(argument_text);
-            if (value)
-                return T{ std::move(*value) };
-            else
-                return std::nullopt;
-        }
-
-        constexpr std::string_view hint_text() const noexcept { return type_name; }
-
         std::string_view name;
         std::string_view type_name;
     };
 
+    template <OptionStruct T, fixed_string Name>
+    struct StaticPositionalArgument : public detail::value_parser<T, StaticPositionalArgument<T, Name>>
+    {
+        static constexpr std::string_view name = Name.view();
+        static constexpr std::string_view type_name = detail::type_name<typename T::value_type>();
+    };
+
     template <typename Base>
     struct PositionalArgumentInterface : public Base
     {
         explicit constexpr PositionalArgumentInterface(Base base) noexcept : Base(base) {}
 
-        auto parse(std::string_view matched_arg) const noexcept -> expected<typename Base::parse_result_type, std::string>;
-        auto parse(ArgsView args) const noexcept -> expected<typename Base::parse_result_type, std::string>;
+        constexpr auto parse(std::string_view matched_arg) const noexcept -> expected<typename Base::parse_result_type, std::string>;
+        constexpr auto parse(ArgsView args) const noexcept -> expected<typename Base::parse_result_type, std::string>;
         std::string to_string(int indentation = 0) const requires HasDescription<Base>;
 
         constexpr PositionalArgumentInterface<WithDescription<Base>> operator () (std::string_view description) const noexcept requires(!HasDescription<Base>)
@@ -359,6 +790,12 @@ namespace dodo
             return PositionalArgumentInterface<WithDescription<Base>>(WithDescription<Base>{*this, description});
         }
 
+        template <fixed_string Description>
+        constexpr PositionalArgumentInterface<WithStaticDescription<Base, Description>> describe() const noexcept requires(!HasDescription<Base>)
+        {
+            return PositionalArgumentInterface<WithStaticDescription<Base, Description>>(WithStaticDescription<Base, Description>(*this));
+        }
+
         template <explicitly_convertible_to<typename Base::value_type> T>
         constexpr PositionalArgumentInterface<WithDefaultValue<Base, T>> by_default(T default_value) const noexcept requires(!HasDefaultValue<Base>)
         {
@@ -377,6 +814,19 @@ namespace dodo
             return PositionalArgumentInterface<WithCheck<Base, Predicate>>(WithCheck<Base, Predicate>(*this, predicate, error_message));
         }
 
+        template <typename Predicate, std::invocable<typename Base::value_type const &> MessageFunction>
+        constexpr PositionalArgumentInterface<WithCheck<Base, Predicate, MessageFunction>> check(Predicate predicate, MessageFunction error_message) const noexcept
+        {
+            return PositionalArgumentInterface<WithCheck<Base, Predicate, MessageFunction>>(WithCheck<Base, Predicate, MessageFunction>(*this, predicate, error_message));
+        }
+
+        template <Validator V>
+        constexpr PositionalArgumentInterface<WithCheck<Base, V, detail::validator_error_message<V>>> check(V validator) const noexcept
+        {
+            return PositionalArgumentInterface<WithCheck<Base, V, detail::validator_error_message<V>>>(
+                WithCheck<Base, V, detail::validator_error_message<V>>(*this, validator, detail::validator_error_message<V>{validator}));
+        }
+
         template <ParserFor<typename Base::value_type> ParserFunction>
         constexpr PositionalArgumentInterface<WithCustomParser<Base, ParserFunction>> custom_parser(ParserFunction parser_function) const noexcept
         {
@@ -387,15 +837,95 @@ namespace dodo
         {
             return PositionalArgumentInterface<WithCustomHint<Base>>(WithCustomHint<Base>(*this, custom_hint));
         }
+
+        template <fixed_string Hint>
+        constexpr PositionalArgumentInterface<WithStaticHint<Base, Hint>> hint() const noexcept
+        {
+            return PositionalArgumentInterface<WithStaticHint<Base, Hint>>(WithStaticHint<Base, Hint>(*this));
+        }
     };
     
     template <typename T>
     concept SingleArgument = instantiation_of<T, PositionalArgumentInterface>;
 
+    // Parsers that can write their help text, which compound parsers only can when all their options and arguments have a description.
+    template <typename T>
+    concept HasHelpText = requires(T const parser, int indentation) {
+        {parser.to_string(indentation)} -> std::same_as<std::string>;
+    };
+
+    // Options and positional arguments bound to a member of a user class, as an alternative to dodo_Opt and dodo_Arg that does not declare types
+    // in a decltype expression, which only MSVC accepts. Compounds of them return the class. A single one used as a parser returns its option
+    // struct, detail::member_value, whose value member holds the value, so it must be wrapped in CompoundOption or CompoundArgument to return
+    // the class.
+    template <auto Member>
+    constexpr auto opt = OptionInterface(StaticOption<detail::member_value<Member>>());
+
+    template <auto Member>
+    constexpr auto flag = opt<Member>.by_default(false).implicitly(true);
+
+    template <auto Member>
+    constexpr auto arg(std::string_view name) noexcept
+    {
+        return PositionalArgumentInterface(PositionalArgument<detail::member_value<Member>>(name, detail::type_name<typename detail::member_value<Member>::value_type>()));
+    }
+
+    // With the name as a template argument, the argument takes no space in the parser.
+    template <auto Member, fixed_string Name>
+    constexpr auto arg() noexcept
+    {
+        return PositionalArgumentInterface(StaticPositionalArgument<detail::member_value<Member>, Name>());
+    }
+
     namespace detail
     {
         template <typename T>
         using get_parse_result_type = typename T::parse_result_type;
+
+        // A compound of options bound to members of a class returns an object of that class. Otherwise it returns a struct that derives from
+        // the option structs of all its options.
+        template <typename Merged, typename ... Parts>
+        struct compound_result
+        {
+            static_assert(!(MemberBound<Parts> || ...), "Options bound to members can not be combined with options declared with dodo_Opt or dodo_Arg.");
+            using type = Merged;
+        };
+
+        template <typename Merged, MemberBound First, MemberBound ... Rest>
+        struct compound_result<Merged, First, Rest...>
+        {
+            static_assert((std::is_same_v<typename First::bound_type, typename Rest::bound_type> && ...), "All options must be bound to members of the same class.");
+            using type = typename First::bound_type;
+        };
+
+        template <typename Merged, typename ... Parts>
+        using compound_result_t = typename compound_result<Merged, Parts...>::type;
+
+        template <typename Result, typename ... Parts>
+        constexpr Result merge_results(Parts ... parts)
+        {
+            if constexpr ((MemberBound<Parts> && ...))
+            {
+                Result result{};
+                ((result.*Parts::member = std::move(parts.value)), ...);
+                return result;
+            }
+            else
+                return Result{std::move(parts)...};
+        }
+
+        // When both are bound to the same class, the members of the arguments are moved into the object parsed from the options.
+        template <typename Result, typename Arguments, typename ArgumentsResult, typename OptionsResult>
+        constexpr Result merge_parser_results(ArgumentsResult arguments, OptionsResult options)
+        {
+            if constexpr (std::is_same_v<ArgumentsResult, OptionsResult>)
+            {
+                Arguments::move_bound_members(arguments, options);
+                return options;
+            }
+            else
+                return Result{std::move(arguments), std::move(options)};
+        }
     }
 
     #define dodo_parse_result_type(cli) dodo::detail::get_parse_result_type<std::remove_cvref_t<decltype(cli)>>
@@ -404,18 +934,40 @@ namespace dodo
     template <SingleOption ... Options>
     struct CompoundOption : private Options...
     {
-        constexpr explicit CompoundOption(Options... options) noexcept : Options(options)... {}
+        constexpr explicit CompoundOption(Options... options) noexcept;
 
-        struct parse_result_type : public detail::get_parse_result_type<Options>... {};
+        struct merged_result_type : public detail::get_parse_result_type<Options>... {};
+        using parse_result_type = detail::compound_result_t<merged_result_type, detail::get_parse_result_type<Options>...>;
 
-        auto parse(ArgsView args) const noexcept -> expected<parse_result_type, std::string>;
-        std::string to_string(int indentation = 0) const;
+        constexpr auto parse(ArgsView args) const noexcept -> expected<parse_result_type, std::string>;
+        constexpr auto parse(ArgsView args, uint64_t & given_options) const noexcept -> expected<parse_result_type, std::string>;
+        std::string to_string(int indentation = 0) const requires (HasDescription<Options> && ...);
+
+        template <std::convertible_to<std::string_view> ... Names>
+        constexpr auto exactly_one_of(Names ... names) const noexcept;
+        template <std::convertible_to<std::string_view> ... Names>
+        constexpr auto at_most_one_of(Names ... names) const noexcept;
+        template <std::convertible_to<std::string_view> ... Names>
+        constexpr auto depends_on(std::string_view option, Names ... dependencies) const noexcept;
 
         template <SingleOption T>
         constexpr T const & access_option() const noexcept
         {
             return static_cast<T const &>(*this);
         }
+
+        static constexpr size_t option_count = sizeof...(Options);
+
+        template <typename F>
+        constexpr void for_each_pattern(F f) const noexcept { (detail::for_each_pattern(access_option<Options>(), f), ...); }
+
+        // Index of the option that matches the name, which can be any of its patterns, or option_count if none does.
+        constexpr size_t find_option(std::string_view name) const noexcept;
+        // Same as find_option, for constraints, which must name an option that exists.
+        constexpr size_t option_index(std::string_view name) const noexcept;
+        // Mask of the options that have no default value.
+        static constexpr uint64_t required_options() noexcept;
+        constexpr std::string option_names(uint64_t options) const;
     };
 
     template <SingleOption A, SingleOption B>         constexpr CompoundOption<A, B> operator | (A a, B b) noexcept;
@@ -428,16 +980,28 @@ namespace dodo
     {
         constexpr explicit CompoundArgument(Arguments... args) noexcept : Arguments(args)... {}
 
-        struct parse_result_type : public detail::get_parse_result_type<Arguments>... {};
+        struct merged_result_type : public detail::get_parse_result_type<Arguments>... {};
+        using parse_result_type = detail::compound_result_t<merged_result_type, detail::get_parse_result_type<Arguments>...>;
 
-        auto parse(ArgsView args) const noexcept -> expected<parse_result_type, std::string>;
-        std::string to_string(int indentation = 0) const;
+        constexpr auto parse(ArgsView args) const noexcept -> expected<parse_result_type, std::string>;
+        std::string to_string(int indentation = 0) const requires (HasDescription<Arguments> && ...);
 
         template <SingleArgument T>
         constexpr T const & access_argument() const noexcept
         {
             return static_cast<T const &>(*this);
         }
+
+        template <typename F>
+        constexpr void for_each_name(F f) const noexcept { (f(access_argument<Arguments>().name), ...); }
+
+        // Moves the members the arguments are bound to from one object of their class to another.
+        static constexpr void move_bound_members(parse_result_type & from, parse_result_type & to) noexcept requires (MemberBound<detail::get_parse_result_type<Arguments>> && ...)
+        {
+            ((to.*detail::get_parse_result_type<Arguments>::member = std::move(from.*detail::get_parse_result_type<Arguments>::member)), ...);
+        }
+    private:
+        constexpr auto parse_arguments(ArgsView args) const noexcept -> expected<parse_result_type, std::string>;
     };
 
     template <SingleArgument A, SingleArgument B>         constexpr CompoundArgument<A, B> operator | (A a, B b) noexcept;
@@ -450,10 +1014,26 @@ namespace dodo
     {
         constexpr explicit CompoundParser(Arguments args, Options opts) noexcept : Arguments(args), Options(opts) {}
 
-        struct parse_result_type : public detail::get_parse_result_type<Arguments>, public detail::get_parse_result_type<Options> {};
+        struct merged_result_type : public detail::get_parse_result_type<Arguments>, public detail::get_parse_result_type<Options> {};
+        // Arguments and options bound to members of the same class are parsed into one object of the class.
+        using parse_result_type = std::conditional_t<
+            std::is_same_v<detail::get_parse_result_type<Arguments>, detail::get_parse_result_type<Options>>,
+            detail::get_parse_result_type<Options>,
+            merged_result_type>;
+
+        constexpr auto parse(ArgsView args) const noexcept -> expected<parse_result_type, std::string>;
+        constexpr auto parse(ArgsView args, uint64_t & given_options) const noexcept -> expected<parse_result_type, std::string>;
+        std::string to_string(int indentation = 0) const requires HasHelpText<Arguments> && HasHelpText<Options>;
+
+        template <std::convertible_to<std::string_view> ... Names>
+        constexpr auto exactly_one_of(Names ... names) const noexcept;
+        template <std::convertible_to<std::string_view> ... Names>
+        constexpr auto at_most_one_of(Names ... names) const noexcept;
+        template <std::convertible_to<std::string_view> ... Names>
+        constexpr auto depends_on(std::string_view option, Names ... dependencies) const noexcept;
 
-        auto parse(ArgsView args) const noexcept -> expected<parse_result_type, std::string>;
-        std::string to_string(int indentation = 0) const;
+        template <typename F>
+        constexpr void for_each_pattern(F f) const noexcept { Options::for_each_pattern(f); }
 
         constexpr Options const & access_options() const noexcept
         {
@@ -498,6 +1078,55 @@ namespace dodo
     constexpr auto operator | (CompoundParser<CompoundArgument<ArgsA...>, CompoundOption<OptsA...>> a, CompoundParser<CompoundArgument<ArgsB...>, CompoundOption<OptsB...>> b) noexcept
         -> CompoundParser<CompoundArgument<ArgsA..., ArgsB...>, CompoundOption<OptsA..., OptsB...>>;
 
+    enum struct constraint_kind { exactly_one_of, at_most_one_of, depends_on };
+
+    // Relation between options, checked after parsing with bit operations over the mask of the options given in the command line.
+    struct option_constraint
+    {
+        constexpr bool holds(uint64_t given_options) const noexcept
+        {
+            uint64_t const given = given_options & options;
+            switch (kind)
+            {
+                case constraint_kind::exactly_one_of: return std::has_single_bit(given);
+                case constraint_kind::at_most_one_of: return (given & (given - 1)) == 0;
+                default: return given == 0 || (given_options & dependencies) == dependencies;
+            }
+        }
+
+        constraint_kind kind = constraint_kind::at_most_one_of;
+        uint64_t options = 0;       // Options in the group, or the option that has dependencies.
+        uint64_t dependencies = 0;  // Options that must be given with it. Only for depends_on.
+    };
+
+    template <typename T>
+    concept ConstrainableParser = instantiation_of<T, CompoundOption> || instantiation_of<T, CompoundParser>;
+
+    template <ConstrainableParser P, size_t N>
+    struct WithConstraints : public P
+    {
+        constexpr explicit WithConstraints(P parser, std::array<option_constraint, N> constraints_) noexcept : P(parser), constraints(constraints_) {}
+
+        constexpr auto parse(ArgsView args) const noexcept -> expected<typename P::parse_result_type, std::string>;
+        std::string to_string(int indentation = 0) const requires HasHelpText<P>;
+
+        template <std::convertible_to<std::string_view> ... Names>
+        constexpr auto exactly_one_of(Names ... names) const noexcept -> WithConstraints<P, N + 1>;
+        template <std::convertible_to<std::string_view> ... Names>
+        constexpr auto at_most_one_of(Names ... names) const noexcept -> WithConstraints<P, N + 1>;
+        template <std::convertible_to<std::string_view> ... Names>
+        constexpr auto depends_on(std::string_view option, Names ... dependencies) const noexcept -> WithConstraints<P, N + 1>;
+
+        std::array<option_constraint, N> constraints;
+
+    private:
+        constexpr auto const & constrained_options() const noexcept;
+        template <typename ... Names>
+        constexpr uint64_t options_mask(Names ... names) const noexcept;
+        constexpr auto add_constraint(option_constraint constraint) const noexcept -> WithConstraints<P, N + 1>;
+        constexpr std::string constraint_text(option_constraint const & constraint) const;
+    };
+
     template <typename Tag>
     struct NoopParser
     {
@@ -546,11 +1175,13 @@ namespace dodo
     {
         using parse_result_type = std::variant<detail::get_parse_result_type<Commands>...>;
 
-        constexpr explicit CommandSelector(Commands... commands) noexcept : Commands(commands)... {}
+        constexpr explicit CommandSelector(Commands... commands) noexcept;
 
-        auto parse(ArgsView args) const noexcept -> expected<parse_result_type, std::string>;
+        constexpr auto parse(ArgsView args) const noexcept -> expected<parse_result_type, std::string>;
 
         constexpr bool match(std::string_view text) const noexcept { return (access_command<Commands>().match(text) || ...); }
+        // Only commands with a name member are considered. Other command types may match any text.
+        constexpr size_t count_commands_named(std::string_view name) const noexcept;
 
         std::string to_string(int indentation = 0) const noexcept;
 
@@ -569,10 +1200,7 @@ namespace dodo
     template <Parser SharedOptions, instantiation_of<CommandSelector> Commands>
     struct CommandWithSharedOptions
     {
-        constexpr explicit CommandWithSharedOptions(SharedOptions shared_options_, Commands commands_) noexcept
-            : shared_options(std::move(shared_options_))
-            , commands(std::move(commands_))
-        {}
+        constexpr explicit CommandWithSharedOptions(SharedOptions shared_options_, Commands commands_) noexcept;
 
         struct parse_result_type
         {
@@ -580,11 +1208,14 @@ namespace dodo
             typename Commands::parse_result_type command;
         };
 
-        auto parse(ArgsView args) const noexcept -> expected<parse_result_type, std::string>;
-        std::string to_string(int indentation = 0) const noexcept;
+        constexpr auto parse(ArgsView args) const noexcept -> expected<parse_result_type, std::string>;
+        std::string to_string(int indentation = 0) const noexcept requires HasHelpText<SharedOptions>;
 
         SharedOptions shared_options;
         Commands commands;
+
+    private:
+        constexpr auto parse_shared_options_and_command(ArgsView args) const noexcept -> expected<parse_result_type, std::string>;
     };
 
     template <Parser P>
@@ -611,8 +1242,8 @@ namespace dodo
 
         using parse_result_type = either<typename Commands::parse_result_type, typename ImplicitCommand::parse_result_type>;
 
-        auto parse(ArgsView args) const noexcept -> expected<parse_result_type, std::string>;
-        std::string to_string(int indentation = 0) const noexcept;
+        constexpr auto parse(ArgsView args) const noexcept -> expected<parse_result_type, std::string>;
+        std::string to_string(int indentation = 0) const noexcept requires HasHelpText<ImplicitCommand>;
 
         Commands commands;
         ImplicitCommand implicit_command;
@@ -628,6 +1259,40 @@ namespace dodo
     constexpr auto operator | (CommandWithImplicitCommand<Commands, CurrentImplicitCommand> commands, NewImplicitCommand new_implicit_command) noexcept
         -> CommandWithImplicitCommand<Commands, decltype(commands.implicit_command | new_implicit_command)>;
 
+    namespace detail
+    {
+        // Whether parsing with P may defer checks, in which case the parse collects them and resolves them before returning.
+        template <typename P>
+        constexpr bool may_defer_checks = false;
+
+        template <typename Base>
+        constexpr bool may_defer_checks<OptionInterface<Base>> = HasDeferredChecks<Base>;
+
+        template <typename Base>
+        constexpr bool may_defer_checks<PositionalArgumentInterface<Base>> = HasDeferredChecks<Base>;
+
+        template <SingleOption ... Options>
+        constexpr bool may_defer_checks<CompoundOption<Options...>> = (may_defer_checks<Options> || ...);
+
+        template <SingleArgument ... Arguments>
+        constexpr bool may_defer_checks<CompoundArgument<Arguments...>> = (may_defer_checks<Arguments> || ...);
+
+        template <instantiation_of<CompoundArgument> Arguments, instantiation_of<CompoundOption> Options>
+        constexpr bool may_defer_checks<CompoundParser<Arguments, Options>> = may_defer_checks<Arguments> || may_defer_checks<Options>;
+
+        template <ConstrainableParser P, size_t N>
+        constexpr bool may_defer_checks<WithConstraints<P, N>> = may_defer_checks<P>;
+
+        template <Parser P>
+        constexpr bool may_defer_checks<Command<P>> = may_defer_checks<P>;
+
+        template <CommandType ... Commands>
+        constexpr bool may_defer_checks<CommandSelector<Commands...>> = (may_defer_checks<Commands> || ...);
+
+        template <Parser SharedOptions, instantiation_of<CommandSelector> Commands>
+        constexpr bool may_defer_checks<CommandWithSharedOptions<SharedOptions, Commands>> = may_defer_checks<SharedOptions> || may_defer_checks<Commands>;
+    } // namespace detail
+
 } // namespace dodo
 
 #include "dodo.inl"
@@ -10,13 +10,39 @@ namespace dodo
         }
 
         template <typename ... Args>
-        Error<std::string> make_error(Args const & ... args)
+        constexpr Error<std::string> make_error(Args const & ... args)
         {
             std::string result;
             ((result += args), ...);
             return result;
         }
 
+        constexpr Error<std::string> conversion_error(std::string_view matched_arg, std::string_view type_name, std::string_view explanation)
+        {
+            if (explanation.empty())
+                return make_error("Could not convert argument \"", matched_arg, "\" to type ", type_name);
+            else
+                return make_error("Could not convert argument \"", matched_arg, "\" to type ", type_name, ":\n\t", explanation);
+        }
+
+        template <TraitEnumerable T>
+        std::string value_names_to_string()
+        {
+            std::string result;
+
+            for (std::string_view const name : parse_traits<T>::value_names())
+            {
+                result += name;
+                result += ", ";
+            }
+
+            // Remove last separator.
+            if (!result.empty())
+                result.resize(result.size() - 2);
+
+            return result;
+        }
+
         template <std::predicate<char> P>
         inline void next_word_unscaped(std::string_view in, size_t & i, char out[], size_t & out_i, P is_delimiter)
         {
@@ -121,7 +147,7 @@ namespace dodo
     // OptionInterface
 
     template <typename Base>
-    auto OptionInterface<Base>::parse(std::string_view matched_arg) const noexcept -> expected<typename Base::parse_result_type, std::string>
+    constexpr auto OptionInterface<Base>::parse(std::string_view matched_arg) const noexcept -> expected<typename Base::parse_result_type, std::string>
     {
         if constexpr (HasImplicitValue<Base>)
             if (matched_arg.empty())
@@ -129,22 +155,37 @@ namespace dodo
 
         auto parse_result = this->parse_impl(matched_arg);
         if (!parse_result)
-            return detail::make_error("Could not convert argument \"", matched_arg, "\" to type ", this->type_name);
+            return detail::conversion_error(matched_arg, this->type_name, this->parse_error_text(matched_arg));
+
+        // Deferred checks are run together with those of the other options and arguments when the parse finishes.
+        if constexpr (HasDeferredChecks<Base>)
+        {
+            if (!std::is_constant_evaluated())
+            {
+                std::string const context = "Validation check failed for option " + this->patterns_to_string() + "with argument \"" + std::string(matched_arg) + "\":\n\t";
+                if (!this->passes_immediate_checks(parse_result->_get()))
+                    return Error(context + this->validation_error(parse_result->_get()));
+
+                if (std::optional<std::string> error = detail::defer_checks(*this, parse_result->_get(), context))
+                    return Error(std::move(*error));
+
+                return std::move(*parse_result);
+            }
+        }
 
         if constexpr (HasValidationCheck<Base>)
         {
-            std::optional<std::string_view> const validation_error_message = this->validate(*parse_result);
-            if (validation_error_message)
+            if (!this->passes(parse_result->_get()))
                 return detail::make_error(
                     "Validation check failed for option ", this->patterns_to_string(), "with argument \"", matched_arg, "\":\n\t",
-                    *validation_error_message);
+                    this->validation_error(parse_result->_get()));
         }
 
         return std::move(*parse_result);
     }
 
     template <typename Base>
-    auto OptionInterface<Base>::parse(ArgsView args) const noexcept -> expected<typename Base::parse_result_type, std::string>
+    constexpr auto OptionInterface<Base>::parse(ArgsView args) const noexcept -> expected<typename Base::parse_result_type, std::string>
     {
         if (args.size() == 0)
         {
@@ -179,6 +220,24 @@ namespace dodo
         out += ">";
         while (out.size() < column_width) out.push_back(' ');
         out += this->description;
+        append_details(out, column_width);
+        out += '\n';
+        return out;
+    }
+
+    template <typename Base>
+    void OptionInterface<Base>::append_details([[maybe_unused]] std::string & out, [[maybe_unused]] int column_width) const
+    {
+        if constexpr (TraitEnumerable<typename Base::value_type>)
+        {
+            out += '\n';
+            for (int i = 0; i < column_width; ++i) out.push_back(' ');
+            out += "Possible values: ";
+            out += detail::value_names_to_string<typename Base::value_type>();
+        }
+
+        if constexpr (HasValidationCheck<Base>)
+            this->append_check_descriptions(out, column_width);
 
         if constexpr (HasDefaultValue<Base>)
         {
@@ -195,9 +254,6 @@ namespace dodo
             out += "Implicitly: ";
             out += dodo::to_string(this->implicit_value);
         }
-
-        out += '\n';
-        return out;
     }
 
     #undef dodo_Opt
@@ -218,26 +274,41 @@ namespace dodo
     // PositionalArgumentInterface
 
     template <typename Base>
-    auto PositionalArgumentInterface<Base>::parse(std::string_view matched_arg) const noexcept -> expected<typename Base::parse_result_type, std::string>
+    constexpr auto PositionalArgumentInterface<Base>::parse(std::string_view matched_arg) const noexcept -> expected<typename Base::parse_result_type, std::string>
     {
         auto parse_result = this->parse_impl(matched_arg);
         if (!parse_result)
-            return detail::make_error("Could not convert argument \"", matched_arg, "\" to type ", this->type_name);
+            return detail::conversion_error(matched_arg, this->type_name, this->parse_error_text(matched_arg));
+
+        // Deferred checks are run together with those of the other options and arguments when the parse finishes.
+        if constexpr (HasDeferredChecks<Base>)
+        {
+            if (!std::is_constant_evaluated())
+            {
+                std::string const context = "Validation check failed for argument " + std::string(this->name) + "with argument \"" + std::string(matched_arg) + "\":\n\t";
+                if (!this->passes_immediate_checks(parse_result->_get()))
+                    return Error(context + this->validation_error(parse_result->_get()));
+
+                if (std::optional<std::string> error = detail::defer_checks(*this, parse_result->_get(), context))
+                    return Error(std::move(*error));
+
+                return std::move(*parse_result);
+            }
+        }
 
         if constexpr (HasValidationCheck<Base>)
         {
-            std::optional<std::string_view> const validation_error_message = this->validate(*parse_result);
-            if (validation_error_message)
+            if (!this->passes(parse_result->_get()))
                 return detail::make_error(
                     "Validation check failed for argument ", this->name, "with argument \"", matched_arg, "\":\n\t",
-                    *validation_error_message);
+                    this->validation_error(parse_result->_get()));
         }
 
         return std::move(*parse_result);
     }
 
     template <typename Base>
-    auto PositionalArgumentInterface<Base>::parse(ArgsView args) const noexcept -> expected<typename Base::parse_result_type, std::string>
+    constexpr auto PositionalArgumentInterface<Base>::parse(ArgsView args) const noexcept -> expected<typename Base::parse_result_type, std::string>
     {
         if (args.size() == 0)
         {
@@ -271,12 +342,23 @@ namespace dodo
         while (out.size() < column_width) out.push_back(' ');
         out += this->description;
 
+        if constexpr (TraitEnumerable<typename Base::value_type>)
+        {
+            out += '\n';
+            for (int i = 0; i < column_width; ++i) out.push_back(' ');
+            out += "Possible values: ";
+            out += detail::value_names_to_string<typename Base::value_type>();
+        }
+
+        if constexpr (HasValidationCheck<Base>)
+            this->append_check_descriptions(out, column_width);
+
         if constexpr (HasDefaultValue<Base>)
         {
             out += '\n';
             for (int i = 0; i < column_width; ++i) out.push_back(' ');
             out += "By default: ";
-            out += ::to_string(this->default_value);
+            out += dodo::to_string(this->default_value);
         }
 
         out += '\n';
@@ -292,7 +374,7 @@ namespace dodo
             constexpr type const & _get() const noexcept { return var; }                                                                \
         };                                                                                                                              \
         return static_cast<OptionTypeImpl *>(nullptr);                                                                                  \
-    }())>>(#type, name))
+    }())>>(name, #type))
 
     //*****************************************************************************************************************************************************
     // CompoundOption
@@ -300,25 +382,23 @@ namespace dodo
     template <SingleOption Option>
     using option_parse_result = std::optional<expected<typename Option::parse_result_type, std::string>>;
 
+    // Patterns are unique within a CompoundOption, so the first option that matches the argument is the only one that can take it.
     template <SingleOption Option>
-    bool try_parse_argument(Option const & parser, std::string_view arg, option_parse_result<Option> & result)
+    constexpr bool try_parse_argument(Option const & parser, std::string_view arg, option_parse_result<Option> & result)
     {
-        if (!result)
-        {
-            std::optional<std::string_view> const matched = parser.match(arg);
-            if (matched)
-            {
-                result = option_parse_result<Option>(parser.parse(*matched));
-                return true;
-            }
-            else
-                return false;
-        }
-        return false;
+        std::optional<std::string_view> const matched = parser.match(arg);
+        if (!matched)
+            return false;
+
+        if (result)
+            result = option_parse_result<Option>(detail::make_error("Option ", parser.patterns_to_string(), " was given more than once"));
+        else
+            result = option_parse_result<Option>(parser.parse(*matched));
+        return true;
     }
 
     template <SingleOption Option>
-    void complete_with_default_value([[maybe_unused]] Option const & parser, [[maybe_unused]] option_parse_result<Option> & result)
+    constexpr void complete_with_default_value([[maybe_unused]] Option const & parser, [[maybe_unused]] option_parse_result<Option> & result)
     {
         if constexpr (HasDefaultValue<Option>)
             if (!result)
@@ -326,7 +406,30 @@ namespace dodo
     }
 
     template <SingleOption ... Options>
-    auto CompoundOption<Options...>::parse(ArgsView args) const noexcept -> expected<parse_result_type, std::string>
+    constexpr CompoundOption<Options...>::CompoundOption(Options... options) noexcept : Options(options)...
+    {
+        size_t index = 0;
+        for_each_pattern([&](std::string_view pattern)
+        {
+            size_t other_index = 0;
+            for_each_pattern([&](std::string_view other)
+            {
+                if (other_index++ > index && other == pattern)
+                    detail::definition_error("Two options have the same pattern.");
+            });
+            ++index;
+        });
+    }
+
+    template <SingleOption ... Options>
+    constexpr auto CompoundOption<Options...>::parse(ArgsView args) const noexcept -> expected<parse_result_type, std::string>
+    {
+        uint64_t given_options = 0;
+        return detail::resolving_deferred_checks<detail::may_defer_checks<CompoundOption>>([&] { return parse(args, given_options); });
+    }
+
+    template <SingleOption ... Options>
+    constexpr auto CompoundOption<Options...>::parse(ArgsView args, uint64_t & given_options) const noexcept -> expected<parse_result_type, std::string>
     {
         std::tuple<option_parse_result<Options>...> option_parse_results;
 
@@ -342,25 +445,104 @@ namespace dodo
                 return detail::make_error("Unrecognized argument \"", arg, '"');
         }
 
+        // Constraints only support the first 64 options, so the rest are left out of the mask.
+        given_options = [&option_parse_results]<size_t ... Is>(std::index_sequence<Is...>)
+        {
+            return ((Is < 64 ? uint64_t(std::get<Is>(option_parse_results).has_value()) << (Is % 64) : 0) | ...);
+        }(std::index_sequence_for<Options...>());
+
         (complete_with_default_value(access_option<Options>(), std::get<option_parse_result<Options>>(option_parse_results)), ...);
 
         // Check that all options were matched.
         if (!(std::get<option_parse_result<Options>>(option_parse_results) && ...))
             return detail::make_error("Unmatched option");
 
-        // Check that no option failed to parse.
-        if (!(*std::get<option_parse_result<Options>>(option_parse_results) && ...))
-            return detail::make_error("Option failed to parse");
-
-        return parse_result_type{std::move(**std::get<option_parse_result<Options>>(option_parse_results))...};
+        // Check that no option failed to parse. The error of the first one that failed is reported.
+        std::string_view first_error;
+        bool const all_parsed = ([&first_error](auto const & result)
+        {
+            if (!*result)
+                first_error = result->error();
+            return result->has_value();
+        }(std::get<option_parse_result<Options>>(option_parse_results)) && ...);
+        if (!all_parsed)
+            return detail::make_error(first_error);
+
+        return detail::merge_results<parse_result_type>(std::move(**std::get<option_parse_result<Options>>(option_parse_results))...);
     }
 
     template <SingleOption ... Options>
-    std::string CompoundOption<Options...>::to_string(int indentation) const
+    std::string CompoundOption<Options...>::to_string(int indentation) const requires (HasDescription<Options> && ...)
     {
         return (this->template access_option<Options>().to_string(indentation) + ...);
     }
 
+    template <SingleOption ... Options>
+    template <std::convertible_to<std::string_view> ... Names>
+    constexpr auto CompoundOption<Options...>::exactly_one_of(Names ... names) const noexcept
+    {
+        return WithConstraints<CompoundOption, 0>(*this, {}).exactly_one_of(names...);
+    }
+
+    template <SingleOption ... Options>
+    template <std::convertible_to<std::string_view> ... Names>
+    constexpr auto CompoundOption<Options...>::at_most_one_of(Names ... names) const noexcept
+    {
+        return WithConstraints<CompoundOption, 0>(*this, {}).at_most_one_of(names...);
+    }
+
+    template <SingleOption ... Options>
+    template <std::convertible_to<std::string_view> ... Names>
+    constexpr auto CompoundOption<Options...>::depends_on(std::string_view option, Names ... dependencies) const noexcept
+    {
+        return WithConstraints<CompoundOption, 0>(*this, {}).depends_on(option, dependencies...);
+    }
+
+    template <SingleOption ... Options>
+    constexpr size_t CompoundOption<Options...>::find_option(std::string_view name) const noexcept
+    {
+        size_t index = 0;
+        static_cast<void>(((this->template access_option<Options>().match(name).has_value() || (++index, false)) || ...));
+        return index;
+    }
+
+    template <SingleOption ... Options>
+    constexpr size_t CompoundOption<Options...>::option_index(std::string_view name) const noexcept
+    {
+        static_assert(sizeof...(Options) <= 64, "Constraints support parsers of up to 64 options.");
+
+        size_t const index = find_option(name);
+        if (index == option_count)
+            detail::definition_error("Constraint names an option that does not exist.");
+        return index;
+    }
+
+    template <SingleOption ... Options>
+    constexpr uint64_t CompoundOption<Options...>::required_options() noexcept
+    {
+        uint64_t required = 0;
+        size_t index = 0;
+        ((required |= uint64_t(!HasDefaultValue<Options>) << index++), ...);
+        return required;
+    }
+
+    template <SingleOption ... Options>
+    constexpr std::string CompoundOption<Options...>::option_names(uint64_t options) const
+    {
+        std::string out;
+        size_t index = 0;
+        ([&](auto const & option)
+        {
+            if ((options >> index++) & 1)
+            {
+                if (!out.empty())
+                    out += ", ";
+                out += option.patterns_to_string();
+            }
+        }(this->template access_option<Options>()), ...);
+        return out;
+    }
+
     template <SingleOption A, SingleOption B>
     constexpr CompoundOption<A, B> operator | (A a, B b) noexcept
     {
@@ -391,7 +573,13 @@ namespace dodo
     // CompoundArgument
 
     template <SingleArgument ... Arguments>
-    auto CompoundArgument<Arguments...>::parse(ArgsView args) const noexcept -> expected<parse_result_type, std::string>
+    constexpr auto CompoundArgument<Arguments...>::parse(ArgsView args) const noexcept -> expected<parse_result_type, std::string>
+    {
+        return detail::resolving_deferred_checks<detail::may_defer_checks<CompoundArgument>>([&] { return parse_arguments(args); });
+    }
+
+    template <SingleArgument ... Arguments>
+    constexpr auto CompoundArgument<Arguments...>::parse_arguments(ArgsView args) const noexcept -> expected<parse_result_type, std::string>
     {
         if (args.size() > sizeof...(Arguments))
             return detail::make_error("Too many arguments. Provided", std::to_string(args.size()), "arguments. Program expects ", std::to_string(sizeof...(Arguments)));
@@ -403,15 +591,22 @@ namespace dodo
 
         }(std::make_index_sequence<sizeof...(Arguments)>());
 
-        // Ensure that all arguments were parsed.
-        if (!(std::get<expected<detail::get_parse_result_type<Arguments>, std::string>>(results) && ...))
-            return detail::make_error("Argument failed to parse");
+        // Ensure that all arguments were parsed. The error of the first one that failed is reported.
+        std::string_view first_error;
+        bool const all_parsed = ([&first_error](auto const & result)
+        {
+            if (!result)
+                first_error = result.error();
+            return result.has_value();
+        }(std::get<expected<detail::get_parse_result_type<Arguments>, std::string>>(results)) && ...);
+        if (!all_parsed)
+            return detail::make_error(first_error);
 
-        return parse_result_type{std::move(*std::get<expected<detail::get_parse_result_type<Arguments>, std::string>>(results))...};
+        return detail::merge_results<parse_result_type>(std::move(*std::get<expected<detail::get_parse_result_type<Arguments>, std::string>>(results))...);
     }
 
     template <SingleArgument ... Arguments>
-    std::string CompoundArgument<Arguments...>::to_string(int indentation) const
+    std::string CompoundArgument<Arguments...>::to_string(int indentation) const requires (HasDescription<Arguments> && ...)
     {
         return (this->template access_argument<Arguments>().to_string(indentation) + ...);
     }
@@ -446,7 +641,14 @@ namespace dodo
     // CompoundParser
 
     template <instantiation_of<CompoundArgument> Arguments, instantiation_of<CompoundOption> Options>
-    auto CompoundParser<Arguments, Options>::parse(ArgsView args) const noexcept -> expected<parse_result_type, std::string>
+    constexpr auto CompoundParser<Arguments, Options>::parse(ArgsView args) const noexcept -> expected<parse_result_type, std::string>
+    {
+        uint64_t given_options = 0;
+        return detail::resolving_deferred_checks<detail::may_defer_checks<CompoundParser>>([&] { return parse(args, given_options); });
+    }
+
+    template <instantiation_of<CompoundArgument> Arguments, instantiation_of<CompoundOption> Options>
+    constexpr auto CompoundParser<Arguments, Options>::parse(ArgsView args, uint64_t & given_options) const noexcept -> expected<parse_result_type, std::string>
     {
         auto const first_option = std::find_if(args.begin(), args.end(), [](std::string_view arg) { return arg[0] == '-'; });
         size_t const positional_arg_count = size_t(first_option - args.begin());
@@ -455,15 +657,15 @@ namespace dodo
         if (!parsed_args)
             return Error(std::move(parsed_args.error()));
 
-        auto opts = Options::parse(args.last(args.size() - positional_arg_count));
+        auto opts = Options::parse(args.last(args.size() - positional_arg_count), given_options);
         if (!opts)
             return Error(std::move(opts.error()));
 
-        return parse_result_type{std::move(*parsed_args), std::move(*opts)};
+        return detail::merge_parser_results<parse_result_type, Arguments>(std::move(*parsed_args), std::move(*opts));
     }
 
     template <instantiation_of<CompoundArgument> Arguments, instantiation_of<CompoundOption> Options>
-    std::string CompoundParser<Arguments, Options>::to_string(int indentation) const
+    std::string CompoundParser<Arguments, Options>::to_string(int indentation) const requires HasHelpText<Arguments> && HasHelpText<Options>
     {
         std::string out;
 
@@ -478,6 +680,27 @@ namespace dodo
         return out;
     }
 
+    template <instantiation_of<CompoundArgument> Arguments, instantiation_of<CompoundOption> Options>
+    template <std::convertible_to<std::string_view> ... Names>
+    constexpr auto CompoundParser<Arguments, Options>::exactly_one_of(Names ... names) const noexcept
+    {
+        return WithConstraints<CompoundParser, 0>(*this, {}).exactly_one_of(names...);
+    }
+
+    template <instantiation_of<CompoundArgument> Arguments, instantiation_of<CompoundOption> Options>
+    template <std::convertible_to<std::string_view> ... Names>
+    constexpr auto CompoundParser<Arguments, Options>::at_most_one_of(Names ... names) const noexcept
+    {
+        return WithConstraints<CompoundParser, 0>(*this, {}).at_most_one_of(names...);
+    }
+
+    template <instantiation_of<CompoundArgument> Arguments, instantiation_of<CompoundOption> Options>
+    template <std::convertible_to<std::string_view> ... Names>
+    constexpr auto CompoundParser<Arguments, Options>::depends_on(std::string_view option, Names ... dependencies) const noexcept
+    {
+        return WithConstraints<CompoundParser, 0>(*this, {}).depends_on(option, dependencies...);
+    }
+
     template <SingleArgument A, SingleOption B>
     constexpr CompoundParser<CompoundArgument<A>, CompoundOption<B>> operator | (A a, B b) noexcept
     {
@@ -520,14 +743,14 @@ namespace dodo
     constexpr auto operator | (CompoundParser<CompoundArgument<A...>, CompoundOption<PrevOpts...>> a, NewOpt b) noexcept
         -> CompoundParser<CompoundArgument<A...>, CompoundOption<PrevOpts..., NewOpt>>
     {
-        return CompoundParser<CompoundArgument<A...>, CompoundOption<PrevOpts..., NewOpt>>(a.access_arguments, a.access_options | b);
+        return CompoundParser<CompoundArgument<A...>, CompoundOption<PrevOpts..., NewOpt>>(a.access_arguments(), a.access_options() | b);
     }
 
     template <SingleArgument ... A, SingleOption ... PrevOpts, SingleOption ... NewOpts>
     constexpr auto operator | (CompoundParser<CompoundArgument<A...>, CompoundOption<PrevOpts...>> a, CompoundOption<NewOpts...> b) noexcept
         -> CompoundParser<CompoundArgument<A...>, CompoundOption<PrevOpts..., NewOpts...>>
     {
-        return CompoundParser<CompoundArgument<A...>, CompoundOption<PrevOpts..., NewOpts...>>(a.access_arguments, a.access_options | b);
+        return CompoundParser<CompoundArgument<A...>, CompoundOption<PrevOpts..., NewOpts...>>(a.access_arguments(), a.access_options() | b);
     }
 
     template <typename ... ArgsA, typename ... OptsA, typename ... ArgsB, typename ... OptsB>
@@ -540,16 +763,180 @@ namespace dodo
             );
     }
 
+    //*****************************************************************************************************************************************************
+    // WithConstraints
+
+    namespace detail
+    {
+        // Returns why the constraints can never be satisfied together, or nullptr if they can.
+        constexpr char const * find_constraint_contradiction(std::span<option_constraint const> constraints, uint64_t required_options, size_t option_count) noexcept
+        {
+            // Options that must be given if each option is given.
+            std::array<uint64_t, 64> implied = {};
+            for (size_t i = 0; i < option_count; ++i)
+                implied[i] = uint64_t(1) << i;
+
+            for (bool changed = true; changed; )
+            {
+                changed = false;
+                for (option_constraint const & constraint : constraints)
+                    if (constraint.kind == constraint_kind::depends_on)
+                        for (size_t i = 0; i < option_count; ++i)
+                            if ((implied[i] & constraint.options) && (implied[i] & constraint.dependencies) != constraint.dependencies)
+                            {
+                                implied[i] |= constraint.dependencies;
+                                changed = true;
+                            }
+            }
+
+            // Options without default value are always given, and so is everything they depend on. They only matter for exclusive groups,
+            // since a required option may depend on one that is not.
+            uint64_t always_given = 0;
+            for (size_t i = 0; i < option_count; ++i)
+                if ((required_options >> i) & 1)
+                    always_given |= implied[i];
+
+            for (option_constraint const & constraint : constraints)
+            {
+                if (constraint.kind == constraint_kind::depends_on)
+                {
+                    if (constraint.dependencies & constraint.options)
+                        return "An option can not depend on itself.";
+                    for (size_t i = 0; i < option_count; ++i)
+                        if (((constraint.dependencies >> i) & 1) && (implied[i] & constraint.options))
+                            return "Cycle in the dependencies between options.";
+                }
+                else
+                {
+                    if (std::popcount(constraint.options) < 2)
+                        return "A group of exclusive options needs at least two options.";
+                    for (size_t i = 0; i < option_count; ++i)
+                        if (std::popcount((implied[i] | always_given) & constraint.options) > 1)
+                            return "Contradictory constraints. An option can never be given without breaking a group of exclusive options.";
+                }
+            }
+
+            return nullptr;
+        }
+    } // namespace detail
+
+    template <ConstrainableParser P, size_t N>
+    constexpr auto WithConstraints<P, N>::parse(ArgsView args) const noexcept -> expected<typename P::parse_result_type, std::string>
+    {
+        uint64_t given_options = 0;
+        auto result = detail::resolving_deferred_checks<detail::may_defer_checks<P>>([&] { return P::parse(args, given_options); });
+        if (!result)
+            return result;
+
+        for (option_constraint const & constraint : constraints)
+            if (!constraint.holds(given_options))
+                return detail::make_error(constraint_text(constraint));
+
+        return result;
+    }
+
+    template <ConstrainableParser P, size_t N>
+    std::string WithConstraints<P, N>::to_string(int indentation) const requires HasHelpText<P>
+    {
+        std::string out = P::to_string(indentation);
+
+        for (option_constraint const & constraint : constraints)
+        {
+            out.append(instantiation_of<P, CompoundParser> ? indentation + 2 : indentation, ' ');
+            out += constraint_text(constraint);
+            out += '\n';
+        }
+
+        return out;
+    }
+
+    template <ConstrainableParser P, size_t N>
+    template <std::convertible_to<std::string_view> ... Names>
+    constexpr auto WithConstraints<P, N>::exactly_one_of(Names ... names) const noexcept -> WithConstraints<P, N + 1>
+    {
+        return add_constraint(option_constraint{constraint_kind::exactly_one_of, options_mask(names...), 0});
+    }
+
+    template <ConstrainableParser P, size_t N>
+    template <std::convertible_to<std::string_view> ... Names>
+    constexpr auto WithConstraints<P, N>::at_most_one_of(Names ... names) const noexcept -> WithConstraints<P, N + 1>
+    {
+        return add_constraint(option_constraint{constraint_kind::at_most_one_of, options_mask(names...), 0});
+    }
+
+    template <ConstrainableParser P, size_t N>
+    template <std::convertible_to<std::string_view> ... Names>
+    constexpr auto WithConstraints<P, N>::depends_on(std::string_view option, Names ... dependencies) const noexcept -> WithConstraints<P, N + 1>
+    {
+        static_assert(sizeof...(Names) > 0, "depends_on needs at least one dependency.");
+        return add_constraint(option_constraint{constraint_kind::depends_on, options_mask(option), options_mask(dependencies...)});
+    }
+
+    template <ConstrainableParser P, size_t N>
+    constexpr auto const & WithConstraints<P, N>::constrained_options() const noexcept
+    {
+        if constexpr (instantiation_of<P, CompoundParser>)
+            return this->access_options();
+        else
+            return static_cast<P const &>(*this);
+    }
+
+    template <ConstrainableParser P, size_t N>
+    template <typename ... Names>
+    constexpr uint64_t WithConstraints<P, N>::options_mask(Names ... names) const noexcept
+    {
+        return ((uint64_t(1) << constrained_options().option_index(names)) | ...);
+    }
+
+    template <ConstrainableParser P, size_t N>
+    constexpr auto WithConstraints<P, N>::add_constraint(option_constraint constraint) const noexcept -> WithConstraints<P, N + 1>
+    {
+        std::array<option_constraint, N + 1> new_constraints;
+        std::copy(constraints.begin(), constraints.end(), new_constraints.begin());
+        new_constraints[N] = constraint;
+
+        using Options = std::remove_cvref_t<decltype(constrained_options())>;
+        char const * const contradiction = detail::find_constraint_contradiction(new_constraints, Options::required_options(), Options::option_count);
+        if (contradiction)
+            detail::definition_error(contradiction);
+
+        return WithConstraints<P, N + 1>(static_cast<P const &>(*this), new_constraints);
+    }
+
+    template <ConstrainableParser P, size_t N>
+    constexpr std::string WithConstraints<P, N>::constraint_text(option_constraint const & constraint) const
+    {
+        std::string const options = constrained_options().option_names(constraint.options);
+        switch (constraint.kind)
+        {
+            case constraint_kind::exactly_one_of: return "Exactly one of the options " + options + " must be given";
+            case constraint_kind::at_most_one_of: return "At most one of the options " + options + " can be given";
+            default: return "Option " + options + " requires " + constrained_options().option_names(constraint.dependencies);
+        }
+    }
+
     //*****************************************************************************************************************************************************
     // CommandSelector
 
+    namespace detail
+    {
+        template <CommandType C>
+        constexpr std::string_view command_name(C const & command) noexcept
+        {
+            if constexpr (requires { command.name; })
+                return command.name;
+            else
+                return std::string_view();
+        }
+    } // namespace detail
+
     namespace detail
     {
         template <CommandType Next, CommandType ... Rest, CommandType ... Commands>
         constexpr auto parse_impl(CommandSelector<Commands...> const & commands, ArgsView args) noexcept
             -> expected<typename CommandSelector<Commands...>::parse_result_type, std::string>
         {
-            Next const & next = commands.access_command<Next>();
+            Next const & next = commands.template access_command<Next>();
             if (next.match(args[0]))
             {
                 auto result = next.parse_command(args);
@@ -569,7 +956,20 @@ namespace dodo
     }
 
     template <CommandType ... Commands>
-    auto CommandSelector<Commands...>::parse(ArgsView args) const noexcept -> expected<parse_result_type, std::string>
+    constexpr CommandSelector<Commands...>::CommandSelector(Commands... commands) noexcept : Commands(commands)...
+    {
+        if (((count_commands_named(detail::command_name(access_command<Commands>())) > 1) || ...))
+            detail::definition_error("Two commands have the same name.");
+    }
+
+    template <CommandType ... Commands>
+    constexpr size_t CommandSelector<Commands...>::count_commands_named(std::string_view name) const noexcept
+    {
+        return ((requires { access_command<Commands>().name; } && detail::command_name(access_command<Commands>()) == name) + ...);
+    }
+
+    template <CommandType ... Commands>
+    constexpr auto CommandSelector<Commands...>::parse(ArgsView args) const noexcept -> expected<parse_result_type, std::string>
     {
         if (args.size() <= 0)
             return detail::make_error("Expected command.");
@@ -630,7 +1030,32 @@ namespace dodo
     }
 
     template <Parser SharedOptions, instantiation_of<CommandSelector> Commands>
-    auto CommandWithSharedOptions<SharedOptions, Commands>::parse(ArgsView args) const noexcept
+    constexpr CommandWithSharedOptions<SharedOptions, Commands>::CommandWithSharedOptions(SharedOptions shared_options_, Commands commands_) noexcept
+        : shared_options(std::move(shared_options_))
+        , commands(std::move(commands_))
+    {
+        // Arguments are split at the first one that names a command, so a shared option or argument with the same name as a command would
+        // never be parsed.
+        auto const check_name = [this](std::string_view name)
+        {
+            if (commands.count_commands_named(name) > 0)
+                detail::definition_error("A shared option or argument has the same name as a command.");
+        };
+
+        detail::for_each_pattern(shared_options, check_name);
+        if constexpr (requires { shared_options.access_arguments(); })
+            shared_options.access_arguments().for_each_name(check_name);
+    }
+
+    template <Parser SharedOptions, instantiation_of<CommandSelector> Commands>
+    constexpr auto CommandWithSharedOptions<SharedOptions, Commands>::parse(ArgsView args) const noexcept
+        -> expected<parse_result_type, std::string>
+    {
+        return detail::resolving_deferred_checks<detail::may_defer_checks<CommandWithSharedOptions>>([&] { return parse_shared_options_and_command(args); });
+    }
+
+    template <Parser SharedOptions, instantiation_of<CommandSelector> Commands>
+    constexpr auto CommandWithSharedOptions<SharedOptions, Commands>::parse_shared_options_and_command(ArgsView args) const noexcept
         -> expected<parse_result_type, std::string>
     {
         auto const it = std::find_if(args.begin(), args.end(), [this](std::string_view arg) { return commands.match(arg); });
@@ -653,7 +1078,7 @@ namespace dodo
     }
 
     template <Parser SharedOptions, instantiation_of<CommandSelector> Commands>
-    std::string CommandWithSharedOptions<SharedOptions, Commands>::to_string(int indentation) const noexcept
+    std::string CommandWithSharedOptions<SharedOptions, Commands>::to_string(int indentation) const noexcept requires HasHelpText<SharedOptions>
     {
         std::string out;
         out.append(indentation, ' ');
@@ -680,7 +1105,7 @@ namespace dodo
     }
 
     template <instantiation_of<CommandSelector> Commands, Parser ImplicitCommand>
-    auto CommandWithImplicitCommand<Commands, ImplicitCommand>::parse(ArgsView args) const noexcept
+    constexpr auto CommandWithImplicitCommand<Commands, ImplicitCommand>::parse(ArgsView args) const noexcept
         -> expected<parse_result_type, std::string>
     {
         if (commands.match(args[0]))
@@ -702,7 +1127,7 @@ namespace dodo
     }
 
     template <instantiation_of<CommandSelector> Commands, Parser ImplicitCommand>
-    std::string CommandWithImplicitCommand<Commands, ImplicitCommand>::to_string(int indentation) const noexcept
+    std::string CommandWithImplicitCommand<Commands, ImplicitCommand>::to_string(int indentation) const noexcept requires HasHelpText<ImplicitCommand>
     {
         std::string out;
         out.append(indentation, ' ');
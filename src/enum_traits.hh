@@ -0,0 +1,384 @@
+#pragma once
+
+#include "parse_traits.hh"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <initializer_list>
+#include <span>
+#include <type_traits>
+
+namespace dodo
+{
+
+	template <typename E>
+	struct enum_entry
+	{
+		std::string_view name;
+		E value;
+	};
+
+	namespace detail
+	{
+		// FNV-1a. Computed once per name when building the table and once per parse.
+		constexpr uint64_t enum_name_hash(std::string_view text) noexcept
+		{
+			uint64_t hash = 0xcbf29ce484222325ull;
+			for (char const c : text)
+			{
+				hash ^= static_cast<unsigned char>(c);
+				hash *= 0x100000001b3ull;
+			}
+			return hash;
+		}
+
+		// Cheap remix of a name hash with the displacement chosen for its bucket, so that searching for displacements does not rehash the names.
+		constexpr uint64_t enum_slot_hash(uint64_t name_hash, uint64_t displacement) noexcept
+		{
+			uint64_t x = name_hash + displacement * 0x9e3779b97f4a7c15ull;
+			x ^= x >> 32;
+			x *= 0xd6e8feb86659fd93ull;
+			x ^= x >> 32;
+			return x;
+		}
+
+		// Taken from the high bits of the remix, so that the names of a bucket do not all start from the same low bits of their slot.
+		constexpr size_t enum_bucket(uint64_t name_hash, size_t bucket_count) noexcept
+		{
+			return static_cast<size_t>(enum_slot_hash(name_hash, 0) >> 32) & (bucket_count - 1);
+		}
+	} // namespace detail
+
+	// Table of names for the values of an enum. Built at compile time from a list of name-value pairs. Parsing is done through a perfect hash of
+	// the names, so it costs one hash of the text and one string comparison. Conversion to string looks up the value in an index sorted by value.
+	// More than one name may be given to the same value, in which case the first one is the one used for conversion to string.
+	//
+	// The perfect hash is built by hash and displace: names are split into buckets of about two, and each bucket gets the smallest displacement
+	// that puts its names in free slots, largest buckets first. Each bucket only tries a few displacements, so building the table takes time
+	// linear in the number of names and stays within the limits of constant evaluation for enums with thousands of values.
+	template <typename E, size_t N>
+	struct enum_table
+	{
+		static_assert(std::is_enum_v<E>, "enum_table can only be used with enum types.");
+		static_assert(N > 0, "enum_table must have at least one entry.");
+
+		using underlying_type = std::underlying_type_t<E>;
+		using index_type = std::conditional_t<(N < 255), uint8_t, uint16_t>;
+
+		static constexpr size_t slot_count = std::bit_ceil(N) * 4;
+		static constexpr size_t bucket_count = std::bit_ceil(N) / 2 + (N == 1);
+
+		constexpr explicit enum_table(enum_entry<E> const (&entries_)[N]) noexcept;
+
+		constexpr std::optional<E> parse(std::string_view text) const noexcept
+		{
+			uint64_t const hash = detail::enum_name_hash(text);
+			index_type const slot = slots[slot_of(hash, displacements[detail::enum_bucket(hash, bucket_count)])];
+			if (slot != 0 && entries[slot - 1].name == text)
+				return entries[slot - 1].value;
+			else
+				return std::nullopt;
+		}
+
+		// Position in the table of the first entry for the given value.
+		constexpr std::optional<size_t> index_of(E value) const noexcept
+		{
+			auto const v = static_cast<underlying_type>(value);
+
+			if (contiguous)
+			{
+				auto const first = static_cast<underlying_type>(entries[by_value[0]].value);
+				if (v < first || static_cast<size_t>(v - first) >= value_count)
+					return std::nullopt;
+				return by_value[static_cast<size_t>(v - first)];
+			}
+
+			size_t low = 0;
+			size_t high = value_count;
+			while (low < high)
+			{
+				size_t const mid = (low + high) / 2;
+				if (static_cast<underlying_type>(entries[by_value[mid]].value) < v)
+					low = mid + 1;
+				else
+					high = mid;
+			}
+
+			if (low < value_count && entries[by_value[low]].value == value)
+				return by_value[low];
+			else
+				return std::nullopt;
+		}
+
+		constexpr std::string_view name_of(E value) const noexcept
+		{
+			std::optional<size_t> const index = index_of(value);
+			return index ? entries[*index].name : std::string_view();
+		}
+
+		std::array<enum_entry<E>, N> entries = {};
+		std::array<std::string_view, N> names = {};
+		std::array<index_type, slot_count> slots = {};  // Index in entries + 1. 0 means empty.
+		std::array<uint16_t, bucket_count> displacements = {};
+		std::array<index_type, N> by_value = {};        // Indices in entries of the first name of each value, sorted by value.
+		size_t value_count = 0;                         // Number of distinct values. Only the first value_count elements of by_value are used.
+		bool contiguous = false;
+
+	private:
+		static constexpr size_t slot_of(uint64_t name_hash, uint64_t displacement) noexcept
+		{
+			return detail::enum_slot_hash(name_hash, displacement) & (slot_count - 1);
+		}
+	};
+
+	template <typename E, size_t N>
+	constexpr enum_table<E, N>::enum_table(enum_entry<E> const (&entries_)[N]) noexcept
+	{
+		std::array<uint64_t, N> hashes = {};
+
+		for (size_t i = 0; i < N; ++i)
+		{
+			entries[i] = entries_[i];
+			names[i] = entries_[i].name;
+			hashes[i] = detail::enum_name_hash(entries_[i].name);
+		}
+
+		// Sort the names by bucket, keeping where each bucket starts.
+		std::array<size_t, bucket_count + 1> bucket_begin = {};
+		for (size_t i = 0; i < N; ++i)
+			++bucket_begin[detail::enum_bucket(hashes[i], bucket_count) + 1];
+		size_t largest_bucket = 0;
+		for (size_t bucket = 0; bucket < bucket_count; ++bucket)
+		{
+			largest_bucket = std::max(largest_bucket, bucket_begin[bucket + 1]);
+			bucket_begin[bucket + 1] += bucket_begin[bucket];
+		}
+		std::array<size_t, N> by_bucket = {};
+		std::array<size_t, bucket_count> bucket_filled = {};
+		for (size_t i = 0; i < N; ++i)
+		{
+			size_t const bucket = detail::enum_bucket(hashes[i], bucket_count);
+			by_bucket[bucket_begin[bucket] + bucket_filled[bucket]++] = i;
+		}
+
+		// Largest buckets first, while most slots are free.
+		constexpr uint64_t max_displacement = uint64_t(1) << 16;
+		for (size_t size = largest_bucket; size > 0; --size)
+		{
+			for (size_t bucket = 0; bucket < bucket_count; ++bucket)
+			{
+				if (bucket_begin[bucket + 1] - bucket_begin[bucket] != size)
+					continue;
+
+				// Equal names always fall in the same bucket, so duplicates are found without comparing every pair of names.
+				std::span<size_t const> const names_in_bucket(by_bucket.data() + bucket_begin[bucket], size);
+				for (size_t i = 0; i < size; ++i)
+					for (size_t j = 0; j < i; ++j)
+						if (entries[names_in_bucket[i]].name == entries[names_in_bucket[j]].name)
+							detail::definition_error("Duplicate name in enum table.");
+				for (uint64_t candidate = 0; ; ++candidate)
+				{
+					if (candidate == max_displacement)
+					{
+						detail::definition_error("Could not find a perfect hash for the enum table.");
+						break;
+					}
+
+					size_t placed = 0;
+					while (placed < size && slots[slot_of(hashes[names_in_bucket[placed]], candidate)] == 0)
+					{
+						slots[slot_of(hashes[names_in_bucket[placed]], candidate)] = static_cast<index_type>(names_in_bucket[placed] + 1);
+						++placed;
+					}
+
+					if (placed == size)
+					{
+						displacements[bucket] = static_cast<uint16_t>(candidate);
+						break;
+					}
+
+					for (size_t i = 0; i < placed; ++i)
+						slots[slot_of(hashes[names_in_bucket[i]], candidate)] = 0;
+				}
+			}
+		}
+
+		// Stable insertion sort, so that the first name given to a value is found first.
+		for (size_t i = 0; i < N; ++i)
+		{
+			size_t j = i;
+			while (j > 0 && static_cast<underlying_type>(entries[by_value[j - 1]].value) > static_cast<underlying_type>(entries[i].value))
+			{
+				by_value[j] = by_value[j - 1];
+				--j;
+			}
+			by_value[j] = static_cast<index_type>(i);
+		}
+
+		// Remove aliases, keeping the first name of each value.
+		for (size_t i = 0; i < N; ++i)
+			if (value_count == 0 || entries[by_value[value_count - 1]].value != entries[by_value[i]].value)
+				by_value[value_count++] = by_value[i];
+
+		contiguous = true;
+		for (size_t i = 1; i < value_count; ++i)
+			if (static_cast<underlying_type>(entries[by_value[i]].value) != static_cast<underlying_type>(entries[by_value[0]].value) + static_cast<underlying_type>(i))
+				contiguous = false;
+	}
+
+	template <typename E, size_t N>
+	constexpr enum_table<E, N> enum_traits(enum_entry<E> const (&entries)[N]) noexcept
+	{
+		return enum_table<E, N>(entries);
+	}
+
+	// Parse traits generated from an enum_table. The table must be a constexpr variable.
+	//
+	// constexpr auto platform_names = dodo::enum_traits<Platform>({{"windows", Platform::windows}, {"linux", Platform::linux}});
+	// template <> struct dodo::parse_traits<Platform> : dodo::enum_parse_traits<platform_names> {};
+	template <auto const & Table>
+	struct enum_parse_traits
+	{
+		using value_type = decltype(Table.entries[0].value);
+
+		static constexpr std::optional<value_type> parse(std::string_view text) noexcept
+		{
+			return Table.parse(text);
+		}
+
+		static std::string to_string(value_type value)
+		{
+			std::string_view const name = Table.name_of(value);
+			if (name.empty())
+				return std::to_string(static_cast<std::underlying_type_t<value_type>>(value));
+			else
+				return std::string(name);
+		}
+
+		static constexpr std::span<std::string_view const> value_names() noexcept
+		{
+			return Table.names;
+		}
+
+		static constexpr auto const & table = Table;
+	};
+
+	template <typename E>
+	concept TableEnum = std::is_enum_v<E> && requires(E e) { {parse_traits<E>::table.index_of(e)} -> std::same_as<std::optional<size_t>>; };
+
+	namespace detail
+	{
+		template <size_t N>
+		using flags_mask_type =
+			std::conditional_t<(N <= 8), uint8_t,
+			std::conditional_t<(N <= 16), uint16_t,
+			std::conditional_t<(N <= 32), uint32_t,
+			uint64_t>>>;
+	} // namespace detail
+
+	// Set of values of an enum with parse traits generated from an enum_table, stored as a bit mask. Each value is assigned the bit of its
+	// position in the table, so the enum may have any underlying values. Parses from and prints to names separated by '|', as in "read|write".
+	template <TableEnum E>
+	struct flags
+	{
+		static constexpr auto const & table = parse_traits<E>::table;
+		static_assert(table.entries.size() <= 64, "flags can only be used with enums with up to 64 names.");
+
+		using mask_type = detail::flags_mask_type<table.entries.size()>;
+
+		constexpr flags() noexcept = default;
+		constexpr flags(std::initializer_list<E> values) noexcept
+		{
+			for (E const value : values)
+				insert(value);
+		}
+
+		static constexpr mask_type bit(E value) noexcept
+		{
+			std::optional<size_t> const index = table.index_of(value);
+			assert(index.has_value());
+			return index ? static_cast<mask_type>(mask_type(1) << *index) : mask_type(0);
+		}
+
+		constexpr bool contains(E value) const noexcept { return (mask & bit(value)) != 0; }
+		constexpr bool empty() const noexcept { return mask == 0; }
+		constexpr int size() const noexcept { return std::popcount(mask); }
+
+		constexpr flags & insert(E value) noexcept { mask |= bit(value); return *this; }
+		constexpr flags & erase(E value) noexcept { mask &= static_cast<mask_type>(~bit(value)); return *this; }
+
+		constexpr flags operator | (flags other) const noexcept { return from_mask(mask | other.mask); }
+		constexpr flags operator & (flags other) const noexcept { return from_mask(mask & other.mask); }
+		constexpr bool operator == (flags const & other) const noexcept = default;
+
+		static constexpr flags from_mask(mask_type mask) noexcept
+		{
+			flags result;
+			result.mask = mask;
+			return result;
+		}
+
+		mask_type mask = 0;
+	};
+
+	template <TableEnum E>
+	struct parse_traits<flags<E>>
+	{
+		static constexpr std::optional<flags<E>> parse(std::string_view text) noexcept
+		{
+			using mask_type = typename flags<E>::mask_type;
+
+			mask_type mask = 0;
+			if (text.empty())
+				return flags<E>::from_mask(mask);
+
+			size_t index = 0;
+			while (index <= text.size())
+			{
+				size_t end = text.find('|', index);
+				if (end == std::string_view::npos)
+					end = text.size();
+
+				std::optional<E> const value = flags<E>::table.parse(text.substr(index, end - index));
+				if (!value)
+					return std::nullopt;
+
+				mask_type const bit = flags<E>::bit(*value);
+				if (mask & bit) // Repeated value.
+					return std::nullopt;
+				mask |= bit;
+
+				index = end + 1;
+			}
+
+			return flags<E>::from_mask(mask);
+		}
+
+		static std::string to_string(flags<E> f)
+		{
+			std::string result;
+
+			for (size_t i = 0; i < flags<E>::table.entries.size(); ++i)
+			{
+				if (f.mask & (uint64_t(1) << i))
+				{
+					result += flags<E>::table.entries[i].name;
+					result += '|';
+				}
+			}
+
+			// Remove last separator.
+			if (!result.empty())
+				result.pop_back();
+
+			return result;
+		}
+
+		static constexpr std::span<std::string_view const> value_names() noexcept
+		{
+			return parse_traits<E>::value_names();
+		}
+	};
+
+} // namespace dodo
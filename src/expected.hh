@@ -9,8 +9,8 @@ namespace dodo
 	template <typename T>
 	struct Error
 	{
-		Error(T const & v) : value(v) {}
-		Error(T && v) noexcept : value(std::move(v)) {}
+		constexpr Error(T const & v) : value(v) {}
+		constexpr Error(T && v) noexcept : value(std::move(v)) {}
 
 		T value;
 	};
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+
+namespace dodo
+{
+
+	// String that can be used as a template parameter, as in dodo::matches<"[a-z]+">.
+	template <size_t N>
+	struct fixed_string
+	{
+		constexpr fixed_string(char const (&text)[N]) noexcept
+		{
+			for (size_t i = 0; i < N; ++i)
+				data[i] = text[i];
+		}
+
+		constexpr std::string_view view() const noexcept { return std::string_view(data, N - 1); }
+		constexpr size_t size() const noexcept { return N - 1; }
+
+		char data[N] = {};
+	};
+
+} // namespace dodo
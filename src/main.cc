@@ -1,8 +1,24 @@
 #define CATCH_CONFIG_RUNNER
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
 #include "catch2/catch.hpp"
 
 #include "dodo.hh"
+#include "realtime.hh"
+#include "compact.hh"
+#include "any_parser.hh"
+#include "reload.hh"
+#include "diff.hh"
+#include "shared_config.hh"
+#include "binary_args.hh"
+#include "daemon.hh"
+#include "path_traits.hh"
 #include <typeinfo>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <cstdlib>
+#include <new>
+#include <regex>
 
 using namespace std::literals;
 
@@ -14,6 +30,28 @@ namespace tests
         return parser.parse(std::span<std::string_view const>(args));
     }
 
+    // Parses each list of arguments with both parsers and checks that they both succeed, with values that same_values considers the same,
+    // or both fail with the same error.
+    template <dodo::Parser P, dodo::Parser Q, typename SameValues>
+    void check_same_results(P const & p, Q const & q, std::initializer_list<std::initializer_list<std::string_view>> arg_lists, SameValues same_values)
+    {
+        for (auto const args : arg_lists)
+        {
+            std::string command_line;
+            for (std::string_view const arg : args)
+                command_line.append(arg).push_back(' ');
+            INFO(command_line);
+
+            auto const from_p = p.parse(std::span<std::string_view const>(args));
+            auto const from_q = q.parse(std::span<std::string_view const>(args));
+            REQUIRE(from_p.has_value() == from_q.has_value());
+            if (from_p)
+                CHECK(same_values(*from_p, *from_q));
+            else
+                CHECK(from_p.error() == from_q.error());
+        }
+    }
+
     template <typename T>
     bool are_equal(std::vector<T> const & v, std::initializer_list<T> ilist) noexcept
     {
@@ -56,10 +94,10 @@ TEST_CASE("Single argument CLI")
 
     SECTION("Found")
     {
-        auto const options = tests::parse(cli, {"-w=1920"});
+        constexpr auto options = tests::parse(cli, {"-w=1920"});
 
-        REQUIRE(options.has_value());
-        REQUIRE(options->width == 1920);
+        STATIC_REQUIRE(options.has_value());
+        STATIC_REQUIRE(options->width == 1920);
     }
     SECTION("Not found")
     {
@@ -75,10 +113,10 @@ TEST_CASE("Single argument CLI")
     }
     SECTION("Correctly parsing a negative integer")
     {
-        auto const options = tests::parse(cli, { "-w=-100" });
+        constexpr auto options = tests::parse(cli, { "-w=-100" });
 
-        REQUIRE(options.has_value());
-        REQUIRE(options->width == -100);
+        STATIC_REQUIRE(options.has_value());
+        STATIC_REQUIRE(options->width == -100);
     }
 }
 
@@ -91,17 +129,17 @@ TEST_CASE("Multiple patterns for an option")
 
     SECTION("Found -w")
     {
-        auto const options = tests::parse(cli, {"-w=10"});
+        constexpr auto options = tests::parse(cli, {"-w=10"});
 
-        REQUIRE(options.has_value());
-        REQUIRE(options->width == 10);
+        STATIC_REQUIRE(options.has_value());
+        STATIC_REQUIRE(options->width == 10);
     }
     SECTION("Found --width")
     {
-        auto const options = tests::parse(cli, { "--width=-56" });
+        constexpr auto options = tests::parse(cli, { "--width=-56" });
 
-        REQUIRE(options.has_value());
-        REQUIRE(options->width == -56);
+        STATIC_REQUIRE(options.has_value());
+        STATIC_REQUIRE(options->width == -56);
     }
     SECTION("Not found")
     {
@@ -121,10 +159,10 @@ TEST_CASE("Default value for a pattern")
 
     SECTION("Found")
     {
-        auto const options = tests::parse(cli, {"-w=10"});
+        constexpr auto options = tests::parse(cli, {"-w=10"});
 
-        REQUIRE(options.has_value());
-        REQUIRE(options->width == 10);
+        STATIC_REQUIRE(options.has_value());
+        STATIC_REQUIRE(options->width == 10);
     }
     SECTION("Not found")
     {
@@ -145,10 +183,10 @@ TEST_CASE("Checks on a pattern that can make it fail even when found")
 
     SECTION("Found")
     {
-        auto const options = tests::parse(cli, {"-w=10"});
+        constexpr auto options = tests::parse(cli, {"-w=10"});
 
-        REQUIRE(options.has_value());
-        REQUIRE(options->width == 10);
+        STATIC_REQUIRE(options.has_value());
+        STATIC_REQUIRE(options->width == 10);
     }
     SECTION("Not found")
     {
@@ -175,10 +213,10 @@ TEST_CASE("Multiple checks")
 
     SECTION("Found")
     {
-        auto const options = tests::parse(cli, {"-w=10"});
+        constexpr auto options = tests::parse(cli, {"-w=10"});
 
-        REQUIRE(options.has_value());
-        REQUIRE(options->width == 10);
+        STATIC_REQUIRE(options.has_value());
+        STATIC_REQUIRE(options->width == 10);
     }
     SECTION("Negative")
     {
@@ -206,27 +244,27 @@ TEST_CASE("Combining two options in a compound parser")
 
     SECTION("Both found with short name")
     {
-        auto const options = tests::parse(cli, {"-w=30", "-h=20"});
+        constexpr auto options = tests::parse(cli, {"-w=30", "-h=20"});
 
-        REQUIRE(options.has_value());
-        REQUIRE(options->width == 30);
-        REQUIRE(options->height == 20);
+        STATIC_REQUIRE(options.has_value());
+        STATIC_REQUIRE(options->width == 30);
+        STATIC_REQUIRE(options->height == 20);
     }
     SECTION("Both found with long name")
     {
-        auto const options = tests::parse(cli, { "--width=30", "--height=20" });
+        constexpr auto options = tests::parse(cli, { "--width=30", "--height=20" });
 
-        REQUIRE(options.has_value());
-        REQUIRE(options->width == 30);
-        REQUIRE(options->height == 20);
+        STATIC_REQUIRE(options.has_value());
+        STATIC_REQUIRE(options->width == 30);
+        STATIC_REQUIRE(options->height == 20);
     }
     SECTION("One long one short")
     {
-        auto const options = tests::parse(cli, {"--width=30", "-h=20"});
+        constexpr auto options = tests::parse(cli, {"--width=30", "-h=20"});
 
-        REQUIRE(options.has_value());
-        REQUIRE(options->width == 30);
-        REQUIRE(options->height == 20);
+        STATIC_REQUIRE(options.has_value());
+        STATIC_REQUIRE(options->width == 30);
+        STATIC_REQUIRE(options->height == 20);
     }
     SECTION("Width missing")
     {
@@ -264,21 +302,21 @@ TEST_CASE("Combining three options in a compound parser where one is defaulted")
 
     SECTION("Fullscreen missing")
     {
-        auto const options = tests::parse(cli, {"-w=30", "-h=20"});
+        constexpr auto options = tests::parse(cli, {"-w=30", "-h=20"});
 
-        REQUIRE(options.has_value());
-        REQUIRE(options->width == 30);
-        REQUIRE(options->height == 20);
-        REQUIRE(options->fullscreen == false);
+        STATIC_REQUIRE(options.has_value());
+        STATIC_REQUIRE(options->width == 30);
+        STATIC_REQUIRE(options->height == 20);
+        STATIC_REQUIRE(options->fullscreen == false);
     }
     SECTION("All found")
     {
-        auto const options = tests::parse(cli, {"-w=30", "-h=20", "--fullscreen=true"});
+        constexpr auto options = tests::parse(cli, {"-w=30", "-h=20", "--fullscreen=true"});
 
-        REQUIRE(options.has_value());
-        REQUIRE(options->width == 30);
-        REQUIRE(options->height == 20);
-        REQUIRE(options->fullscreen == true);
+        STATIC_REQUIRE(options.has_value());
+        STATIC_REQUIRE(options->width == 30);
+        STATIC_REQUIRE(options->height == 20);
+        STATIC_REQUIRE(options->fullscreen == true);
     }
     SECTION("Width missing")
     {
@@ -368,31 +406,31 @@ TEST_CASE("Implicit value allows for setting a value implicitly to an option if
 
     SECTION("Not found. Default, so false")
     {
-        auto const options = tests::parse(cli, {});
+        constexpr auto options = tests::parse(cli, {});
 
-        REQUIRE(options.has_value());
-        REQUIRE(options->some_flag == false);
+        STATIC_REQUIRE(options.has_value());
+        STATIC_REQUIRE(options->some_flag == false);
     }
     SECTION("Mentioned but no value assigned. Implicit value, so true")
     {
-        auto const options = tests::parse(cli, {"--flag"});
+        constexpr auto options = tests::parse(cli, {"--flag"});
 
-        REQUIRE(options.has_value());
-        REQUIRE(options->some_flag == true);
+        STATIC_REQUIRE(options.has_value());
+        STATIC_REQUIRE(options->some_flag == true);
     }
     SECTION("Explicitly true")
     {
-        auto const options = tests::parse(cli, {"--flag=true"});
+        constexpr auto options = tests::parse(cli, {"--flag=true"});
 
-        REQUIRE(options.has_value());
-        REQUIRE(options->some_flag == true);
+        STATIC_REQUIRE(options.has_value());
+        STATIC_REQUIRE(options->some_flag == true);
     }
     SECTION("Explicitly false")
     {
-        auto const options = tests::parse(cli, {"--flag=false"});
+        constexpr auto options = tests::parse(cli, {"--flag=false"});
 
-        REQUIRE(options.has_value());
-        REQUIRE(options->some_flag == false);
+        STATIC_REQUIRE(options.has_value());
+        STATIC_REQUIRE(options->some_flag == false);
     }
     SECTION("Fail to parse")
     {
@@ -494,31 +532,31 @@ TEST_CASE("A flag is a boolean option that is by default false and implicitly tr
 
     SECTION("Not found. Default, so false")
     {
-        auto const options = tests::parse(cli, {});
+        constexpr auto options = tests::parse(cli, {});
 
-        REQUIRE(options.has_value());
-        REQUIRE(options->some_flag == false);
+        STATIC_REQUIRE(options.has_value());
+        STATIC_REQUIRE(options->some_flag == false);
     }
     SECTION("Mentioned but no value assigned. Implicit value, so true")
     {
-        auto const options = tests::parse(cli, { "--flag" });
+        constexpr auto options = tests::parse(cli, { "--flag" });
 
-        REQUIRE(options.has_value());
-        REQUIRE(options->some_flag == true);
+        STATIC_REQUIRE(options.has_value());
+        STATIC_REQUIRE(options->some_flag == true);
     }
     SECTION("Explicitly true")
     {
-        auto const options = tests::parse(cli, { "--flag=true" });
+        constexpr auto options = tests::parse(cli, { "--flag=true" });
 
-        REQUIRE(options.has_value());
-        REQUIRE(options->some_flag == true);
+        STATIC_REQUIRE(options.has_value());
+        STATIC_REQUIRE(options->some_flag == true);
     }
     SECTION("Explicitly false")
     {
-        auto const options = tests::parse(cli, { "--flag=false" });
+        constexpr auto options = tests::parse(cli, { "--flag=false" });
 
-        REQUIRE(options.has_value());
-        REQUIRE(options->some_flag == false);
+        STATIC_REQUIRE(options.has_value());
+        STATIC_REQUIRE(options->some_flag == false);
     }
     SECTION("Fail to parse")
     {
@@ -545,17 +583,17 @@ TEST_CASE("A custom parser may be given to an option")
 
     SECTION("on -> true")
     {
-        auto const options = tests::parse(cli, {"--flag=on"});
+        constexpr auto options = tests::parse(cli, {"--flag=on"});
 
-        REQUIRE(options.has_value());
-        REQUIRE(options->some_flag == true);
+        STATIC_REQUIRE(options.has_value());
+        STATIC_REQUIRE(options->some_flag == true);
     }
     SECTION("off -> false")
     {
-        auto const options = tests::parse(cli, {"--flag=off"});
+        constexpr auto options = tests::parse(cli, {"--flag=off"});
 
-        REQUIRE(options.has_value());
-        REQUIRE(options->some_flag == false);
+        STATIC_REQUIRE(options.has_value());
+        STATIC_REQUIRE(options->some_flag == false);
     }
     SECTION("Fail to parse. Default parser is not used so true is not a valid parser for bool anymore.")
     {
@@ -918,10 +956,10 @@ TEST_CASE("Single positional argument cli")
 
     SECTION("Found")
     {
-        auto const options = tests::parse(cli, {"1920"});
+        constexpr auto options = tests::parse(cli, {"1920"});
 
-        REQUIRE(options.has_value());
-        REQUIRE(options->width == 1920);
+        STATIC_REQUIRE(options.has_value());
+        STATIC_REQUIRE(options->width == 1920);
     }
     SECTION("Not found")
     {
@@ -945,11 +983,11 @@ TEST_CASE("Positional arguments must be provided in order")
 
     SECTION("In order")
     {
-        auto const options = tests::parse(cli, {"1920", "Foobar"});
+        constexpr auto options = tests::parse(cli, {"1920", "Foobar"});
 
-        REQUIRE(options.has_value());
-        REQUIRE(options->width == 1920);
-        REQUIRE(options->username == "Foobar");
+        STATIC_REQUIRE(options.has_value());
+        STATIC_REQUIRE(options->width == 1920);
+        STATIC_REQUIRE(options->username == "Foobar");
     }
     SECTION("Out of order")
     {
@@ -973,19 +1011,19 @@ TEST_CASE("A positional argument and a flag")
 
     SECTION("Only argument")
     {
-        auto const options = tests::parse(cli, {"1920"});
+        constexpr auto options = tests::parse(cli, {"1920"});
 
-        REQUIRE(options.has_value());
-        REQUIRE(options->width == 1920);
-        REQUIRE(options->fullscreen == false);
+        STATIC_REQUIRE(options.has_value());
+        STATIC_REQUIRE(options->width == 1920);
+        STATIC_REQUIRE(options->fullscreen == false);
     }
     SECTION("Both")
     {
-        auto const options = tests::parse(cli, {"1920", "--fullscreen"});
+        constexpr auto options = tests::parse(cli, {"1920", "--fullscreen"});
 
-        REQUIRE(options.has_value());
-        REQUIRE(options->width == 1920);
-        REQUIRE(options->fullscreen == true);
+        STATIC_REQUIRE(options.has_value());
+        STATIC_REQUIRE(options->width == 1920);
+        STATIC_REQUIRE(options->fullscreen == true);
     }
     SECTION("Argument missing")
     {
@@ -1034,3 +1072,2357 @@ TEST_CASE("Converting a command line in a single string into separate arguments,
     CHECK(dodo::Args::from_command_line_skip_program_name("foo --bar=\"'3 4 5 6'\"") == v{"--bar='3 4 5 6'"sv});
     CHECK(dodo::Args::from_command_line_skip_program_name("  foo \n  bar   baz  \t  quux") == v{"bar"sv, "baz"sv, "quux"sv});
 }
+
+namespace tests
+{
+    enum struct Platform { windows, linux, server, ps4, xboxone, nintendo_switch };
+
+    constexpr auto platform_names = dodo::enum_traits<Platform>({
+        {"windows", Platform::windows},
+        {"linux", Platform::linux},
+        {"server", Platform::server},
+        {"ps4", Platform::ps4},
+        {"xboxone", Platform::xboxone},
+        {"switch", Platform::nintendo_switch},
+        {"win", Platform::windows},
+    });
+}
+
+template <> struct dodo::parse_traits<tests::Platform> : dodo::enum_parse_traits<tests::platform_names> {};
+
+TEST_CASE("Parse traits for enums can be generated from a table of names")
+{
+    using tests::Platform;
+
+    STATIC_REQUIRE(dodo::parse_traits<Platform>::parse("linux") == Platform::linux);
+    STATIC_REQUIRE(dodo::parse_traits<Platform>::parse("switch") == Platform::nintendo_switch);
+    STATIC_REQUIRE(dodo::parse_traits<Platform>::parse("win") == Platform::windows);
+    STATIC_REQUIRE(!dodo::parse_traits<Platform>::parse("lin").has_value());
+    STATIC_REQUIRE(!dodo::parse_traits<Platform>::parse("").has_value());
+
+    // The first name given to a value is the one used for conversion to string.
+    CHECK(dodo::to_string(Platform::windows) == "windows");
+    CHECK(dodo::to_string(Platform::nintendo_switch) == "switch");
+    CHECK(dodo::to_string(static_cast<Platform>(42)) == "42");
+
+    constexpr auto cli =
+        dodo_Opt(Platform, platform)["--platform"]
+            ("Platform to run on.")
+            .by_default(Platform::windows)
+        | dodo_Opt(std::vector<Platform>, targets)["--targets"]
+            ("Platforms for which to build.")
+            .by_default_range(Platform::ps4);
+
+    SECTION("Parse correctly")
+    {
+        auto const options = tests::parse(cli, {"--platform=linux", "--targets=xboxone switch"});
+
+        REQUIRE(options.has_value());
+        REQUIRE(options->platform == Platform::linux);
+        REQUIRE(tests::are_equal(options->targets, {Platform::xboxone, Platform::nintendo_switch}));
+    }
+    SECTION("Unknown name")
+    {
+        auto const options = tests::parse(cli, {"--platform=amiga"});
+
+        REQUIRE(!options.has_value());
+    }
+    SECTION("The possible values are listed in the help text")
+    {
+        constexpr auto expected =
+            "--platform <Platform>                   Platform to run on.\n"
+            "                                        Possible values: windows, linux, server, ps4, xboxone, switch, win\n"
+            "                                        By default: windows\n"
+            "--targets <std::vector<Platform>>       Platforms for which to build.\n"
+            "                                        Possible values: windows, linux, server, ps4, xboxone, switch, win\n"
+            "                                        By default: ps4\n"
+            ;
+
+        REQUIRE(cli.to_string() == expected);
+    }
+}
+
+namespace tests
+{
+    // Enough names that searching for a single seed for all of them would exceed the limits of constant evaluation.
+    enum struct Opcode : uint16_t {};
+    constexpr size_t opcode_count = 1000;
+
+    constexpr auto opcode_text = []()
+    {
+        std::array<char, opcode_count * 5> text = {};
+        for (size_t i = 0; i < opcode_count; ++i)
+        {
+            text[i * 5] = 'o';
+            for (size_t digit = 0, rest = i; digit < 4; ++digit, rest /= 10)
+                text[i * 5 + 4 - digit] = static_cast<char>('0' + rest % 10);
+        }
+        return text;
+    }();
+
+    struct OpcodeEntries
+    {
+        dodo::enum_entry<Opcode> entries[opcode_count];
+    };
+
+    constexpr OpcodeEntries opcode_entries = []()
+    {
+        OpcodeEntries result = {};
+        for (size_t i = 0; i < opcode_count; ++i)
+            result.entries[i] = {std::string_view(opcode_text.data() + i * 5, 5), static_cast<Opcode>(i)};
+        return result;
+    }();
+
+    constexpr auto opcode_names = dodo::enum_traits<Opcode>(opcode_entries.entries);
+}
+
+TEST_CASE("Tables of names for large enums are built at compile time")
+{
+    using tests::Opcode;
+
+    STATIC_REQUIRE(tests::opcode_names.parse("o0000") == Opcode{0});
+    STATIC_REQUIRE(tests::opcode_names.parse("o0123") == Opcode{123});
+    STATIC_REQUIRE(tests::opcode_names.parse("o0999") == Opcode{999});
+    STATIC_REQUIRE(!tests::opcode_names.parse("o1000").has_value());
+    STATIC_REQUIRE(!tests::opcode_names.parse("o123").has_value());
+    STATIC_REQUIRE(tests::opcode_names.name_of(Opcode{42}) == "o0042");
+
+    size_t found = 0;
+    for (dodo::enum_entry<Opcode> const & entry : tests::opcode_entries.entries)
+        found += tests::opcode_names.parse(entry.name) == entry.value;
+    CHECK(found == tests::opcode_count);
+}
+
+namespace tests
+{
+    enum struct Permission { read = 4, write = 2, exec = 1 };
+
+    constexpr auto permission_names = dodo::enum_traits<Permission>({
+        {"read", Permission::read},
+        {"write", Permission::write},
+        {"exec", Permission::exec},
+    });
+}
+
+template <> struct dodo::parse_traits<tests::Permission> : dodo::enum_parse_traits<tests::permission_names> {};
+
+TEST_CASE("Sets of enum flags are parsed into a bit mask")
+{
+    using tests::Permission;
+    using Permissions = dodo::flags<Permission>;
+
+    STATIC_REQUIRE(sizeof(Permissions) == 1);
+    STATIC_REQUIRE(dodo::parse_traits<Permissions>::parse("read|exec") == Permissions{Permission::read, Permission::exec});
+    STATIC_REQUIRE(dodo::parse_traits<Permissions>::parse("") == Permissions{});
+    STATIC_REQUIRE(!dodo::parse_traits<Permissions>::parse("read|read").has_value());
+    STATIC_REQUIRE(!dodo::parse_traits<Permissions>::parse("read||exec").has_value());
+    STATIC_REQUIRE(!dodo::parse_traits<Permissions>::parse("read|").has_value());
+    STATIC_REQUIRE(!dodo::parse_traits<Permissions>::parse("read|delete").has_value());
+
+    // Printed in the order of the table, regardless of the order in which they were given.
+    CHECK(dodo::to_string(*dodo::parse_traits<Permissions>::parse("exec|write|read")) == "read|write|exec");
+    CHECK(dodo::to_string(Permissions{}) == "");
+
+    constexpr auto cli =
+        dodo_Opt(Permissions, permissions)["--permissions"]
+            ("Permissions of the new file.")
+            .by_default(Permissions{Permission::read});
+
+    SECTION("Parse correctly")
+    {
+        auto const options = tests::parse(cli, {"--permissions=write|exec"});
+
+        REQUIRE(options.has_value());
+        REQUIRE(options->permissions.contains(Permission::write));
+        REQUIRE(options->permissions.contains(Permission::exec));
+        REQUIRE(!options->permissions.contains(Permission::read));
+        REQUIRE(options->permissions.size() == 2);
+    }
+    SECTION("Default")
+    {
+        constexpr auto options = tests::parse(cli, {});
+
+        STATIC_REQUIRE(options.has_value());
+        STATIC_REQUIRE(options->permissions == Permissions{Permission::read});
+    }
+    SECTION("Help text")
+    {
+        constexpr auto expected =
+            "--permissions <Permissions>             Permissions of the new file.\n"
+            "                                        Possible values: read, write, exec\n"
+            "                                        By default: read\n"
+            ;
+
+        REQUIRE(cli.to_string() == expected);
+    }
+}
+
+TEST_CASE("Byte sizes are parsed with SI and IEC units")
+{
+    using traits = dodo::parse_traits<dodo::byte_size>;
+
+    STATIC_REQUIRE(traits::parse("0") == dodo::byte_size{0});
+    STATIC_REQUIRE(traits::parse("512B") == dodo::byte_size{512});
+    STATIC_REQUIRE(traits::parse("64K") == dodo::byte_size{64'000});
+    STATIC_REQUIRE(traits::parse("64kB") == dodo::byte_size{64'000});
+    STATIC_REQUIRE(traits::parse("64Ki") == dodo::byte_size{65'536});
+    STATIC_REQUIRE(traits::parse("64KiB") == dodo::byte_size{65'536});
+    STATIC_REQUIRE(traits::parse("1.5GiB") == dodo::byte_size{1'610'612'736});
+    STATIC_REQUIRE(traits::parse("16EiB") == std::nullopt); // Overflow
+    STATIC_REQUIRE(traits::parse("18446744073709551615") == dodo::byte_size{18'446'744'073'709'551'615u});
+    STATIC_REQUIRE(traits::parse("18446744073709551616") == std::nullopt); // Overflow
+    STATIC_REQUIRE(traits::parse("1.5B") == std::nullopt); // Not a whole number of bytes
+    STATIC_REQUIRE(traits::parse("1.") == std::nullopt);
+    STATIC_REQUIRE(traits::parse(".5K") == std::nullopt);
+    STATIC_REQUIRE(traits::parse("-1K") == std::nullopt);
+    STATIC_REQUIRE(traits::parse("1KB ") == std::nullopt);
+    STATIC_REQUIRE(traits::parse("1XB") == std::nullopt);
+    STATIC_REQUIRE(traits::parse("") == std::nullopt);
+
+    // Printed with the unit that gives the smallest whole number.
+    CHECK(dodo::to_string(dodo::byte_size{0}) == "0B");
+    CHECK(dodo::to_string(dodo::byte_size{1500}) == "1500B");
+    CHECK(dodo::to_string(dodo::byte_size{65'536}) == "64KiB");
+    CHECK(dodo::to_string(dodo::byte_size{3'000'000'000}) == "3GB");
+    CHECK(dodo::to_string(dodo::byte_size{1'610'612'736}) == "1536MiB");
+
+    for (uint64_t const bytes : {0ull, 1ull, 1000ull, 1024ull, 1'024'000ull, 123'456'789ull, 18'446'744'073'709'551'615ull})
+        CHECK(traits::parse(dodo::to_string(dodo::byte_size{bytes})) == dodo::byte_size{bytes});
+}
+
+TEST_CASE("Bit rates are parsed in bits or bytes per second")
+{
+    using traits = dodo::parse_traits<dodo::bit_rate>;
+
+    STATIC_REQUIRE(traits::parse("9600") == dodo::bit_rate{9600});
+    STATIC_REQUIRE(traits::parse("10Mbps") == dodo::bit_rate{10'000'000});
+    STATIC_REQUIRE(traits::parse("10M") == dodo::bit_rate{10'000'000});
+    STATIC_REQUIRE(traits::parse("2.5Gbit/s") == dodo::bit_rate{2'500'000'000});
+    STATIC_REQUIRE(traits::parse("1MB/s") == dodo::bit_rate{8'000'000});
+    STATIC_REQUIRE(traits::parse("1KiB/s") == dodo::bit_rate{8192});
+    STATIC_REQUIRE(traits::parse("10MBps") == std::nullopt);
+    STATIC_REQUIRE(traits::parse("fast") == std::nullopt);
+
+    CHECK(dodo::to_string(dodo::bit_rate{10'000'000}) == "10Mbps");
+    CHECK(dodo::to_string(dodo::bit_rate{8192}) == "8192bps");
+
+    constexpr auto cli =
+        dodo_Opt(dodo::byte_size, cache_size)["--cache-size"]
+            ("Size of the cache.")
+            .by_default(dodo::byte_size{64 * 1024 * 1024})
+        | dodo_Opt(dodo::bit_rate, bandwidth)["--bandwidth"]
+            ("Maximum bandwidth.")
+            .by_default(dodo::bit_rate{100'000'000});
+
+    auto const options = tests::parse(cli, {"--cache-size=1.5GiB"});
+    REQUIRE(options.has_value());
+    REQUIRE(options->cache_size.bytes == 1'610'612'736);
+    REQUIRE(options->bandwidth.bits_per_second == 100'000'000);
+
+    constexpr auto expected =
+        "--cache-size <size>                     Size of the cache.\n"
+        "                                        By default: 64MiB\n"
+        "--bandwidth <rate>                      Maximum bandwidth.\n"
+        "                                        By default: 100Mbps\n"
+        ;
+
+    REQUIRE(cli.to_string() == expected);
+}
+
+TEST_CASE("Benchmark byte size parsing", "[.][benchmark]")
+{
+    std::vector<std::string> plain;
+    std::vector<std::string> with_units;
+    for (uint64_t i = 0; i < 1000; ++i)
+    {
+        plain.push_back(std::to_string(i * 7919 * 1024));
+        with_units.push_back(std::to_string(i * 7919) + "KiB");
+    }
+
+    BENCHMARK("std::from_chars")
+    {
+        uint64_t total = 0;
+        for (std::string const & text : plain)
+            total += *dodo::parse_traits<uint64_t>::parse(text);
+        return total;
+    };
+
+    BENCHMARK("parse_traits<byte_size>, plain numbers")
+    {
+        uint64_t total = 0;
+        for (std::string const & text : plain)
+            total += dodo::parse_traits<dodo::byte_size>::parse(text)->bytes;
+        return total;
+    };
+
+    BENCHMARK("parse_traits<byte_size>, with units")
+    {
+        uint64_t total = 0;
+        for (std::string const & text : with_units)
+            total += dodo::parse_traits<dodo::byte_size>::parse(text)->bytes;
+        return total;
+    };
+}
+
+TEST_CASE("Durations are parsed from numbers with units")
+{
+    using namespace std::chrono;
+
+    STATIC_REQUIRE(dodo::parse_traits<milliseconds>::parse("150ms") == 150ms);
+    STATIC_REQUIRE(dodo::parse_traits<milliseconds>::parse("1.5s") == 1500ms);
+    STATIC_REQUIRE(dodo::parse_traits<seconds>::parse("2h30m") == 9000s);
+    STATIC_REQUIRE(dodo::parse_traits<seconds>::parse("1d2h3min4s") == 93784s);
+    STATIC_REQUIRE(dodo::parse_traits<seconds>::parse("-10s") == -10s);
+    STATIC_REQUIRE(dodo::parse_traits<seconds>::parse("0") == 0s);
+    STATIC_REQUIRE(dodo::parse_traits<nanoseconds>::parse("1us") == 1000ns);
+    STATIC_REQUIRE(dodo::parse_traits<seconds>::parse("1.5s") == std::nullopt); // Not a whole number of seconds.
+    STATIC_REQUIRE(dodo::parse_traits<seconds>::parse("30m2h") == std::nullopt); // Units out of order.
+    STATIC_REQUIRE(dodo::parse_traits<seconds>::parse("1m1m") == std::nullopt);
+    STATIC_REQUIRE(dodo::parse_traits<seconds>::parse("150") == std::nullopt);  // Missing unit.
+    STATIC_REQUIRE(dodo::parse_traits<seconds>::parse("5 s") == std::nullopt);
+    STATIC_REQUIRE(dodo::parse_traits<duration<int8_t>>::parse("200s") == std::nullopt); // Overflow.
+    CHECK(dodo::parse_traits<duration<double>>::parse("1m1.5s") == duration<double>(61.5));
+
+    CHECK(dodo::to_string(9000s) == "2h30m");
+    CHECK(dodo::to_string(1500ms) == "1s500ms");
+    CHECK(dodo::to_string(-90s) == "-1m30s");
+    CHECK(dodo::to_string(0ms) == "0s");
+
+    for (milliseconds const d : {0ms, 1ms, 999ms, 1000ms, 86'400'001ms, -5ms})
+        CHECK(dodo::parse_traits<milliseconds>::parse(dodo::to_string(d)) == d);
+
+    constexpr auto cli = dodo_Opt(milliseconds, timeout)["--timeout"]
+        ("Time to wait for a response.")
+        .by_default(10s);
+
+    auto const options = tests::parse(cli, {"--timeout=2m500ms"});
+    REQUIRE(options.has_value());
+    REQUIRE(options->timeout == 120'500ms);
+
+    constexpr auto expected =
+        "--timeout <duration>                    Time to wait for a response.\n"
+        "                                        By default: 10s\n"
+        ;
+
+    REQUIRE(cli.to_string() == expected);
+}
+
+TEST_CASE("Timestamps are parsed in ISO 8601 format")
+{
+    using namespace std::chrono;
+    using traits = dodo::parse_traits<sys_seconds>;
+
+    constexpr sys_seconds pi_day = sys_days(2021y / March / 14) + 15h + 9min + 26s;
+
+    STATIC_REQUIRE(traits::parse("2021-03-14T15:09:26Z") == pi_day);
+    STATIC_REQUIRE(traits::parse("2021-03-14 15:09:26Z") == pi_day);
+    STATIC_REQUIRE(traits::parse("2021-03-14T15:09:26") == pi_day);
+    STATIC_REQUIRE(traits::parse("2021-03-14T16:39:26+01:30") == pi_day);
+    STATIC_REQUIRE(traits::parse("2021-03-14T10:09:26-05:00") == pi_day);
+    STATIC_REQUIRE(traits::parse("2021-03-14T15:09:26.000Z") == pi_day);
+    STATIC_REQUIRE(traits::parse("2021-03-14") == sys_days(2021y / March / 14));
+    STATIC_REQUIRE(traits::parse("2021-03-14T15:09:26.5Z") == std::nullopt); // Not representable in seconds.
+    STATIC_REQUIRE(traits::parse("2021-02-29T00:00:00Z") == std::nullopt);
+    STATIC_REQUIRE(traits::parse("2021-13-01T00:00:00Z") == std::nullopt);
+    STATIC_REQUIRE(traits::parse("2021-03-14T24:00:00Z") == std::nullopt);
+    STATIC_REQUIRE(traits::parse("2021-03-14T15:60:00Z") == std::nullopt);
+    STATIC_REQUIRE(traits::parse("2021-03-14T15:09") == std::nullopt);
+    STATIC_REQUIRE(traits::parse("2021/03/14T15:09:26Z") == std::nullopt);
+    STATIC_REQUIRE(traits::parse("2021-03-14T15:09:2xZ") == std::nullopt);
+    STATIC_REQUIRE(traits::parse("2021-03-14T15:09:26+1:00") == std::nullopt);
+    STATIC_REQUIRE(dodo::parse_traits<sys_time<milliseconds>>::parse("2021-03-14T15:09:26.535Z") == pi_day + 535ms);
+
+    CHECK(dodo::to_string(pi_day) == "2021-03-14T15:09:26Z");
+    CHECK(dodo::to_string(sys_time<milliseconds>(pi_day + 5ms)) == "2021-03-14T15:09:26.005Z");
+    CHECK(dodo::to_string(sys_time<milliseconds>(pi_day)) == "2021-03-14T15:09:26Z");
+
+    SECTION("Limits of the range of years")
+    {
+        constexpr sys_seconds last = sys_days(9999y / December / 31) + 23h + 59min + 59s;
+        constexpr sys_seconds first = sys_days(0y / January / 1);
+        STATIC_REQUIRE(traits::parse("9999-12-31T23:59:59Z") == last);
+        STATIC_REQUIRE(traits::parse("0000-01-01") == first);
+        STATIC_REQUIRE(traits::parse("1500-01-01") == sys_days(1500y / January / 1));
+        STATIC_REQUIRE(traits::parse("9999-12-31T23:59:59.000000000Z") == last);
+        CHECK(dodo::to_string(last) == "9999-12-31T23:59:59Z");
+        CHECK(dodo::to_string(first) == "0000-01-01T00:00:00Z");
+
+        // Nanoseconds since 1970 only reach from 1677 to 2262.
+        using nanosecond_traits = dodo::parse_traits<sys_time<nanoseconds>>;
+        STATIC_REQUIRE(nanosecond_traits::parse("9999-12-31T23:59:59Z") == std::nullopt);
+        STATIC_REQUIRE(nanosecond_traits::parse("1500-01-01") == std::nullopt);
+        STATIC_REQUIRE(nanosecond_traits::parse("2262-04-11T23:47:16.854775807Z") == sys_time<nanoseconds>::max());
+        STATIC_REQUIRE(nanosecond_traits::parse("2262-04-11T23:47:16.854775808Z") == std::nullopt);
+        STATIC_REQUIRE(nanosecond_traits::parse("2262-04-11T23:47:17Z") == std::nullopt);
+        STATIC_REQUIRE(nanosecond_traits::parse("2262-04-12T00:47:16.854775807+01:00") == sys_time<nanoseconds>::max());
+        STATIC_REQUIRE(nanosecond_traits::parse("1677-09-21T00:12:43.145224192Z") == sys_time<nanoseconds>::min());
+        STATIC_REQUIRE(nanosecond_traits::parse("1677-09-21T00:12:43.145224191Z") == std::nullopt);
+        STATIC_REQUIRE(nanosecond_traits::parse("1677-09-21T00:12:43Z") == std::nullopt);
+        STATIC_REQUIRE(nanosecond_traits::parse("1677-09-21T00:12:44Z") == sys_time<nanoseconds>::min() + 854775808ns);
+
+        // Years that can not be parsed are still written as ISO 8601 expanded years.
+        CHECK(dodo::to_string(sys_seconds(sys_days(-1y / January / 1))) == "-0001-01-01T00:00:00Z");
+        CHECK(dodo::to_string(sys_seconds(sys_days(12345y / June / 7))) == "12345-06-07T00:00:00Z");
+    }
+}
+
+TEST_CASE("Benchmark timestamp parsing", "[.][benchmark]")
+{
+    std::vector<std::string> timestamps;
+    for (int i = 0; i < 1000; ++i)
+        timestamps.push_back(dodo::to_string(std::chrono::sys_seconds(std::chrono::seconds(1'600'000'000 + i * 7919))));
+
+    BENCHMARK("std::get_time")
+    {
+        int64_t total = 0;
+        for (std::string const & text : timestamps)
+        {
+            std::tm tm = {};
+            std::istringstream stream(text);
+            stream >> std::get_time(&tm, "%Y-%m-%dT%H:%M:%S");
+            total += tm.tm_sec;
+        }
+        return total;
+    };
+
+    BENCHMARK("parse_traits<sys_seconds>")
+    {
+        int64_t total = 0;
+        for (std::string const & text : timestamps)
+            total += dodo::parse_traits<std::chrono::sys_seconds>::parse(text)->time_since_epoch().count();
+        return total;
+    };
+}
+
+TEST_CASE("IP addresses, endpoints and CIDR blocks")
+{
+    using dodo::ip_address;
+
+    constexpr auto ip = [](std::string_view text) { return dodo::parse_traits<ip_address>::parse(text); };
+    constexpr auto ip_text = [](std::string_view text) { return dodo::to_string(*dodo::parse_traits<ip_address>::parse(text)); };
+
+    SECTION("IPv4")
+    {
+        STATIC_REQUIRE(ip("10.0.0.1") == ip_address::v4(10, 0, 0, 1));
+        STATIC_REQUIRE(ip("255.255.255.255") == ip_address::v4(255, 255, 255, 255));
+        STATIC_REQUIRE(ip("256.0.0.1") == std::nullopt);
+        STATIC_REQUIRE(ip("10.0.0") == std::nullopt);
+        STATIC_REQUIRE(ip("10.0.0.1.") == std::nullopt);
+        STATIC_REQUIRE(ip("10.00.0.1") == std::nullopt);
+        STATIC_REQUIRE(ip("10.0.0.-1") == std::nullopt);
+        CHECK(ip_text("192.168.1.20") == "192.168.1.20");
+    }
+    SECTION("IPv6")
+    {
+        STATIC_REQUIRE(ip("::")->family == dodo::ip_family::v6);
+        STATIC_REQUIRE(ip("::1")->bytes[15] == 1);
+        STATIC_REQUIRE(ip("2001:db8::1") == ip("2001:0db8:0000:0000:0000:0000:0000:0001"));
+        STATIC_REQUIRE(ip("::ffff:10.0.0.1") == ip("::ffff:a00:1"));
+        STATIC_REQUIRE(ip("1::2::3") == std::nullopt);
+        STATIC_REQUIRE(ip("1:2:3:4:5:6:7:8:9") == std::nullopt);
+        STATIC_REQUIRE(ip("1:2:3:4:5:6:7") == std::nullopt);
+        STATIC_REQUIRE(ip("12345::") == std::nullopt);
+        STATIC_REQUIRE(ip("1:") == std::nullopt);
+        STATIC_REQUIRE(ip(":1") == std::nullopt);
+        STATIC_REQUIRE(ip("g::") == std::nullopt);
+
+        // Canonical form of RFC 5952.
+        CHECK(ip_text("2001:0DB8:0000:0000:0000:0000:0000:0001") == "2001:db8::1");
+        CHECK(ip_text("2001:db8:0:0:1:0:0:1") == "2001:db8::1:0:0:1");
+        CHECK(ip_text("2001:db8:0:1:1:1:1:1") == "2001:db8:0:1:1:1:1:1");
+        CHECK(ip_text("::") == "::");
+        CHECK(ip_text("1::") == "1::");
+        CHECK(ip_text("::ffff:a00:1") == "::ffff:10.0.0.1");
+    }
+    SECTION("Endpoints")
+    {
+        using traits = dodo::parse_traits<dodo::endpoint>;
+
+        STATIC_REQUIRE(traits::parse("0.0.0.0:8080") == dodo::endpoint{ip_address::v4(0, 0, 0, 0), 8080});
+        STATIC_REQUIRE(traits::parse("[::1]:7000")->port == 7000);
+        STATIC_REQUIRE(traits::parse("[::1]:7000")->address == ip("::1"));
+        STATIC_REQUIRE(traits::parse("10.0.0.1:65536") == std::nullopt);
+        STATIC_REQUIRE(traits::parse("10.0.0.1") == std::nullopt);
+        STATIC_REQUIRE(traits::parse("10.0.0.1:") == std::nullopt);
+        STATIC_REQUIRE(traits::parse("::1:7000") == std::nullopt);
+        STATIC_REQUIRE(traits::parse("[10.0.0.1]:7000") == std::nullopt);
+        CHECK(dodo::to_string(*traits::parse("[::1]:7000")) == "[::1]:7000");
+    }
+    SECTION("CIDR blocks")
+    {
+        using traits = dodo::parse_traits<dodo::cidr_block>;
+
+        constexpr dodo::cidr_block block = *traits::parse("10.0.0.0/8");
+        STATIC_REQUIRE(block.contains(ip_address::v4(10, 1, 2, 3)));
+        STATIC_REQUIRE(!block.contains(ip_address::v4(11, 0, 0, 0)));
+        STATIC_REQUIRE(traits::parse("172.16.0.0/12")->contains(ip_address::v4(172, 31, 255, 255)));
+        STATIC_REQUIRE(!traits::parse("172.16.0.0/12")->contains(ip_address::v4(172, 32, 0, 0)));
+        STATIC_REQUIRE(traits::parse("fe80::/10")->contains(*ip("fe80::1")));
+        STATIC_REQUIRE(traits::parse("10.0.0.1/8") == std::nullopt); // Bits after the prefix.
+        STATIC_REQUIRE(traits::parse("10.0.0.0/33") == std::nullopt);
+        STATIC_REQUIRE(traits::parse("10.0.0.0") == std::nullopt);
+        CHECK(dodo::to_string(block) == "10.0.0.0/8");
+    }
+    SECTION("Lists of endpoints")
+    {
+        constexpr auto cli =
+            dodo_Opt(dodo::endpoint, listen)["--listen"]
+                ("Address to listen on.")
+            | dodo_Opt(std::vector<dodo::endpoint>, peers)["--peers"]
+                ("Other nodes of the cluster.")
+            | dodo_Opt(std::vector<dodo::cidr_block>, allow)["--allow"]
+                ("Blocks of addresses that are allowed to connect.");
+
+        auto const options = tests::parse(cli, {"--listen=0.0.0.0:8080", "--peers=10.0.0.1:7000 [fe80::1]:7000", "--allow=10.0.0.0/8"});
+        REQUIRE(options.has_value());
+        REQUIRE(options->listen.port == 8080);
+        REQUIRE(options->peers.size() == 2);
+        REQUIRE(options->peers[1].address == ip("fe80::1"));
+        REQUIRE(options->allow.size() == 1);
+        REQUIRE(options->allow[0].contains(options->peers[0].address));
+
+        REQUIRE(!tests::parse(cli, {"--listen=0.0.0.0:8080", "--peers=10.0.0.1:7000 10.0.0.2", "--allow=10.0.0.0/8"}).has_value());
+    }
+}
+
+namespace tests
+{
+    struct Resolution
+    {
+        int width;
+        int height;
+
+        constexpr bool operator == (Resolution const & other) const noexcept = default;
+    };
+
+    struct Mirror
+    {
+        std::string name;
+        dodo::endpoint address;
+        int priority;
+    };
+}
+
+template <> struct dodo::parse_traits<tests::Resolution> : dodo::aggregate_parse_traits<tests::Resolution, 'x'> {};
+template <> struct dodo::parse_traits<tests::Mirror> : dodo::aggregate_parse_traits<tests::Mirror, '@'> {};
+
+TEST_CASE("Compound values are parsed from fields with a separator")
+{
+    using tests::Resolution;
+
+    SECTION("Aggregates")
+    {
+        using traits = dodo::parse_traits<Resolution>;
+
+        CHECK(traits::parse("1920x1080") == Resolution{1920, 1080});
+        CHECK(traits::parse("1920x") == std::nullopt);
+        CHECK(traits::parse("1920") == std::nullopt);
+        CHECK(traits::parse("1920x1080x60") == std::nullopt);
+        CHECK(traits::parse("ax1080") == std::nullopt);
+        CHECK(dodo::to_string(Resolution{1280, 720}) == "1280x720");
+
+        auto const mirror = dodo::parse_traits<tests::Mirror>::parse("eu@10.0.0.1:80@2");
+        REQUIRE(mirror.has_value());
+        CHECK(mirror->name == "eu");
+        CHECK(mirror->address.port == 80);
+        CHECK(mirror->priority == 2);
+        CHECK(dodo::to_string(*mirror) == "eu@10.0.0.1:80@2");
+    }
+    SECTION("Pairs and tuples")
+    {
+        CHECK(dodo::parse_traits<std::pair<int, double>>::parse("3,0.5") == std::pair(3, 0.5));
+        CHECK(dodo::parse_traits<std::tuple<int, int, int>>::parse("1,2,3") == std::tuple(1, 2, 3));
+        CHECK(dodo::parse_traits<std::tuple<int, int, int>>::parse("1,2") == std::nullopt);
+        CHECK(dodo::tuple_parse_traits<std::pair<int, int>, ':'>::parse("4:3") == std::pair(4, 3));
+        CHECK(dodo::to_string(std::tuple(1, std::string("a"), 2)) == "1,a,2");
+    }
+    SECTION("Maps")
+    {
+        using map = dodo::flat_map<std::string, int>;
+        using traits = dodo::parse_traits<map>;
+
+        auto const labels = traits::parse("b=2,a=1,c=3");
+        REQUIRE(labels.has_value());
+        REQUIRE(labels->size() == 3);
+        CHECK(labels->entries.front() == std::pair("a"s, 1));
+        CHECK(labels->find("b"sv)->second == 2);
+        CHECK(labels->contains("c"sv));
+        CHECK(!labels->contains("d"sv));
+        CHECK(dodo::to_string(*labels) == "a=1,b=2,c=3");
+
+        CHECK(traits::parse("")->empty());
+        CHECK(traits::parse("a=1,a=2") == std::nullopt);
+        CHECK(traits::parse("a=1,b") == std::nullopt);
+        CHECK(traits::parse("a=1,") == std::nullopt);
+        CHECK(traits::parse("a=x") == std::nullopt);
+        CHECK(traits::parse("a=1=2") == std::nullopt);
+    }
+    SECTION("Options")
+    {
+        using labels_map = dodo::flat_map<std::string_view, std::string_view>;
+
+        constexpr auto cli =
+            dodo_Opt(Resolution, resolution)["--resolution"]
+                ("Size of the window.")
+                .by_default(Resolution{1280, 720})
+            | dodo_Opt(labels_map, labels)["--labels"]
+                ("Labels to attach to the process.");
+
+        auto const options = tests::parse(cli, {"--resolution=1920x1080", "--labels=zone=eu,tier=web"});
+        REQUIRE(options.has_value());
+        REQUIRE(options->resolution == Resolution{1920, 1080});
+        REQUIRE(options->labels.find("zone"sv)->second == "eu");
+        REQUIRE(options->labels.find("tier"sv)->second == "web");
+    }
+}
+
+TEST_CASE("Binary values are parsed from hex and base64")
+{
+    SECTION("Hex")
+    {
+        using traits = dodo::parse_traits<dodo::hex_key<4>>;
+
+        STATIC_REQUIRE(traits::parse("deadBEEF") == dodo::hex_key<4>{{0xDE, 0xAD, 0xBE, 0xEF}});
+        STATIC_REQUIRE(traits::parse("deadbee") == std::nullopt);
+        STATIC_REQUIRE(traits::parse("deadbeef00") == std::nullopt);
+        STATIC_REQUIRE(traits::parse("deadbeeg") == std::nullopt);
+        CHECK(dodo::to_string(*traits::parse("DEADBEEF")) == "deadbeef");
+        CHECK(traits::parse_error("deadbeeg") == "Invalid character 'g' at offset 7");
+        CHECK(traits::parse_error("deadbee") == "Expected 8 characters, found 7");
+
+        // Errors in the middle of a long payload are found at the right offset.
+        std::string payload(100, 'a');
+        CHECK(dodo::parse_traits<dodo::hex_blob>::parse(payload)->bytes.size() == 50);
+        payload[37] = 'x';
+        CHECK(dodo::parse_traits<dodo::hex_blob>::parse(payload) == std::nullopt);
+        CHECK(dodo::parse_traits<dodo::hex_blob>::parse_error(payload) == "Invalid character 'x' at offset 37");
+        CHECK(dodo::parse_traits<dodo::hex_blob>::parse_error("abc") == "Odd number of hex digits at offset 3");
+    }
+    SECTION("Base64")
+    {
+        using traits = dodo::parse_traits<dodo::base64_blob>;
+
+        auto const decode = [](std::string_view text) { return std::string(text.size(), '\0').assign(reinterpret_cast<char const *>(traits::parse(text)->bytes.data()), traits::parse(text)->bytes.size()); };
+
+        // Test vectors of RFC 4648.
+        CHECK(decode("") == "");
+        CHECK(decode("Zg==") == "f");
+        CHECK(decode("Zm8=") == "fo");
+        CHECK(decode("Zm9v") == "foo");
+        CHECK(decode("Zm9vYg==") == "foob");
+        CHECK(decode("Zm9vYmE=") == "fooba");
+        CHECK(decode("Zm9vYmFy") == "foobar");
+        CHECK(dodo::to_string(*traits::parse("Zm9vYmE=")) == "Zm9vYmE=");
+
+        CHECK(traits::parse("Zm9") == std::nullopt);
+        CHECK(traits::parse("Zm9vY===") == std::nullopt);
+        CHECK(traits::parse("Zh==") == std::nullopt); // Nonzero bits after the data.
+        CHECK(traits::parse("Z=9v") == std::nullopt);
+        CHECK(traits::parse_error("Zm9v*mFy") == "Invalid character '*' at offset 4");
+        CHECK(traits::parse_error("Zh==") == "Nonzero padding bits in character 'h' at offset 1");
+
+        STATIC_REQUIRE(dodo::parse_traits<dodo::base64_key<2>>::parse("Zm8=") == dodo::base64_key<2>{{'f', 'o'}});
+        STATIC_REQUIRE(dodo::parse_traits<dodo::base64_key<2>>::parse("Zg==") == std::nullopt);
+
+        // Text of the encoded length of the key that decodes to more bytes.
+        CHECK(dodo::parse_traits<dodo::base64_key<2>>::parse("Zm9v") == std::nullopt);
+        CHECK(dodo::parse_traits<dodo::base64_key<2>>::parse_error("Zm9v") == "Expected 2 bytes, found 3");
+        CHECK(dodo::parse_traits<dodo::base64_key<1>>::parse("Zm9v") == std::nullopt);
+        CHECK(dodo::parse_traits<dodo::base64_key<1>>::parse_error("Zm9v") == "Expected 1 bytes, found 3");
+        CHECK(dodo::parse_traits<dodo::base64_key<1>>::parse_error("Zm8=") == "Expected 1 bytes, found 2");
+    }
+    SECTION("Options")
+    {
+        constexpr auto cli =
+            dodo_Opt(dodo::hex_key<4>, salt)["--salt"]
+                ("Salt for the hash.")
+                .by_default(dodo::hex_key<4>{{1, 2, 3, 4}})
+            | dodo_Opt(dodo::base64_blob, payload)["--payload"]
+                ("Data to send.");
+
+        auto const options = tests::parse(cli, {"--payload=Zm9v"});
+        REQUIRE(options.has_value());
+        REQUIRE(options->salt == dodo::hex_key<4>{{1, 2, 3, 4}});
+        REQUIRE(options->payload.bytes.size() == 3);
+
+        auto const error = tests::parse(cli, {"--salt=0102030g", "--payload=Zm9v"});
+        REQUIRE(!error.has_value());
+        CHECK(error.error().find("Invalid character 'g' at offset 7") != std::string::npos);
+
+        std::string const help = cli.to_string();
+        CHECK(help.find("--salt <hex>") != std::string::npos);
+        CHECK(help.find("By default: 01020304") != std::string::npos);
+    }
+}
+
+TEST_CASE("Fixed capacity containers are parsed without allocating")
+{
+    SECTION("std::array")
+    {
+        using traits = dodo::parse_traits<std::array<dodo::byte_size, 3>>;
+
+        STATIC_REQUIRE(traits::parse("1kB 2MB 3")->at(1) == dodo::byte_size{2'000'000});
+        STATIC_REQUIRE(traits::parse("1kB  2MB 3") == traits::parse("1kB 2MB 3"));
+        STATIC_REQUIRE(traits::parse("1kB 2MB") == std::nullopt);
+        STATIC_REQUIRE(traits::parse("1kB 2MB 3 4") == std::nullopt);
+        CHECK(traits::parse_error("1kB 2MB") == "Expected 3 values, found 2");
+        CHECK(dodo::to_string(std::array{1, 2, 3}) == "1 2 3");
+    }
+    SECTION("static_vector")
+    {
+        using vector = dodo::static_vector<int, 3>;
+        using traits = dodo::parse_traits<vector>;
+
+        CHECK(traits::parse("4 5") == vector{4, 5});
+        CHECK(traits::parse("4 5 6") == vector{4, 5, 6});
+        CHECK(traits::parse("4 5 6 7") == std::nullopt);
+        CHECK(traits::parse("4 x") == std::nullopt);
+        CHECK(traits::parse_error("4 5 6 7") == "Expected at most 3 values, found 4");
+        CHECK(traits::parse_error("4 x") == "");
+        CHECK(dodo::to_string(vector{7, 8}) == "7 8");
+
+        STATIC_REQUIRE(dodo::parse_traits<dodo::static_vector<bool, 2>>::parse("true false")->size() == 2);
+        STATIC_REQUIRE(dodo::static_vector<int, 4>{1, 2}.size() == 2);
+        STATIC_REQUIRE(dodo::static_vector<int, 4>::capacity() == 4);
+    }
+    SECTION("Options")
+    {
+        using ports_vector = dodo::static_vector<uint16_t, 4>;
+        using position_array = std::array<double, 3>;
+
+        constexpr auto cli =
+            dodo_Opt(ports_vector, ports)["--ports"]
+                ("Ports to listen on.")
+                .by_default_range(uint16_t(80), uint16_t(443))
+            | dodo_Opt(position_array, position)["--position"]
+                ("Position of the camera.")
+                .by_default(position_array{0, 0, 0});
+
+        auto const defaults = tests::parse(cli, {});
+        REQUIRE(defaults.has_value());
+        REQUIRE(defaults->ports == ports_vector{80, 443});
+
+        auto const options = tests::parse(cli, {"--ports=1 2 3 4", "--position=1 2.5 3"});
+        REQUIRE(options.has_value());
+        REQUIRE(options->ports.size() == 4);
+        REQUIRE(options->position[1] == 2.5);
+
+        auto const error = tests::parse(cli, {"--ports=1 2 3 4 5"});
+        REQUIRE(!error.has_value());
+        CHECK(error.error().find("Expected at most 4 values, found 5") != std::string::npos);
+
+        CHECK(cli.to_string().find("By default: 80 443") != std::string::npos);
+    }
+}
+
+namespace tests
+{
+    // Counts calls to the global operator new, to check that parsing does not allocate.
+    thread_local size_t allocation_count = 0;
+}
+
+void * operator new(size_t size)
+{
+    ++tests::allocation_count;
+    if (void * const p = std::malloc(size == 0 ? 1 : size))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void * p) noexcept { std::free(p); }
+void operator delete(void * p, size_t) noexcept { std::free(p); }
+
+TEST_CASE("Realtime parsing does not allocate")
+{
+    using channel_list = dodo::static_vector<int, 4>;
+
+    constexpr auto cli =
+        dodo_Arg(std::string_view, command, "command")
+        | dodo_Opt(float, gain)["--gain"]
+            .check([](float g) { return g >= 0.0f && g <= 2.0f; }, "Gain must be between 0 and 2.")
+        | dodo_Opt(channel_list, channels)["--channels"]
+            .by_default_range(0, 1)
+        | dodo_Flag(mute)["--mute"];
+
+    constexpr auto heap_cli = dodo_Opt(std::string, name)["--name"] | dodo_Opt(int, x)["--x"];
+
+    using limits = dodo::realtime_limits<4, 32>;
+    static_assert(dodo::RealtimeParser<std::remove_cvref_t<decltype(cli)>>);
+    static_assert(!dodo::RealtimeParser<std::remove_cvref_t<decltype(heap_cli)>>);
+
+    auto const parse = [&cli](std::initializer_list<std::string_view> args)
+    {
+        return dodo::parse_realtime<limits>(cli, std::span<std::string_view const>(args));
+    };
+
+    size_t const allocations_before = tests::allocation_count;
+
+    auto const ok = parse({"set", "--gain=1.5", "--channels=2 3 5", "--mute"});
+    auto const defaults = parse({"set", "--gain=0.5"});
+    auto const too_many = parse({"set", "--gain=1", "--mute", "--channels=1", "--gain=2"});
+    auto const too_long = parse({"set", "--channels=1 2 3 4 5 6 7 8 9 10 11 12 13"});
+    auto const unrecognized = parse({"set", "--gain=1", "--volume=3"});
+    auto const repeated = parse({"set", "--gain=1", "--gain=1"});
+    auto const conversion = parse({"set", "--gain=loud"});
+    auto const validation = parse({"set", "--gain=3"});
+    auto const capacity = parse({"set", "--gain=1", "--channels=1 2 3 4 5"});
+    auto const missing_option = parse({"set"});
+    auto const missing_argument = parse({"--gain=1"});
+    auto const extra_argument = parse({"set", "now", "--gain=1"});
+
+    size_t const allocations = tests::allocation_count - allocations_before;
+    CHECK(allocations == 0);
+
+    // The regular parse of an option of string type allocates, which the hook sees.
+    REQUIRE(tests::parse(heap_cli, {"--name=a long name that does not fit in a small string", "--x=1"}).has_value());
+    CHECK(tests::allocation_count > allocations_before);
+
+    REQUIRE(ok.has_value());
+    CHECK(ok->command == "set");
+    CHECK(ok->gain == 1.5f);
+    CHECK(ok->channels == channel_list{2, 3, 5});
+    CHECK(ok->mute);
+
+    REQUIRE(defaults.has_value());
+    CHECK(defaults->channels == channel_list{0, 1});
+    CHECK(!defaults->mute);
+
+    using dodo::parse_error_code;
+    using dodo::realtime_error;
+    CHECK(too_many.error() == realtime_error{parse_error_code::too_many_arguments, 4});
+    CHECK(too_long.error() == realtime_error{parse_error_code::argument_too_long, 1});
+    CHECK(unrecognized.error() == realtime_error{parse_error_code::unrecognized_argument, 2});
+    CHECK(repeated.error() == realtime_error{parse_error_code::unrecognized_argument, 2});
+    CHECK(conversion.error() == realtime_error{parse_error_code::conversion_failed, 1});
+    CHECK(validation.error() == realtime_error{parse_error_code::validation_failed, 1});
+    CHECK(capacity.error() == realtime_error{parse_error_code::conversion_failed, 2});
+    CHECK(missing_option.error() == realtime_error{parse_error_code::missing_option, 1});
+    CHECK(missing_argument.error() == realtime_error{parse_error_code::missing_argument, 0});
+    CHECK(extra_argument.error() == realtime_error{parse_error_code::too_many_arguments, 1});
+    CHECK(dodo::error_message(parse_error_code::missing_option) == "Missing option");
+}
+
+namespace tests
+{
+    // Counts its copies, to check that validation works on references.
+    struct CountedPaths
+    {
+        CountedPaths() noexcept = default;
+        explicit CountedPaths(std::vector<std::string> paths_) noexcept : paths(std::move(paths_)) {}
+        CountedPaths(CountedPaths const & other) : paths(other.paths) { ++copies; }
+        CountedPaths(CountedPaths &&) noexcept = default;
+        CountedPaths & operator = (CountedPaths const & other) { paths = other.paths; ++copies; return *this; }
+        CountedPaths & operator = (CountedPaths &&) noexcept = default;
+
+        std::vector<std::string> paths;
+        static inline int copies = 0;
+    };
+}
+
+template <>
+struct dodo::parse_traits<tests::CountedPaths>
+{
+    static std::optional<tests::CountedPaths> parse(std::string_view text) noexcept
+    {
+        auto paths = dodo::parse_traits<std::vector<std::string>>::parse(text);
+        if (!paths)
+            return std::nullopt;
+        return tests::CountedPaths(std::move(*paths));
+    }
+
+    static std::string to_string(tests::CountedPaths const & p)
+    {
+        return dodo::to_string(p.paths);
+    }
+};
+
+TEST_CASE("Chained checks validate a reference to the value")
+{
+    using tests::CountedPaths;
+
+    static int message_calls = 0;
+
+    constexpr auto cli =
+        dodo_Opt(CountedPaths, paths)["--paths"]
+            .check([](CountedPaths const & p) { return !p.paths.empty(); }, "At least one path is needed.")
+            .check([](CountedPaths const & p) { return p.paths.size() <= 3; }, [](CountedPaths const & p)
+            {
+                ++message_calls;
+                return "At most 3 paths can be given, but " + std::to_string(p.paths.size()) + " were given.";
+            })
+            .check([](CountedPaths const & p) { return std::ranges::none_of(p.paths, [](std::string const & s) { return s.ends_with('/'); }); },
+                "Paths cannot end in /.");
+
+    CountedPaths::copies = 0;
+
+    auto const ok = tests::parse(cli, {"--paths=a b c"});
+    REQUIRE(ok.has_value());
+    CHECK(ok->paths.paths.size() == 3);
+    CHECK(CountedPaths::copies == 0);
+    CHECK(message_calls == 0);
+
+    auto const too_many = tests::parse(cli, {"--paths=a b c d"});
+    REQUIRE(!too_many.has_value());
+    CHECK(too_many.error().find("At most 3 paths can be given, but 4 were given.") != std::string::npos);
+    CHECK(message_calls == 1);
+
+    auto const trailing_slash = tests::parse(cli, {"--paths=a b/"});
+    REQUIRE(!trailing_slash.has_value());
+    CHECK(trailing_slash.error().find("Paths cannot end in /.") != std::string::npos);
+    CHECK(message_calls == 1);
+
+    CHECK(CountedPaths::copies == 0);
+}
+
+TEST_CASE("Validators check ranges, sets and lengths and appear in the help text")
+{
+    SECTION("Predicates")
+    {
+        constexpr dodo::in_range range(-10, 10);
+        STATIC_REQUIRE(range(-10));
+        STATIC_REQUIRE(range(0));
+        STATIC_REQUIRE(range(10));
+        STATIC_REQUIRE(!range(11));
+        STATIC_REQUIRE(!range(-11));
+        STATIC_REQUIRE(!range(std::numeric_limits<int>::min()));
+        STATIC_REQUIRE(dodo::in_range<uint16_t>(1, 100)(uint16_t(100)));
+        STATIC_REQUIRE(!dodo::in_range<uint16_t>(1, 100)(uint16_t(0)));
+        STATIC_REQUIRE(dodo::in_range(0.0, 1.0)(0.5));
+        STATIC_REQUIRE(!dodo::in_range(0.0, 1.0)(1.5));
+
+        // Mixed signedness, where converting to the common type changes the values.
+        STATIC_REQUIRE(!dodo::in_range(-1, 10).contains(4294967295u));
+        STATIC_REQUIRE(!dodo::in_range(-5, 10).contains(4294967293u));
+        STATIC_REQUIRE(dodo::in_range(-5, 10).contains(4u));
+        STATIC_REQUIRE(!dodo::in_range(1u, 10u).contains(-1));
+        STATIC_REQUIRE(dodo::in_range(1u, 10u).contains(10));
+        STATIC_REQUIRE(!dodo::in_range<int64_t>(-5, 5).contains(uint64_t(-3)));
+
+        STATIC_REQUIRE(range(std::array{1, 2, 3}));
+        STATIC_REQUIRE(!range(std::array{1, 20, 3}));
+
+        constexpr dodo::one_of modes("fast", "slow");
+        STATIC_REQUIRE(std::is_same_v<std::remove_cvref_t<decltype(modes)>, dodo::one_of<std::string_view, 2>>);
+        STATIC_REQUIRE(modes("fast"sv));
+        STATIC_REQUIRE(!modes("medium"sv));
+        CHECK(modes(std::vector<std::string>{"slow", "fast"}));
+        CHECK(!modes(std::vector<std::string>{"slow", "medium"}));
+        STATIC_REQUIRE(dodo::one_of(1, 2, 4, 8)(4));
+
+        STATIC_REQUIRE(dodo::max_len(3)("abc"sv));
+        STATIC_REQUIRE(!dodo::max_len(3)("abcd"sv));
+        CHECK(!dodo::max_len(3)(std::vector<std::string>{"a", "abcd"}));
+    }
+    SECTION("Options")
+    {
+        constexpr auto cli =
+            dodo_Opt(int, threads)["--threads"]
+                ("Amount of worker threads.")
+                .check(dodo::in_range(1, 64))
+                .by_default(8)
+            | dodo_Opt(std::string, mode)["--mode"]
+                ("Compression mode.")
+                .check(dodo::one_of("fast", "slow"))
+            | dodo_Opt(std::vector<std::string>, tags)["--tags"]
+                ("Tags for the build.")
+                .check(dodo::max_len(8))
+                .by_default_range("debug"sv);
+
+        auto const options = tests::parse(cli, {"--threads=16", "--mode=slow", "--tags=a b c"});
+        REQUIRE(options.has_value());
+        CHECK(options->threads == 16);
+
+        auto const out_of_range = tests::parse(cli, {"--threads=0", "--mode=fast"});
+        REQUIRE(!out_of_range.has_value());
+        CHECK(out_of_range.error().find("Value must be in the range [1, 64].") != std::string::npos);
+
+        auto const not_allowed = tests::parse(cli, {"--mode=medium"});
+        REQUIRE(!not_allowed.has_value());
+        CHECK(not_allowed.error().find("Value must be one of: fast, slow.") != std::string::npos);
+
+        auto const too_long = tests::parse(cli, {"--mode=fast", "--tags=release sanitizers"});
+        REQUIRE(!too_long.has_value());
+        CHECK(too_long.error().find("Value must be at most 8 characters long.") != std::string::npos);
+
+        std::string const help = cli.to_string();
+        CHECK(help.find(
+            "Amount of worker threads.\n"
+            "                                        Range: [1, 64]\n"
+            "                                        By default: 8\n") != std::string::npos);
+        CHECK(help.find("Allowed values: fast, slow\n") != std::string::npos);
+        CHECK(help.find("Maximum length: 8\n") != std::string::npos);
+    }
+}
+
+TEST_CASE("Path validators check that files and directories exist")
+{
+    namespace fs = std::filesystem;
+
+    fs::path const directory = fs::temp_directory_path() / "dodo_path_validators_test";
+    fs::remove_all(directory);
+    fs::create_directories(directory);
+
+    std::vector<fs::path> files;
+    for (int i = 0; i < 500; ++i)
+    {
+        files.push_back(directory / ("file" + std::to_string(i)));
+        std::ofstream(files.back()) << i;
+    }
+
+    SECTION("Single paths")
+    {
+        CHECK(dodo::existing_file(files[0]));
+        CHECK(!dodo::existing_file(directory));
+        CHECK(dodo::existing_directory(directory));
+        CHECK(dodo::existing_path(directory.string()));
+        CHECK(!dodo::existing_path(directory / "missing"));
+        CHECK(dodo::existing_file.error_message(directory / "missing") == "No such file: " + (directory / "missing").string());
+    }
+    SECTION("Lists of paths are checked in parallel")
+    {
+        CHECK(dodo::existing_file(files));
+
+        std::vector<fs::path> with_missing = files;
+        with_missing[123] = directory / "missing1";
+        with_missing[456] = directory / "missing2";
+        CHECK(!dodo::existing_file(with_missing));
+        CHECK(dodo::existing_file.error_message(with_missing) ==
+            "No such file: " + (directory / "missing1").string() + ", " + (directory / "missing2").string());
+
+        for (int i = 0; i < 12; ++i)
+            with_missing[i] = directory / "missing";
+        CHECK(dodo::existing_file.error_message(with_missing).ends_with(" and 4 more"));
+    }
+    SECTION("Options")
+    {
+        constexpr auto cli =
+            dodo_Opt(std::vector<fs::path>, inputs)["--inputs"]
+                ("Files to process.")
+                .check(dodo::existing_file)
+            | dodo_Opt(fs::path, output)["--output"]
+                ("Directory to write the results to.")
+                .check(dodo::existing_directory);
+
+        std::string const output_arg = "--output=" + directory.string();
+        std::string const inputs_arg = "--inputs=" + files[1].string() + ' ' + files[2].string();
+        std::string const missing_arg = "--inputs=" + files[1].string() + ' ' + (directory / "missing").string();
+
+        auto const options = tests::parse(cli, {inputs_arg, output_arg});
+        REQUIRE(options.has_value());
+        CHECK(options->inputs.size() == 2);
+        CHECK(options->output == directory);
+
+        auto const missing = tests::parse(cli, {missing_arg, output_arg});
+        REQUIRE(!missing.has_value());
+        CHECK(missing.error().find("No such file: " + (directory / "missing").string()) != std::string::npos);
+
+        std::string const help = cli.to_string();
+        CHECK(help.find("--output <path>") != std::string::npos);
+        CHECK(help.find("Must be an existing directory") != std::string::npos);
+    }
+    SECTION("Paths of all options are checked together after the rest of the parse")
+    {
+        constexpr auto cli =
+            dodo_Opt(std::vector<fs::path>, inputs)["--inputs"]
+                .check(dodo::existing_file)
+            | dodo_Opt(fs::path, output)["--output"]
+                .check(dodo::existing_directory)
+            | dodo_Opt(int, jobs)["--jobs"]
+                .check([](int jobs) { return jobs > 0; }, "Must be positive.");
+
+        std::string inputs_arg = "--inputs=";
+        for (fs::path const & file : files)
+            inputs_arg += file.string() + ' ';
+        inputs_arg += (directory / "missing").string();
+        std::string const output_arg = "--output=" + (directory / "missing_output").string();
+
+        // Checks that are not deferred fail first, even for options given after the paths.
+        auto const bad_jobs = tests::parse(cli, {inputs_arg, output_arg, "--jobs=0"});
+        REQUIRE(!bad_jobs.has_value());
+        CHECK(bad_jobs.error().find("Must be positive.") != std::string::npos);
+
+        auto const missing = tests::parse(cli, {inputs_arg, output_arg, "--jobs=4"});
+        REQUIRE(!missing.has_value());
+        CHECK(missing.error().starts_with("Validation check failed for option --inputs"));
+        CHECK(missing.error().ends_with(inputs_arg.substr(9) + "\":\n\tNo such file: " + (directory / "missing").string()));
+
+        auto const missing_output = tests::parse(cli, {"--inputs=" + files[0].string(), output_arg, "--jobs=4"});
+        REQUIRE(!missing_output.has_value());
+        CHECK(missing_output.error().ends_with("No such directory: " + (directory / "missing_output").string()));
+
+        auto const options = tests::parse(cli, {"--inputs=" + files[0].string(), "--output=" + directory.string(), "--jobs=4"});
+        REQUIRE(options.has_value());
+        CHECK(options->jobs == 4);
+    }
+    SECTION("Lists can be checked from several threads at once")
+    {
+        std::vector<fs::path> with_missing = files;
+        with_missing[321] = directory / "missing";
+
+        std::atomic<int> failures = 0;
+        {
+            std::vector<std::jthread> threads;
+            for (int i = 0; i < 4; ++i)
+                threads.emplace_back([&]
+                {
+                    for (int j = 0; j < 20; ++j)
+                        failures += !dodo::existing_file(with_missing) && dodo::existing_file(files);
+                });
+        }
+        CHECK(failures == 80);
+    }
+
+    fs::remove_all(directory);
+}
+
+TEST_CASE("Regex validators are compiled at compile time")
+{
+    SECTION("Predicates")
+    {
+        constexpr auto identifier = dodo::matches<"[a-zA-Z_]\\w*">;
+        STATIC_REQUIRE(identifier("snake_case"sv));
+        STATIC_REQUIRE(identifier("_1"sv));
+        STATIC_REQUIRE(!identifier("1abc"sv));
+        STATIC_REQUIRE(!identifier(""sv));
+        STATIC_REQUIRE(!identifier("kebab-case"sv));
+
+        constexpr auto version = dodo::matches<"^v?\\d+(\\.\\d+){1,2}(-(alpha|beta|rc)\\d*)?$">;
+        STATIC_REQUIRE(version("1.2"sv));
+        STATIC_REQUIRE(version("v1.22.333"sv));
+        STATIC_REQUIRE(version("1.0.0-rc2"sv));
+        STATIC_REQUIRE(version("2.1-beta"sv));
+        STATIC_REQUIRE(!version("1"sv));
+        STATIC_REQUIRE(!version("1.2.3.4"sv));
+        STATIC_REQUIRE(!version("1.2-gamma"sv));
+        STATIC_REQUIRE(!version("1..2"sv));
+
+        constexpr auto tag = dodo::matches<"[^\\s,]{1,8}|(?:x|y)*">;
+        STATIC_REQUIRE(tag("release"sv));
+        STATIC_REQUIRE(!tag("too-long-tag"sv));
+        STATIC_REQUIRE(!tag("a,b"sv));
+        STATIC_REQUIRE(tag(""sv));
+        STATIC_REQUIRE(tag("xyxyxyxyxyxy"sv));
+
+        STATIC_REQUIRE(dodo::matches<"a.c">("a-c"sv));
+        STATIC_REQUIRE(dodo::matches<"a\\.c">("a.c"sv));
+        STATIC_REQUIRE(!dodo::matches<"a\\.c">("abc"sv));
+        STATIC_REQUIRE(dodo::matches<"[-+]?\\d{2,}">("-123"sv));
+        STATIC_REQUIRE(!dodo::matches<"[-+]?\\d{2,}">("+1"sv));
+        STATIC_REQUIRE(dodo::matches<"(ab)+">("ababab"sv));
+        STATIC_REQUIRE(!dodo::matches<"(ab)+">("aba"sv));
+        STATIC_REQUIRE(dodo::matches<"a{2}{2}">("aaaa"sv));
+        STATIC_REQUIRE(!dodo::matches<"a{2}{2}">("aaa"sv));
+        STATIC_REQUIRE(!dodo::matches<"a{2}{2}">("aaaaaa"sv));
+        STATIC_REQUIRE(dodo::matches<"a+{2}">("aa"sv));
+        STATIC_REQUIRE(dodo::matches<"a+{2}">("aaaaa"sv));
+        STATIC_REQUIRE(!dodo::matches<"a+{2}">("a"sv));
+        STATIC_REQUIRE(dodo::matches<"a?{2}">(""sv));
+        STATIC_REQUIRE(dodo::matches<"a?{2}">("aa"sv));
+        STATIC_REQUIRE(!dodo::matches<"a?{2}">("aaa"sv));
+        STATIC_REQUIRE(dodo::matches<"a*{2,3}">(""sv));
+        STATIC_REQUIRE(dodo::matches<"(ab){1,2}{2}">("ababab"sv));
+        STATIC_REQUIRE(!dodo::matches<"(ab){1,2}{2}">("ab"sv));
+        CHECK(identifier(std::vector<std::string>{"a", "b_2"}));
+        CHECK(!identifier(std::vector<std::string>{"a", "2b"}));
+    }
+    SECTION("Options")
+    {
+        constexpr auto cli =
+            dodo_Opt(std::string, name)["--name"]
+                ("Name of the target.")
+                .check(dodo::matches<"[a-z][a-z0-9_]*">)
+            | dodo_Opt(std::vector<std::string>, tags)["--tags"]
+                ("Tags for the build.")
+                .check(dodo::matches<"\\w+">)
+                .by_default_range("debug"sv);
+
+        auto const options = tests::parse(cli, {"--name=dodo_2", "--tags=a b c"});
+        REQUIRE(options.has_value());
+        CHECK(options->name == "dodo_2");
+
+        auto const invalid = tests::parse(cli, {"--name=Dodo"});
+        REQUIRE(!invalid.has_value());
+        CHECK(invalid.error().find("Value must match the pattern [a-z][a-z0-9_]*.") != std::string::npos);
+
+        std::string const help = cli.to_string();
+        CHECK(help.find(
+            "Name of the target.\n"
+            "                                        Pattern: [a-z][a-z0-9_]*\n") != std::string::npos);
+    }
+}
+
+TEST_CASE("Benchmark regex validators", "[.][benchmark]")
+{
+    std::vector<std::string> inputs;
+    for (int i = 0; i < 1000; ++i)
+    {
+        inputs.push_back("v" + std::to_string(i % 10) + '.' + std::to_string(i) + '.' + std::to_string(i * 7 % 100));
+        inputs.push_back("target_name_" + std::to_string(i));
+        inputs.push_back(std::to_string(i) + "-invalid");
+    }
+
+    constexpr char const * pattern = "v?\\d+(\\.\\d+){1,2}|[a-z_][a-z0-9_]*";
+
+    BENCHMARK("std::regex, constructed once")
+    {
+        std::regex const regex(pattern);
+        size_t matched = 0;
+        for (std::string const & input : inputs)
+            matched += std::regex_match(input, regex);
+        return matched;
+    };
+
+    BENCHMARK("dodo::matches")
+    {
+        constexpr auto regex = dodo::matches<"v?\\d+(\\.\\d+){1,2}|[a-z_][a-z0-9_]*">;
+        size_t matched = 0;
+        for (std::string const & input : inputs)
+            matched += regex(input);
+        return matched;
+    };
+}
+
+TEST_CASE("Constraints relate options to each other")
+{
+    SECTION("Options")
+    {
+        constexpr auto cli = (
+            dodo_Opt(std::string, file)["--file"]("File to read.").by_default(""sv)
+            | dodo_Opt(std::string, url)["--url"]("URL to download.").by_default(""sv)
+            | dodo_Opt(std::string, tls_key)["--tls-key"]("Key for TLS.").by_default(""sv)
+            | dodo_Opt(std::string, tls_cert)["--tls-cert"]("Certificate for TLS.").by_default(""sv)
+            | dodo_Flag(fast)["--fast"]("Fast mode.")
+            | dodo_Flag(slow)["--slow"]("Slow mode.")
+            )
+            .exactly_one_of("--file", "--url")
+            .depends_on("--tls-key", "--tls-cert")
+            .at_most_one_of("--fast", "--slow");
+
+        STATIC_REQUIRE(dodo::Parser<decltype(cli)>);
+
+        auto const options = tests::parse(cli, {"--url=https://example.com", "--tls-key=k", "--tls-cert=c", "--fast"});
+        REQUIRE(options.has_value());
+        CHECK(options->url == "https://example.com");
+        CHECK(options->fast);
+
+        auto const none = tests::parse(cli, {"--fast"});
+        REQUIRE(!none.has_value());
+        CHECK(none.error() == "Exactly one of the options --file, --url must be given");
+
+        auto const both = tests::parse(cli, {"--file=a", "--url=b"});
+        REQUIRE(!both.has_value());
+        CHECK(both.error() == "Exactly one of the options --file, --url must be given");
+
+        auto const missing_dependency = tests::parse(cli, {"--file=a", "--tls-key=k"});
+        REQUIRE(!missing_dependency.has_value());
+        CHECK(missing_dependency.error() == "Option --tls-key requires --tls-cert");
+
+        CHECK(tests::parse(cli, {"--file=a", "--tls-cert=c"}).has_value());
+
+        auto const exclusive = tests::parse(cli, {"--file=a", "--fast", "--slow"});
+        REQUIRE(!exclusive.has_value());
+        CHECK(exclusive.error() == "At most one of the options --fast, --slow can be given");
+
+        std::string const help = cli.to_string();
+        CHECK(help.ends_with(
+            "Exactly one of the options --file, --url must be given\n"
+            "Option --tls-key requires --tls-cert\n"
+            "At most one of the options --fast, --slow can be given\n"));
+    }
+    SECTION("Parsers with positional arguments")
+    {
+        constexpr auto cli = (
+            dodo_Arg(std::string, input, "input")("Input file.")
+            | dodo_Opt(int, width)["--width"]("Width.").by_default(0)
+            | dodo_Opt(int, height)["--height"]("Height.").by_default(0)
+            )
+            .depends_on("--width", "--height");
+
+        CHECK(tests::parse(cli, {"a.png", "--width=1", "--height=2"}).has_value());
+        CHECK(tests::parse(cli, {"a.png"}).has_value());
+        CHECK(tests::parse(cli, {"a.png", "--height=2"}).has_value());
+        auto const result = tests::parse(cli, {"a.png", "--width=1"});
+        REQUIRE(!result.has_value());
+        CHECK(result.error() == "Option --width requires --height");
+        CHECK(cli.to_string().ends_with("Options:\n  --width <int>                         Width.\n                                        By default: 0\n"
+            "  --height <int>                        Height.\n                                        By default: 0\n  Option --width requires --height\n"));
+    }
+    SECTION("Contradictions are found when the parser is defined")
+    {
+        using dodo::constraint_kind;
+        using dodo::option_constraint;
+        constexpr auto contradiction = [](std::initializer_list<option_constraint> constraints, uint64_t required = 0)
+        {
+            return dodo::detail::find_constraint_contradiction(std::span(constraints.begin(), constraints.size()), required, 4) != nullptr;
+        };
+
+        STATIC_REQUIRE(!contradiction({{constraint_kind::exactly_one_of, 0b0011}, {constraint_kind::depends_on, 0b0100, 0b1000}}));
+        STATIC_REQUIRE(contradiction({{constraint_kind::at_most_one_of, 0b0001}}));
+        STATIC_REQUIRE(contradiction({{constraint_kind::depends_on, 0b0001, 0b0001}}));
+        STATIC_REQUIRE(contradiction({{constraint_kind::depends_on, 0b0001, 0b0010}, {constraint_kind::depends_on, 0b0010, 0b0100}, {constraint_kind::depends_on, 0b0100, 0b0001}}));
+        STATIC_REQUIRE(contradiction({{constraint_kind::depends_on, 0b0001, 0b0010}, {constraint_kind::depends_on, 0b0010, 0b0100}, {constraint_kind::at_most_one_of, 0b0101}}));
+        STATIC_REQUIRE(contradiction({{constraint_kind::exactly_one_of, 0b0011}}, 0b0011));
+        STATIC_REQUIRE(!contradiction({{constraint_kind::exactly_one_of, 0b0011}}, 0b0100));
+
+        // A required option may depend on one with a default value, which is then always given too.
+        STATIC_REQUIRE(!contradiction({{constraint_kind::depends_on, 0b0001, 0b0010}}, 0b0001));
+        STATIC_REQUIRE(contradiction({{constraint_kind::depends_on, 0b0001, 0b0010}, {constraint_kind::at_most_one_of, 0b0110}}, 0b0101));
+
+        struct Size
+        {
+            int width = 0;
+            int height = 0;
+        };
+        constexpr auto required_depends_on_optional =
+            (dodo::opt<&Size::width>["-w"] | dodo::opt<&Size::height>["-h"].by_default(0)).depends_on("-w", "-h");
+        STATIC_REQUIRE(required_depends_on_optional.parse(std::array{"-w=1"sv, "-h=2"sv})->height == 2);
+        CHECK(tests::parse(required_depends_on_optional, {"-w=1"}).error() == "Option -w requires -h");
+    }
+}
+
+TEST_CASE("Patterns are unique and well formed")
+{
+    STATIC_REQUIRE(dodo::detail::is_valid_pattern("--width"));
+    STATIC_REQUIRE(dodo::detail::is_valid_pattern("-w"));
+    STATIC_REQUIRE(!dodo::detail::is_valid_pattern("width"));
+    STATIC_REQUIRE(!dodo::detail::is_valid_pattern("-"));
+    STATIC_REQUIRE(!dodo::detail::is_valid_pattern("--"));
+    STATIC_REQUIRE(!dodo::detail::is_valid_pattern("--width="));
+    STATIC_REQUIRE(!dodo::detail::is_valid_pattern("--screen width"));
+
+    constexpr auto cli =
+        dodo_Opt(int, width)["--width"]["-w"]
+        | dodo_Opt(int, height)["--height"]["-h"];
+
+    std::vector<std::string_view> patterns;
+    cli.for_each_pattern([&patterns](std::string_view pattern) { patterns.push_back(pattern); });
+    CHECK(tests::are_equal<std::string_view>(patterns, {"--width", "-w", "--height", "-h"}));
+
+    auto const twice = tests::parse(cli, {"--width=1", "--height=2", "-w=3"});
+    REQUIRE(!twice.has_value());
+    CHECK(twice.error() == "Option --width, -w was given more than once");
+
+    constexpr auto commands = dodo::Command("build", "Build the project.", dodo_Opt(int, jobs)["--jobs"].by_default(1))
+        | dodo::Command("test", "Run the tests.", dodo_Opt(int, repeat)["--repeat"].by_default(1))
+        | tests::Help();
+    STATIC_REQUIRE(commands.count_commands_named("build") == 1);
+    STATIC_REQUIRE(commands.count_commands_named("--help") == 0); // Commands without a name member are not considered.
+
+    constexpr auto positional = dodo_Arg(int, width, "width")("Width of the screen in pixels.");
+    CHECK(positional.to_string() == "[width] <int>                           Width of the screen in pixels.\n");
+}
+
+TEST_CASE("Parsing in constant expressions")
+{
+    SECTION("Integers are parsed like std::from_chars")
+    {
+        STATIC_REQUIRE(dodo::detail::parse_integer<int>("123") == 123);
+        STATIC_REQUIRE(dodo::detail::parse_integer<int>("-2147483648") == std::numeric_limits<int>::min());
+        STATIC_REQUIRE(dodo::detail::parse_integer<int>("2147483647") == std::numeric_limits<int>::max());
+        STATIC_REQUIRE(dodo::detail::parse_integer<int>("2147483648") == std::nullopt);
+        STATIC_REQUIRE(dodo::detail::parse_integer<int16_t>("-32769") == std::nullopt);
+        STATIC_REQUIRE(dodo::detail::parse_integer<uint8_t>("255") == 255);
+        STATIC_REQUIRE(dodo::detail::parse_integer<uint8_t>("256") == std::nullopt);
+        STATIC_REQUIRE(dodo::detail::parse_integer<unsigned>("-1") == std::nullopt);
+        STATIC_REQUIRE(dodo::detail::parse_integer<int>("+1") == std::nullopt);
+        STATIC_REQUIRE(dodo::detail::parse_integer<int>("-") == std::nullopt);
+        STATIC_REQUIRE(dodo::detail::parse_integer<int>("12a") == std::nullopt);
+        STATIC_REQUIRE(dodo::detail::parse_integer<uint64_t>("18446744073709551615") == std::numeric_limits<uint64_t>::max());
+
+        for (std::string_view const text : {"0", "-0", "42", "-42", "99999999999", "x", "", "-2147483649"})
+            CHECK(dodo::parse_traits<int>::parse(text) == dodo::detail::parse_integer<int>(text));
+    }
+    SECTION("Parsers")
+    {
+        constexpr auto cli =
+            dodo_Arg(int, width, "width")("Width of the screen.")
+            | dodo_Opt(int, height)["--height"]("Height of the screen.").by_default(600).check(dodo::in_range(1, 4096))
+            | dodo_Flag(fullscreen)["--fullscreen"]("Start in fullscreen mode.")
+            | dodo_Opt(std::string_view, title)["--title"]("Title of the window.").by_default("dodo"sv);
+
+        constexpr std::array<std::string_view, 3> preset_args = {"800", "--fullscreen", "--title=preset"};
+        constexpr auto preset = cli.parse(preset_args);
+        STATIC_REQUIRE(preset.has_value());
+        STATIC_REQUIRE(preset->width == 800);
+        STATIC_REQUIRE(preset->height == 600);
+        STATIC_REQUIRE(preset->fullscreen);
+        STATIC_REQUIRE(preset->title == "preset");
+
+        STATIC_REQUIRE(tests::parse(cli, {"1024", "--height=768"})->height == 768);
+        STATIC_REQUIRE(tests::parse(cli, {"1024", "--height=4096"})->height == 4096);
+        CHECK(!tests::parse(cli, {"1024", "--height=0"}).has_value());
+        CHECK(tests::parse(cli, {"wide"}).error() == "Could not convert argument \"wide\" to type int");
+
+        constexpr auto constrained = (dodo_Opt(int, a)["--a"].by_default(0) | dodo_Opt(int, b)["--b"].by_default(0)).at_most_one_of("--a", "--b");
+        STATIC_REQUIRE(tests::parse(constrained, {"--b=2"})->b == 2);
+        CHECK(tests::parse(constrained, {"--a=1", "--b=2"}).error() == "At most one of the options --a, --b can be given");
+    }
+}
+
+namespace tests
+{
+    struct WindowConfig
+    {
+        std::string_view title;
+        int width = 0;
+        int height = 0;
+        bool fullscreen = false;
+        int monitor = 1;
+    };
+}
+
+TEST_CASE("Options bound to members of a struct")
+{
+    using tests::WindowConfig;
+
+    constexpr auto bound =
+        dodo::arg<&WindowConfig::title>("title")("Title of the window.")
+        | dodo::opt<&WindowConfig::width>["-w"]["--width"]("Width of the window.").check(dodo::in_range(1, 8192))
+        | dodo::opt<&WindowConfig::height>["--height"]("Height of the window.").by_default(600)
+        | dodo::flag<&WindowConfig::fullscreen>["--fullscreen"]("Start in fullscreen mode.");
+
+    constexpr auto declared =
+        dodo_Arg(std::string_view, title, "title")("Title of the window.")
+        | dodo_Opt(int, width)["-w"]["--width"]("Width of the window.").check(dodo::in_range(1, 8192))
+        | dodo_Opt(int, height)["--height"]("Height of the window.").by_default(600)
+        | dodo_Flag(fullscreen)["--fullscreen"]("Start in fullscreen mode.");
+
+    STATIC_REQUIRE(std::is_same_v<dodo_parse_result_type(bound), WindowConfig>);
+    STATIC_REQUIRE(std::is_same_v<dodo_parse_result_type(dodo::opt<&WindowConfig::width>["-w"] | dodo::opt<&WindowConfig::height>["-h"]), WindowConfig>);
+    STATIC_REQUIRE(dodo::detail::type_name<int>() == "int");
+
+    SECTION("Parsing")
+    {
+        auto const config = tests::parse(bound, {"dodo", "--width=800", "--fullscreen"});
+        REQUIRE(config.has_value());
+        CHECK(config->title == "dodo");
+        CHECK(config->width == 800);
+        CHECK(config->height == 600);
+        CHECK(config->fullscreen);
+        CHECK(config->monitor == 1);
+
+        STATIC_REQUIRE(tests::parse(dodo::opt<&WindowConfig::width>["-w"] | dodo::opt<&WindowConfig::height>["-h"], {"-w=3", "-h=4"})->height == 4);
+    }
+    SECTION("Same behaviour as the options declared with macros")
+    {
+        CHECK(bound.to_string() == declared.to_string());
+
+        tests::check_same_results(bound, declared, {
+            {"dodo", "-w=1920", "--height=1080"},
+            {"dodo"},
+            {"dodo", "-w=wide"},
+            {"dodo", "-w=0"},
+            {"dodo", "-w=1", "--width=2"},
+            {"dodo", "extra", "-w=1"},
+            {"dodo", "-w=1", "--depth=2"}},
+            [](auto const & a, auto const & b) { return a.width == b.width && a.height == b.height && a.fullscreen == b.fullscreen; });
+    }
+    SECTION("Realtime parsing")
+    {
+        static_assert(dodo::RealtimeParser<std::remove_cvref_t<decltype(dodo::opt<&WindowConfig::width>["-w"] | dodo::flag<&WindowConfig::fullscreen>["-f"])>>);
+
+        std::array<std::string_view, 2> const args = {"-f", "-w=10"};
+        auto const config = dodo::parse_realtime<dodo::realtime_limits<2, 8>>(dodo::opt<&WindowConfig::width>["-w"] | dodo::flag<&WindowConfig::fullscreen>["-f"], args);
+        REQUIRE(config.has_value());
+        CHECK(config->width == 10);
+        CHECK(config->fullscreen);
+    }
+    SECTION("A single bound option returns its class only in a compound")
+    {
+        constexpr auto single = dodo::opt<&WindowConfig::width>["-w"];
+        STATIC_REQUIRE(std::is_same_v<dodo_parse_result_type(single), dodo::detail::member_value<&WindowConfig::width>>);
+        STATIC_REQUIRE(tests::parse(single, {"-w=3"})->value == 3);
+
+        constexpr auto wrapped = dodo::CompoundOption(single);
+        STATIC_REQUIRE(std::is_same_v<dodo_parse_result_type(wrapped), WindowConfig>);
+        STATIC_REQUIRE(std::is_same_v<dodo_parse_result_type(dodo::Command("resize", "Resize the window.", wrapped)), WindowConfig>);
+        STATIC_REQUIRE(tests::parse(wrapped, {"-w=3"})->width == 3);
+
+        constexpr auto title_only = dodo::CompoundArgument(dodo::arg<&WindowConfig::title>("title"));
+        STATIC_REQUIRE(std::is_same_v<dodo_parse_result_type(title_only), WindowConfig>);
+        CHECK(tests::parse(title_only, {"dodo"})->title == "dodo");
+    }
+}
+
+TEST_CASE("Benchmark options bound to members", "[.][benchmark]")
+{
+    constexpr auto bound =
+        dodo::opt<&tests::WindowConfig::width>["-w"]["--width"]
+        | dodo::opt<&tests::WindowConfig::height>["--height"].by_default(600)
+        | dodo::flag<&tests::WindowConfig::fullscreen>["--fullscreen"];
+
+    constexpr auto declared =
+        dodo_Opt(int, width)["-w"]["--width"]
+        | dodo_Opt(int, height)["--height"].by_default(600)
+        | dodo_Flag(fullscreen)["--fullscreen"];
+
+    std::array<std::string_view, 3> const args = {"--fullscreen", "--height=1080", "-w=1920"};
+
+    BENCHMARK("dodo_Opt")
+    {
+        return declared.parse(args)->width;
+    };
+
+    BENCHMARK("dodo::opt")
+    {
+        return bound.parse(args)->width;
+    };
+}
+
+TEST_CASE("Parsers declared with template arguments are empty")
+{
+    using tests::WindowConfig;
+
+    constexpr auto static_cli =
+        dodo::arg<&WindowConfig::title, "title">().describe<"Title of the window.">()
+        | dodo::opt<&WindowConfig::width>.pattern<"-w">().pattern<"--width">().describe<"Width of the window.">()
+        | dodo::opt<&WindowConfig::height>.pattern<"--height">().describe<"Height of the window.">().hint<"pixels">();
+
+    constexpr auto runtime_cli =
+        dodo::arg<&WindowConfig::title>("title")("Title of the window.")
+        | dodo::opt<&WindowConfig::width>["-w"]["--width"]("Width of the window.")
+        | dodo::opt<&WindowConfig::height>["--height"]("Height of the window.").hint("pixels");
+
+    STATIC_REQUIRE(std::is_empty_v<std::remove_cvref_t<decltype(static_cli)>>);
+    STATIC_REQUIRE(std::is_empty_v<std::remove_cvref_t<decltype(dodo::opt<&WindowConfig::width>.pattern<"-w">())>>);
+    STATIC_REQUIRE(sizeof(runtime_cli) > sizeof(static_cli));
+    STATIC_REQUIRE(std::is_same_v<dodo_parse_result_type(static_cli), WindowConfig>);
+
+    CHECK(static_cli.to_string() == runtime_cli.to_string());
+
+    STATIC_REQUIRE(tests::parse(static_cli, {"dodo", "--width=800", "--height=600"})->width == 800);
+    STATIC_REQUIRE(tests::parse(static_cli, {"dodo", "-w=800", "--height=600"})->height == 600);
+
+    tests::check_same_results(static_cli, runtime_cli, {
+        {"dodo", "-w=1", "--height=2"},
+        {"dodo", "--widt=1", "--height=2"},
+        {"dodo", "--width1", "--height=2"},
+        {"dodo", "-w", "--height=2"},
+        {"dodo", "-w=1", "--width=2", "--height=2"},
+        {"dodo", "--height=2"}},
+        [](WindowConfig const & a, WindowConfig const & b) { return a.width == b.width && a.height == b.height; });
+}
+
+TEST_CASE("Benchmark patterns given as template arguments", "[.][benchmark]")
+{
+    using tests::WindowConfig;
+
+    constexpr auto static_cli =
+        dodo::opt<&WindowConfig::width>.pattern<"-w">().pattern<"--width">()
+        | dodo::opt<&WindowConfig::height>.pattern<"-h">().pattern<"--height">()
+        | dodo::opt<&WindowConfig::monitor>.pattern<"-m">().pattern<"--monitor">();
+
+    constexpr auto runtime_cli =
+        dodo::opt<&WindowConfig::width>["-w"]["--width"]
+        | dodo::opt<&WindowConfig::height>["-h"]["--height"]
+        | dodo::opt<&WindowConfig::monitor>["-m"]["--monitor"];
+
+    std::array<std::string_view, 3> const args = {"--monitor=2", "--height=1080", "--width=1920"};
+
+    BENCHMARK("Patterns stored in the parser")
+    {
+        return runtime_cli.parse(args)->width;
+    };
+
+    BENCHMARK("Patterns given as template arguments")
+    {
+        return static_cli.parse(args)->width;
+    };
+}
+
+TEST_CASE("Compact parsers parse like the parser they are made from")
+{
+    using tests::Platform;
+    using platform_list = std::vector<Platform>;
+
+    constexpr auto cli =
+        dodo_Opt(int, width)["-w"]["--width"]("Width of the window.").check(dodo::in_range(1, 8192))
+        | dodo_Opt(int, height)["--height"]("Height of the window.").by_default(600)
+        | dodo_Flag(fullscreen)["--fullscreen"]("Start in fullscreen mode.")
+        | dodo_Opt(Platform, platform)["--platform"]("Platform to run on.").by_default(Platform::windows)
+        | dodo_Opt(platform_list, targets)["--targets"]("Platforms for which to build.").by_default_range(Platform::ps4)
+        | dodo_Opt(std::string, title)["--title"]("Title of the window.").by_default(""sv);
+
+    auto const compact_cli = dodo::compact(cli);
+    STATIC_REQUIRE(dodo::Parser<decltype(compact_cli)>);
+
+    CHECK(compact_cli.to_string() == cli.to_string());
+    CHECK(compact_cli.to_string(4) == cli.to_string(4));
+
+    tests::check_same_results(compact_cli, cli, {
+        {"-w=1920", "--height=1080", "--fullscreen", "--platform=linux", "--targets=ps4 switch", "--title=dodo"},
+        {"--width=800"},
+        {"--fullscreen=false", "-w=1"},
+        {},
+        {"-w=wide"},
+        {"-w=0"},
+        {"-w=0", "--height=tall"},
+        {"--height=tall", "-w=0"},
+        {"-w=1", "--width=2"},
+        {"-w=1", "--depth=2"},
+        {"-w=1", "--platform=amiga"},
+        {"--height=1", "--fullscreen=maybe"}},
+        [](auto const & compact, auto const & expected)
+        {
+            return compact.width == expected.width && compact.height == expected.height && compact.fullscreen == expected.fullscreen
+                && compact.platform == expected.platform && compact.targets == expected.targets && compact.title == expected.title;
+        });
+
+    SECTION("Options bound to members")
+    {
+        using tests::WindowConfig;
+
+        constexpr auto bound = dodo::opt<&WindowConfig::width>.pattern<"-w">() | dodo::flag<&WindowConfig::fullscreen>["-f"];
+        auto const config = dodo::compact(bound).parse(std::array<std::string_view, 2>{"-f", "-w=3"});
+        REQUIRE(config.has_value());
+        CHECK(config->width == 3);
+        CHECK(config->fullscreen);
+        CHECK(config->monitor == 1);
+    }
+}
+
+TEST_CASE("Benchmark compact parsers", "[.][benchmark]")
+{
+    using tests::WindowConfig;
+
+    constexpr auto cli =
+        dodo::opt<&WindowConfig::width>["-w"]["--width"]
+        | dodo::opt<&WindowConfig::height>["-h"]["--height"]
+        | dodo::opt<&WindowConfig::monitor>["-m"]["--monitor"].by_default(1)
+        | dodo::flag<&WindowConfig::fullscreen>["--fullscreen"];
+
+    auto const compact_cli = dodo::compact(cli);
+
+    std::array<std::string_view, 3> const args = {"--monitor=2", "--height=1080", "--width=1920"};
+
+    BENCHMARK("Parser")
+    {
+        return cli.parse(args)->width;
+    };
+
+    BENCHMARK("Compact parser")
+    {
+        return compact_cli.parse(args)->width;
+    };
+}
+
+TEST_CASE("Type erased parsers and commands")
+{
+    using tests::WindowConfig;
+
+    constexpr auto window_cli = dodo::opt<&WindowConfig::width>["-w"]("Width of the window.") | dodo::flag<&WindowConfig::fullscreen>["-f"]("Fullscreen.");
+    constexpr auto url_cli = dodo_Opt(std::string, url)["--url"]("Url to fetch") | dodo_Opt(int, max_attempts)["--max-attempts"]("Maximum number of attempts").by_default(3);
+
+    SECTION("AnyParser parses like the parser it holds")
+    {
+        dodo::AnyParser const parser = window_cli;
+        STATIC_REQUIRE(dodo::Parser<dodo::AnyParser>);
+
+        auto const result = tests::parse(parser, {"-f", "-w=800"});
+        REQUIRE(result.has_value());
+        CHECK(std::any_cast<WindowConfig const &>(*result).width == 800);
+        CHECK(std::any_cast<WindowConfig const &>(*result).fullscreen);
+        CHECK(tests::parse(parser, {"-w=wide"}).error() == tests::parse(window_cli, {"-w=wide"}).error());
+        CHECK(parser.to_string() == window_cli.to_string());
+    }
+    SECTION("Parsers whose options have no description can be erased, and have no help text")
+    {
+        constexpr auto undescribed = dodo::opt<&WindowConfig::width>["-w"] | dodo::opt<&WindowConfig::height>["-h"];
+        STATIC_REQUIRE(!dodo::HasHelpText<std::remove_cvref_t<decltype(undescribed)>>);
+        STATIC_REQUIRE(!dodo::HasHelpText<std::remove_cvref_t<decltype(dodo::arg<&WindowConfig::title>("title") | undescribed)>>);
+
+        dodo::AnyParser const parser = undescribed;
+        auto const result = tests::parse(parser, {"-h=600", "-w=800"});
+        REQUIRE(result.has_value());
+        CHECK(std::any_cast<WindowConfig const &>(*result).height == 600);
+        CHECK(parser.to_string().empty());
+    }
+    SECTION("Parsers bigger than the inline buffer are stored on the heap, and copies and moves keep them")
+    {
+        STATIC_REQUIRE(sizeof(url_cli) > dodo::detail::erased_storage::buffer_size);
+
+        dodo::AnyParser parser = url_cli;
+        dodo::AnyParser copy = parser;
+        dodo::AnyParser const moved = std::move(parser);
+        parser = copy;
+
+        for (dodo::AnyParser const * p : std::initializer_list<dodo::AnyParser const *>{&parser, &copy, &moved})
+        {
+            auto const result = tests::parse(*p, {"--url=www.example.com"});
+            REQUIRE(result.has_value());
+            CHECK(std::any_cast<dodo_parse_result_type(url_cli) const &>(*result).url == "www.example.com");
+            CHECK(std::any_cast<dodo_parse_result_type(url_cli) const &>(*result).max_attempts == 3);
+        }
+    }
+    SECTION("CommandRegistry finds commands by name")
+    {
+        dodo::CommandRegistry registry;
+        auto const parse = [&registry](std::initializer_list<std::string_view> args) { return registry.parse(std::span<std::string_view const>(args)); };
+        REQUIRE(registry.add(dodo::Command("open-window", "Open a window.", window_cli)));
+        REQUIRE(registry.add(dodo::Command("fetch-url", "Fetch a URL.", url_cli)));
+        CHECK(registry.size() == 2);
+
+        CHECK(registry.add(dodo::Command("open-window", "Open another window.", window_cli)).error() == "Command \"open-window\" is already registered");
+        CHECK(!registry.add(dodo::Command("", "Nameless.", window_cli)));
+
+        auto const window = parse({"open-window", "-w=1920"});
+        REQUIRE(window.has_value());
+        CHECK(std::any_cast<WindowConfig const &>(*window).width == 1920);
+
+        auto const url = parse({"fetch-url", "--url=dodo"});
+        REQUIRE(url.has_value());
+        CHECK(std::any_cast<dodo_parse_result_type(url_cli) const &>(*url).url == "dodo");
+
+        CHECK(parse({"commit"}).error() == "Unrecognized command \"commit\"");
+        CHECK(registry.to_string() == dodo::Command("fetch-url", "Fetch a URL.", url_cli).to_string(0) + dodo::Command("open-window", "Open a window.", window_cli).to_string(0));
+
+        CHECK(registry.remove("fetch-url"));
+        CHECK(!registry.remove("fetch-url"));
+        CHECK(parse({"fetch-url", "--url=dodo"}).error() == "Unrecognized command \"fetch-url\"");
+    }
+    SECTION("A registry can be one more command of a command selector")
+    {
+        dodo::CommandRegistry registry;
+        REQUIRE(registry.add(dodo::Command("fetch-url", "Fetch a URL.", url_cli)));
+
+        auto const cli = dodo::Command("open-window", "Open a window.", window_cli) | dodo::RegisteredCommands(registry);
+
+        auto const window = tests::parse(cli, {"open-window", "-w=3"});
+        REQUIRE(window.has_value());
+        CHECK(std::get<0>(*window).width == 3);
+
+        auto const url = tests::parse(cli, {"fetch-url", "--url=dodo"});
+        REQUIRE(url.has_value());
+        REQUIRE(url->index() == 1);
+        CHECK(std::any_cast<dodo_parse_result_type(url_cli) const &>(std::get<1>(*url)).url == "dodo");
+
+        CHECK(tests::parse(cli, {"commit"}).error() == "Unrecognized command \"commit\"");
+    }
+}
+
+TEST_CASE("Reloadable configuration files")
+{
+    namespace fs = std::filesystem;
+    using tests::WindowConfig;
+
+    fs::path const directory = fs::temp_directory_path() / "dodo_reloadable_config_test";
+    fs::remove_all(directory);
+    fs::create_directories(directory);
+    fs::path const path = directory / "window.conf";
+
+    constexpr auto cli =
+        dodo::opt<&WindowConfig::width>["--width"]
+        | dodo::opt<&WindowConfig::height>["--height"].by_default(600)
+        | dodo::opt<&WindowConfig::title>["--title"].by_default(""sv);
+
+    dodo::ReloadableConfig config(cli, path);
+    CHECK(!config.current());
+    CHECK(config.reload().error() == "Could not open config file \"" + path.string() + '"');
+
+    std::ofstream(path) << "# Window\n--width=800\n  # Title\n--title='Main window'\n";
+    REQUIRE(config.reload());
+
+    auto const first = config.current();
+    REQUIRE(first);
+    CHECK(first->width == 800);
+    CHECK(first->height == 600);
+    CHECK(first->title == "Main window");
+
+    SECTION("A new snapshot is published and old ones stay valid")
+    {
+        std::ofstream(path) << "--width=1024 --height=768 --title=Other";
+        REQUIRE(config.reload());
+
+        auto second = config.current();
+        CHECK(second->width == 1024);
+        CHECK(second->title == "Other");
+        CHECK(first->width == 800);
+        CHECK(first->title == "Main window");
+
+        auto const copy = second;
+        second = config.current();
+        CHECK(copy->height == 768);
+    }
+    SECTION("Failed reloads keep the old snapshot")
+    {
+        std::ofstream(path) << "--width=wide";
+        CHECK(config.reload().error() == "Could not reload config file \"" + path.string() + "\":\n\tCould not convert argument \"wide\" to type int");
+        CHECK(config.current()->width == 800);
+    }
+    SECTION("Snapshots are shared between threads")
+    {
+        std::ofstream(path) << "--width=0 --height=1";
+        REQUIRE(config.reload());
+
+        std::atomic<bool> done = false;
+        std::vector<std::thread> readers;
+        std::atomic<int> wrong_reads = 0;
+        for (int i = 0; i < 4; ++i)
+            readers.emplace_back([&]()
+            {
+                while (!done)
+                {
+                    auto const snapshot = config.current();
+                    if (snapshot->height != snapshot->width + 1)
+                        ++wrong_reads;
+                }
+            });
+
+        for (int i = 0; i < 200; ++i)
+        {
+            std::ofstream(path) << "--width=" << i << " --height=" << i + 1;
+            CHECK(config.reload());
+        }
+        done = true;
+        for (std::thread & reader : readers)
+            reader.join();
+        CHECK(wrong_reads == 0);
+    }
+}
+
+namespace tests
+{
+    struct ViewsConfig
+    {
+        std::array<std::string_view, 2> names;
+        std::array<int, 2> size;
+    };
+}
+
+TEST_CASE("Differences and content hashes of parse results")
+{
+    SECTION("Options bound to members")
+    {
+        using tests::WindowConfig;
+
+        constexpr auto cli =
+            dodo::arg<&WindowConfig::title>("title")
+            | dodo::opt<&WindowConfig::width>["-w"]
+            | dodo::opt<&WindowConfig::height>["-h"]
+            | dodo::flag<&WindowConfig::fullscreen>["-f"];
+
+        STATIC_REQUIRE(dodo::field_count<std::remove_cvref_t<decltype(cli)>> == 4);
+        STATIC_REQUIRE(dodo::field_index(cli, "title") == 0);
+        STATIC_REQUIRE(dodo::field_index(cli, "-h") == 2);
+        STATIC_REQUIRE(dodo::field_index(cli, "-f") == 3);
+        STATIC_REQUIRE(dodo::field_index(dodo::opt<&WindowConfig::width>["-w"]["--width"] | dodo::opt<&WindowConfig::height>["-h"], "--width") == 0);
+        STATIC_REQUIRE(dodo::field_index(dodo::arg<&WindowConfig::title>("title") | dodo::arg<&WindowConfig::width>("width"), "width") == 1);
+        STATIC_REQUIRE(dodo::field_index(cli.depends_on("-f", "-w"), "-h") == 2);
+
+        std::string const title = "Main window";
+        WindowConfig const a = {"Main window", 800, 600, false, 1};
+        WindowConfig const b = {title, 800, 768, true, 2};
+
+        auto const changed = dodo::diff(cli, a, b);
+        CHECK(changed.count() == 2);
+        CHECK(changed[dodo::field_index(cli, "-h")]);
+        CHECK(changed[dodo::field_index(cli, "-f")]);
+        CHECK(!changed[dodo::field_index(cli, "title")]);
+
+        CHECK(dodo::equal(cli, a, a));
+        CHECK(!dodo::equal(cli, a, b));
+
+        // The hash only depends on the values of the fields of the parser.
+        CHECK(dodo::content_hash(cli, a) == dodo::content_hash(cli, WindowConfig{title, 800, 600, false, 3}));
+        CHECK(dodo::content_hash(cli, a) != dodo::content_hash(cli, b));
+    }
+    SECTION("Options declared with dodo_Opt")
+    {
+        constexpr auto cli =
+            dodo_Opt(std::vector<int>, sizes)["--sizes"].by_default_range(1, 2)
+            | dodo_Opt(float, scale)["--scale"].by_default(1.0f)
+            | dodo_Opt(std::string, name)["--name"].by_default(""sv);
+
+        auto const a = tests::parse(cli, {"--sizes=1 2 3", "--scale=0"});
+        auto const b = tests::parse(cli, {"--sizes=1 2 3", "--scale=-0", "--name=x"});
+        REQUIRE(a.has_value());
+        REQUIRE(b.has_value());
+
+        auto const changed = dodo::diff(cli, *a, *b);
+        CHECK(changed.count() == 1);
+        CHECK(changed[dodo::field_index(cli, "--name")]);
+
+        CHECK(dodo::content_hash(cli, *a) == dodo::content_hash(cli, *tests::parse(cli, {"--scale=-0", "--sizes=1 2 3"})));
+        CHECK(dodo::content_hash(cli, *a) != dodo::content_hash(cli, *b));
+    }
+    SECTION("Arrays of views are compared by the values they point to")
+    {
+        using tests::ViewsConfig;
+        constexpr auto cli = dodo::opt<&ViewsConfig::names>["--names"] | dodo::opt<&ViewsConfig::size>["--size"];
+
+        std::string const first_arguments[] = {"--names=first second", "--size=3 4"};
+        std::string const second_arguments[] = {"--names=first second", "--size=3 4"};
+        auto const a = tests::parse(cli, {first_arguments[0], first_arguments[1]});
+        auto const b = tests::parse(cli, {second_arguments[0], second_arguments[1]});
+        REQUIRE(a.has_value());
+        REQUIRE(b.has_value());
+        REQUIRE(a->names[0].data() != b->names[0].data());
+
+        CHECK(dodo::diff(cli, *a, *b).none());
+        CHECK(dodo::equal(cli, *a, *b));
+        CHECK(dodo::content_hash(cli, *a) == dodo::content_hash(cli, *b));
+
+        auto const c = tests::parse(cli, {"--names=first third", "--size=3 4"});
+        REQUIRE(c.has_value());
+        CHECK(dodo::diff(cli, *a, *c).to_string() == "01");
+        CHECK(dodo::content_hash(cli, *a) != dodo::content_hash(cli, *c));
+    }
+}
+
+namespace tests
+{
+    struct ServerConfig
+    {
+        int port = 0;
+        std::string name;
+        std::vector<int> worker_cpus;
+        std::vector<std::string> hosts;
+        double timeout = 0.0;
+    };
+}
+
+TEST_CASE("Parse results shared between processes")
+{
+    using tests::ServerConfig;
+
+    constexpr auto cli =
+        dodo::opt<&ServerConfig::port>["--port"]
+        | dodo::opt<&ServerConfig::name>["--name"]
+        | dodo::opt<&ServerConfig::worker_cpus>["--worker-cpus"]
+        | dodo::opt<&ServerConfig::hosts>["--hosts"]
+        | dodo::opt<&ServerConfig::timeout>["--timeout"];
+
+    auto const config = tests::parse(cli, {"--port=8080", "--name=front", "--worker-cpus=0 2 4", "--hosts=alpha beta gamma", "--timeout=2.5"});
+    REQUIRE(config.has_value());
+
+    auto const check_view = [](dodo::SharedConfigView<std::remove_cvref_t<decltype(cli)>> const & view)
+    {
+        STATIC_REQUIRE(std::is_same_v<decltype(view.get<&ServerConfig::port>()), int const &>);
+        STATIC_REQUIRE(std::is_same_v<decltype(view.get<&ServerConfig::name>()), std::string_view>);
+        STATIC_REQUIRE(std::is_same_v<decltype(view.get<&ServerConfig::worker_cpus>()), std::span<int const>>);
+        STATIC_REQUIRE(std::is_same_v<decltype(view.get<&ServerConfig::hosts>()), dodo::shared_string_list>);
+
+        CHECK(view.get<&ServerConfig::port>() == 8080);
+        CHECK(view.get<&ServerConfig::name>() == "front");
+        CHECK(std::ranges::equal(view.get<&ServerConfig::worker_cpus>(), std::array{0, 2, 4}));
+        CHECK(std::ranges::equal(view.get<&ServerConfig::hosts>(), std::array{"alpha"sv, "beta"sv, "gamma"sv}));
+        CHECK(view.get<&ServerConfig::hosts>()[1] == "beta");
+        CHECK(view.get<&ServerConfig::timeout>() == 2.5);
+    };
+
+    SECTION("Writing to and reading from memory")
+    {
+        std::vector<uint64_t> memory((dodo::shared_size(cli, *config) + 7) / 8);
+        auto const block = std::as_writable_bytes(std::span(memory));
+        dodo::write_shared(cli, *config, block);
+
+        auto const view = dodo::view_shared(cli, block);
+        REQUIRE(view.has_value());
+        check_view(*view);
+        CHECK(view->get<dodo::field_index(cli, "--name")>() == "front");
+
+        CHECK(dodo::view_shared(cli, block.first(16)).error() == "Shared configuration is too small");
+        CHECK(dodo::view_shared(cli, block.first(40)).error() == "Shared configuration is truncated");
+
+        // Blocks whose fields point outside of them are rejected, whatever the offsets.
+        auto const with_offset = [&](size_t field, uint64_t offset)
+        {
+            std::vector<uint64_t> corrupt = memory;
+            corrupt[4 + field] = offset;
+            return dodo::view_shared(cli, std::as_bytes(std::span(corrupt)));
+        };
+        for (uint64_t const offset : {uint64_t(block.size()), uint64_t(block.size() - 2), uint64_t(-8), uint64_t(1)})
+            for (size_t field = 0; field < 5; ++field)
+                CHECK(with_offset(field, offset).error() == "Shared configuration has fields outside of it");
+
+        std::vector<uint64_t> no_room_for_offsets = memory;
+        no_room_for_offsets[2] = 32 + 4 * 8;
+        CHECK(dodo::view_shared(cli, std::as_bytes(std::span(no_room_for_offsets))).error() == "Shared configuration has fields outside of it");
+
+        // The size of the list of hosts is the first word of the array that the field of the hosts points to.
+        std::vector<uint64_t> long_list = memory;
+        long_list[long_list[4 + 3] / 8] = uint64_t(1) << 60;
+        CHECK(dodo::view_shared(cli, std::as_bytes(std::span(long_list))).error() == "Shared configuration has fields outside of it");
+
+        // Entries of lists are checked when they are read.
+        std::vector<uint64_t> bad_entry = memory;
+        uint64_t const entries = bad_entry[bad_entry[4 + 3] / 8 + 1];
+        bad_entry[entries / 8 + 1] = uint64_t(-1);
+        auto const view_with_bad_entry = dodo::view_shared(cli, std::as_bytes(std::span(bad_entry)));
+        REQUIRE(view_with_bad_entry.has_value());
+        CHECK(view_with_bad_entry->get<&ServerConfig::hosts>()[0].empty());
+        CHECK(view_with_bad_entry->get<&ServerConfig::hosts>()[1] == "beta");
+
+        constexpr auto other_cli = dodo::opt<&ServerConfig::name>["--name"] | dodo::opt<&ServerConfig::port>["--port"];
+        CHECK(dodo::view_shared(other_cli, block).error() == "Shared configuration was written by a different parser");
+    }
+    SECTION("Arrays of views are copied into the block")
+    {
+        using tests::ViewsConfig;
+        constexpr auto views_cli = dodo::opt<&ViewsConfig::names>["--names"] | dodo::opt<&ViewsConfig::size>["--size"];
+
+        std::string arguments[] = {"--names=first second", "--size=3 4"};
+        auto const views_config = tests::parse(views_cli, {arguments[0], arguments[1]});
+        REQUIRE(views_config.has_value());
+
+        std::vector<uint64_t> memory((dodo::shared_size(views_cli, *views_config) + 7) / 8);
+        auto const block = std::as_writable_bytes(std::span(memory));
+        dodo::write_shared(views_cli, *views_config, block);
+        arguments[0].assign(arguments[0].size(), 'x');
+
+        auto const view = dodo::view_shared(views_cli, block);
+        REQUIRE(view.has_value());
+        STATIC_REQUIRE(std::is_same_v<decltype(view->get<&ViewsConfig::names>()), dodo::shared_string_list>);
+        STATIC_REQUIRE(std::is_same_v<decltype(view->get<&ViewsConfig::size>()), std::span<int const>>);
+        CHECK(std::ranges::equal(view->get<&ViewsConfig::names>(), std::array{"first"sv, "second"sv}));
+        CHECK(std::ranges::equal(view->get<&ViewsConfig::size>(), std::array{3, 4}));
+        for (std::string_view const name : view->get<&ViewsConfig::names>())
+            CHECK((name.data() >= reinterpret_cast<char const *>(block.data()) && name.data() + name.size() <= reinterpret_cast<char const *>(block.data() + block.size())));
+    }
+#if defined(__linux__)
+    SECTION("Publishing to a memfd")
+    {
+        auto const shared = dodo::publish_shared(cli, *config);
+        REQUIRE(shared.has_value());
+        check_view(shared->view());
+
+        // The memfd is sealed.
+        CHECK(pwrite(shared->fd(), "x", 1, 0) == -1);
+
+        auto const opened = dodo::open_shared(cli, dup(shared->fd()));
+        REQUIRE(opened.has_value());
+        check_view(opened->view());
+    }
+#endif
+}
+
+TEST_CASE("Binary arguments")
+{
+    std::array const arguments = {"--name=\"quoted\" name"sv, ""sv, "with spaces"sv, "\0zero\0bytes\0"sv, "back\\slash"sv, "\xff\xfe"sv};
+
+    SECTION("Round trip through a buffer")
+    {
+        auto const block = dodo::to_binary_args(arguments);
+        REQUIRE(block.has_value());
+        CHECK(block->size() == dodo::binary_args_size(arguments));
+
+        auto const args = dodo::from_binary_args(*block);
+        REQUIRE(args.has_value());
+        REQUIRE(std::ranges::equal(*args, arguments));
+
+        // The arguments point into the block.
+        for (std::string_view const arg : *args)
+            CHECK((arg.data() >= block->data() && arg.data() + arg.size() <= block->data() + block->size()));
+    }
+
+    SECTION("No arguments")
+    {
+        auto const block = dodo::to_binary_args(std::span<std::string_view const>());
+        REQUIRE(block.has_value());
+        auto const args = dodo::from_binary_args(*block);
+        REQUIRE(args.has_value());
+        CHECK(args->empty());
+    }
+
+    SECTION("Invalid blocks")
+    {
+        std::string const block = *dodo::to_binary_args(arguments);
+        CHECK(dodo::from_binary_args("").error() == "Binary arguments have the wrong size");
+        CHECK(dodo::from_binary_args(std::string_view(block).substr(0, block.size() - 1)).error() == "Binary arguments have the wrong size");
+        CHECK(dodo::from_binary_args(block + 'x').error() == "Binary arguments have the wrong size");
+
+        // A block whose last argument claims to be longer than the block.
+        std::string too_long = block;
+        too_long[4 * (2 + arguments.size() - 1)] += 1;
+        CHECK(dodo::from_binary_args(too_long).error() == "Binary arguments are truncated");
+    }
+
+#if defined(__linux__)
+    SECTION("Round trip through a pipe")
+    {
+        int fds[2];
+        REQUIRE(pipe(fds) == 0);
+
+        // More arguments than fit in a single writev, and more bytes than fit in the pipe, so the reader must run at the same time.
+        std::vector<std::string> many_strings;
+        for (int i = 0; i < 5000; ++i)
+            many_strings.push_back("--argument-" + std::to_string(i) + "=\"" + std::string(i % 50, ' ') + '"');
+        std::vector<std::string_view> const many(many_strings.begin(), many_strings.end());
+
+        std::thread writer([&]()
+        {
+            CHECK(dodo::write_binary_args(fds[1], arguments).has_value());
+            CHECK(dodo::write_binary_args(fds[1], std::span<std::string_view const>(many)).has_value());
+            close(fds[1]);
+        });
+
+        std::string buffer;
+        auto const first = dodo::read_binary_args(fds[0], buffer);
+        REQUIRE(first.has_value());
+        CHECK(std::ranges::equal(*first, arguments));
+
+        auto const second = dodo::read_binary_args(fds[0], buffer);
+        REQUIRE(second.has_value());
+        CHECK(std::ranges::equal(*second, many));
+
+        CHECK(dodo::read_binary_args(fds[0], buffer).error() == "No binary arguments to read");
+
+        writer.join();
+        close(fds[0]);
+    }
+#endif
+}
+
+#if defined(__linux__)
+namespace tests
+{
+    struct ToolOptions
+    {
+        bool verbose = false;
+        std::string profile;
+    };
+
+    struct BuildCommand
+    {
+        int jobs = 0;
+        std::string target;
+    };
+
+    struct CleanCommand
+    {
+        bool all = false;
+        bool dry_run = false;
+    };
+
+    constexpr auto tool_cli =
+        dodo::SharedOptions(
+            dodo::flag<&ToolOptions::verbose>["--verbose"]("Print more.")
+            | dodo::opt<&ToolOptions::profile>["--profile"]("Build profile.").by_default("debug"))
+        | dodo::Command("build", "Build the project.",
+            dodo::opt<&BuildCommand::jobs>["--jobs"]("Number of jobs.").by_default(1)
+            | dodo::opt<&BuildCommand::target>["--target"]("Target to build.").by_default("all"))
+        | dodo::Command("clean", "Remove build files.",
+            dodo::flag<&CleanCommand::all>["--all"]("Remove everything.")
+            | dodo::flag<&CleanCommand::dry_run>["--dry-run"]("Print what would be removed."));
+
+    // Runs a daemon for the tool on a background thread while it exists.
+    struct ToolDaemon
+    {
+        ToolDaemon()
+        {
+            REQUIRE(server.listen(socket_path).has_value());
+            thread = std::jthread([this]() { server.run(); });
+        }
+
+        ~ToolDaemon()
+        {
+            server.stop();
+            thread.join();
+        }
+
+        static int handle(decltype(tool_cli)::parse_result_type const & args, dodo::DaemonRequest & request)
+        {
+            if (auto const build = std::get_if<BuildCommand>(&args.command))
+            {
+                request.out("Building with " + std::to_string(build->jobs) + " jobs in " + std::string(request.working_directory) + '\n');
+                if (args.shared_arguments.verbose)
+                    request.err("CC=" + std::string(request.environment_variable("CC").value_or("cc")) + '\n');
+                return 0;
+            }
+            request.err("Nothing to clean\n");
+            return 3;
+        }
+
+        std::filesystem::path socket_path = std::filesystem::temp_directory_path() / ("dodo-test-" + std::to_string(getpid()) + ".sock");
+        dodo::DaemonServer<std::remove_cvref_t<decltype(tool_cli)>, decltype(&handle)> server{tool_cli, &handle};
+        std::jthread thread;
+    };
+
+    // Output of a run of the tool forwarded to the daemon.
+    struct ForwardedRun
+    {
+        dodo::expected<int, dodo::forward_error> exit_code;
+        std::string out;
+        std::string err;
+    };
+
+    inline ForwardedRun forward(std::filesystem::path const & socket_path, std::vector<char const *> argv, std::vector<char const *> envp = {nullptr})
+    {
+        int out[2], err[2];
+        REQUIRE(pipe(out) == 0);
+        REQUIRE(pipe(err) == 0);
+        auto exit_code = dodo::forward_to_daemon(socket_path, static_cast<int>(argv.size()) - 1, argv.data(), envp.data(), out[1], err[1]);
+        close(out[1]);
+        close(err[1]);
+
+        auto const read_pipe = [](int fd)
+        {
+            std::string text;
+            char buffer[256];
+            for (ssize_t bytes; (bytes = read(fd, buffer, sizeof(buffer))) > 0; )
+                text.append(buffer, bytes);
+            close(fd);
+            return text;
+        };
+        return {std::move(exit_code), read_pipe(out[0]), read_pipe(err[0])};
+    }
+}
+
+TEST_CASE("Daemon mode")
+{
+    tests::ToolDaemon daemon;
+    std::string const working_directory = std::filesystem::current_path().string();
+
+    SECTION("The server parses and handles the command")
+    {
+        auto const run = tests::forward(daemon.socket_path, {"tool", "--verbose", "build", "--jobs=8", nullptr}, {"HOME=/home/user", "CC=clang", nullptr});
+        REQUIRE(run.exit_code.has_value());
+        CHECK(*run.exit_code == 0);
+        CHECK(run.out == "Building with 8 jobs in " + working_directory + '\n');
+        CHECK(run.err == "CC=clang\n");
+    }
+
+    SECTION("The exit code comes from the handler")
+    {
+        auto const run = tests::forward(daemon.socket_path, {"tool", "clean", nullptr});
+        REQUIRE(run.exit_code.has_value());
+        CHECK(*run.exit_code == 3);
+        CHECK(run.out.empty());
+        CHECK(run.err == "Nothing to clean\n");
+    }
+
+    SECTION("Parse errors are written to the standard error of the client")
+    {
+        auto const run = tests::forward(daemon.socket_path, {"tool", "build", "--jobs=many", nullptr});
+        REQUIRE(run.exit_code.has_value());
+        CHECK(*run.exit_code == 1);
+        CHECK(run.err == tests::tool_cli.parse(std::array{"build"sv, "--jobs=many"sv}).error() + '\n');
+    }
+
+    SECTION("Many clients at once")
+    {
+        std::vector<std::jthread> clients;
+        std::atomic<int> succeeded = 0;
+        for (int i = 0; i < 8; ++i)
+            clients.emplace_back([&, i]()
+            {
+                std::string const jobs = "--jobs=" + std::to_string(i);
+                std::array<char const *, 4> const argv = {"tool", "build", jobs.c_str(), nullptr};
+                std::array<char const *, 1> const envp = {nullptr};
+                int out[2];
+                if (pipe(out) != 0)
+                    return;
+                auto const exit_code = dodo::forward_to_daemon(daemon.socket_path, 3, argv.data(), envp.data(), out[1], out[1]);
+                close(out[1]);
+                char buffer[256];
+                ssize_t const bytes = read(out[0], buffer, sizeof(buffer));
+                close(out[0]);
+                if (exit_code && *exit_code == 0 && bytes > 0 && std::string_view(buffer, bytes).starts_with("Building with " + std::to_string(i) + " jobs"))
+                    ++succeeded;
+            });
+        clients.clear();
+        CHECK(succeeded == 8);
+    }
+
+    SECTION("Only one server can listen on a socket")
+    {
+        dodo::DaemonServer other(tests::tool_cli, &tests::ToolDaemon::handle);
+        CHECK(other.listen(daemon.socket_path).error() == "A daemon is already listening on \"" + daemon.socket_path.string() + '"');
+    }
+
+    SECTION("Clients fail when no server is listening")
+    {
+        auto const missing = daemon.socket_path.string() + ".missing";
+        std::array<char const *, 2> const argv = {"tool", nullptr};
+        auto const exit_code = dodo::forward_to_daemon(missing, 1, argv.data());
+        REQUIRE(!exit_code.has_value());
+        CHECK(!exit_code.error().connected);
+        CHECK(exit_code.error().message == "Could not connect to daemon at \"" + missing + '"');
+    }
+}
+
+TEST_CASE("Daemon mode failures")
+{
+    auto const socket_path = std::filesystem::temp_directory_path() / ("dodo-test-failures-" + std::to_string(getpid()) + ".sock");
+
+    SECTION("Exceptions thrown by the handler are written to the standard error of the client")
+    {
+        auto const throwing = [](auto const &, dodo::DaemonRequest &) -> int { throw std::runtime_error("Out of widgets"); };
+        dodo::DaemonServer server(tests::tool_cli, throwing);
+        REQUIRE(server.listen(socket_path).has_value());
+        std::jthread thread([&]() { server.run(); });
+
+        auto const run = tests::forward(socket_path, {"tool", "clean", nullptr});
+        server.stop();
+        REQUIRE(run.exit_code.has_value());
+        CHECK(*run.exit_code == 1);
+        CHECK(run.err == "The daemon failed to handle the command: Out of widgets\n");
+    }
+
+    SECTION("Requests over the size limit are dropped")
+    {
+        dodo::DaemonServer server(tests::tool_cli, &tests::ToolDaemon::handle, 64);
+        REQUIRE(server.listen(socket_path).has_value());
+        std::jthread thread([&]() { server.run(); });
+
+        auto const run = tests::forward(socket_path, {"tool", "build", "--target=a-target-whose-name-is-far-too-long-for-the-limit", nullptr});
+        server.stop();
+        REQUIRE(!run.exit_code.has_value());
+        CHECK(run.exit_code.error().connected);
+        CHECK(run.exit_code.error().message == "Daemon at \"" + socket_path.string() + "\" closed the connection before the command finished");
+    }
+
+    SECTION("Clients that send more than the size limit fail instead of being killed")
+    {
+        dodo::DaemonServer server(tests::tool_cli, &tests::ToolDaemon::handle, 64);
+        REQUIRE(server.listen(socket_path).has_value());
+        std::jthread thread([&]() { server.run(); });
+
+        // Bigger than the buffer of the socket, so the client is still sending when the server drops the connection.
+        std::string const variable = "BIG=" + std::string(8 * 1024 * 1024, 'x');
+        auto const run = tests::forward(socket_path, {"tool", "clean", nullptr}, {variable.c_str(), nullptr});
+        server.stop();
+        REQUIRE(!run.exit_code.has_value());
+        CHECK(run.exit_code.error().connected);
+    }
+
+    SECTION("Destroying the server does not wait for clients that send nothing")
+    {
+        std::optional<dodo::DaemonServer<std::remove_cvref_t<decltype(tests::tool_cli)>, decltype(&tests::ToolDaemon::handle)>> server;
+        server.emplace(tests::tool_cli, &tests::ToolDaemon::handle);
+        REQUIRE(server->listen(socket_path).has_value());
+        std::jthread thread([&]() { server->run(); });
+
+        int const silent = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        sockaddr_un address = {};
+        address.sun_family = AF_UNIX;
+        std::strcpy(address.sun_path, socket_path.c_str());
+        REQUIRE(connect(silent, reinterpret_cast<sockaddr const *>(&address), sizeof(address)) == 0);
+        // Connections are accepted in order, so the silent one has been accepted once a later request has finished.
+        auto const run = tests::forward(socket_path, {"tool", "clean", nullptr});
+        CHECK(run.exit_code.has_value());
+
+        server->stop();
+        thread.join();
+        server.reset();
+        char byte;
+        CHECK(read(silent, &byte, 1) == 0);
+        close(silent);
+    }
+}
+
+TEST_CASE("Benchmark daemon mode", "[.][benchmark]")
+{
+    tests::ToolDaemon daemon;
+    std::array<char const *, 5> const argv = {"tool", "--verbose", "build", "--jobs=8", nullptr};
+    std::array<char const *, 1> const envp = {nullptr};
+    int const null_fd = open("/dev/null", O_WRONLY | O_CLOEXEC);
+
+    BENCHMARK("Forward a command to the daemon")
+    {
+        return dodo::forward_to_daemon(daemon.socket_path, 4, argv.data(), envp.data(), null_fd, null_fd);
+    };
+
+    close(null_fd);
+}
+#endif // defined(__linux__)
@@ -0,0 +1,402 @@
+#pragma once
+
+#include "parse_traits.hh"
+#include <array>
+#include <cstdint>
+
+namespace dodo
+{
+
+	enum struct ip_family : uint8_t { v4, v6 };
+
+	// IPv4 or IPv6 address, stored in network byte order. IPv4 addresses use the first 4 bytes.
+	struct ip_address
+	{
+		ip_family family = ip_family::v4;
+		std::array<uint8_t, 16> bytes = {};
+
+		static constexpr ip_address v4(uint8_t a, uint8_t b, uint8_t c, uint8_t d) noexcept { return ip_address{ip_family::v4, {a, b, c, d}}; }
+		constexpr size_t size() const noexcept { return family == ip_family::v4 ? 4 : 16; }
+
+		constexpr bool operator == (ip_address const & other) const noexcept = default;
+	};
+
+	// Address and port, written as 10.0.0.1:7000 or [::1]:7000.
+	struct endpoint
+	{
+		ip_address address;
+		uint16_t port = 0;
+
+		constexpr bool operator == (endpoint const & other) const noexcept = default;
+	};
+
+	// Block of addresses, written as 10.0.0.0/8 or fe80::/10. Bits of the address after the prefix must be 0.
+	struct cidr_block
+	{
+		ip_address address;
+		uint8_t prefix_length = 0;
+
+		constexpr bool contains(ip_address const & ip) const noexcept
+		{
+			if (ip.family != address.family)
+				return false;
+
+			size_t const whole_bytes = prefix_length / 8;
+			for (size_t i = 0; i < whole_bytes; ++i)
+				if (ip.bytes[i] != address.bytes[i])
+					return false;
+
+			unsigned const remaining_bits = prefix_length % 8;
+			if (remaining_bits == 0)
+				return true;
+
+			auto const mask = static_cast<uint8_t>(0xFF << (8 - remaining_bits));
+			return (ip.bytes[whole_bytes] & mask) == address.bytes[whole_bytes];
+		}
+
+		constexpr bool operator == (cidr_block const & other) const noexcept = default;
+	};
+
+	namespace detail
+	{
+		// Parses a decimal number in [0, max] without leading zeros at the beginning of the text and removes it from the text.
+		constexpr std::optional<unsigned> parse_bounded_decimal(std::string_view & text, unsigned max) noexcept
+		{
+			size_t i = 0;
+			unsigned value = 0;
+			while (i < text.size() && text[i] >= '0' && text[i] <= '9')
+			{
+				value = value * 10 + unsigned(text[i] - '0');
+				if (value > max || (i == 1 && text[0] == '0'))
+					return std::nullopt;
+				++i;
+			}
+
+			if (i == 0)
+				return std::nullopt;
+
+			text.remove_prefix(i);
+			return value;
+		}
+
+		constexpr int hex_digit_value(char c) noexcept
+		{
+			if (c >= '0' && c <= '9') return c - '0';
+			if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+			if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+			return -1;
+		}
+
+		// Parses a dotted quad at the beginning of the text, writing it to out, and removes it from the text.
+		constexpr bool parse_ipv4(std::string_view & text, uint8_t * out) noexcept
+		{
+			for (int i = 0; i < 4; ++i)
+			{
+				if (i > 0)
+				{
+					if (!text.starts_with('.'))
+						return false;
+					text.remove_prefix(1);
+				}
+
+				std::optional<unsigned> const octet = parse_bounded_decimal(text, 255);
+				if (!octet)
+					return false;
+				out[i] = static_cast<uint8_t>(*octet);
+			}
+			return true;
+		}
+
+		// Parses the whole text as an IPv6 address as described in RFC 4291, including :: and a trailing dotted quad.
+		constexpr bool parse_ipv6(std::string_view text, std::array<uint8_t, 16> & out) noexcept
+		{
+			std::array<uint16_t, 8> groups = {};
+			int group_count = 0;
+			int compressed_at = -1;
+
+			if (text.starts_with("::"))
+			{
+				compressed_at = 0;
+				text.remove_prefix(2);
+			}
+
+			while (!text.empty())
+			{
+				if (group_count == 8)
+					return false;
+
+				// Trailing dotted quad, which takes the place of two groups.
+				if (text.find('.') != std::string_view::npos && text.find(':') == std::string_view::npos)
+				{
+					uint8_t quad[4] = {};
+					if (group_count > 6 || !parse_ipv4(text, quad) || !text.empty())
+						return false;
+					groups[static_cast<size_t>(group_count++)] = static_cast<uint16_t>(quad[0] << 8 | quad[1]);
+					groups[static_cast<size_t>(group_count++)] = static_cast<uint16_t>(quad[2] << 8 | quad[3]);
+					break;
+				}
+
+				unsigned group = 0;
+				size_t digits = 0;
+				while (digits < text.size() && digits < 5 && hex_digit_value(text[digits]) >= 0)
+					group = group * 16 + unsigned(hex_digit_value(text[digits++]));
+				if (digits == 0 || digits > 4)
+					return false;
+				groups[static_cast<size_t>(group_count++)] = static_cast<uint16_t>(group);
+				text.remove_prefix(digits);
+
+				if (text.starts_with("::"))
+				{
+					if (compressed_at >= 0)
+						return false;
+					compressed_at = group_count;
+					text.remove_prefix(2);
+				}
+				else if (text.starts_with(':'))
+				{
+					text.remove_prefix(1);
+					if (text.empty())
+						return false;
+				}
+				else if (!text.empty())
+					return false;
+			}
+
+			if (compressed_at < 0 ? group_count != 8 : group_count > 7)
+				return false;
+
+			// Move the groups after :: to the end.
+			if (compressed_at >= 0)
+			{
+				int const moved = group_count - compressed_at;
+				for (int i = 0; i < moved; ++i)
+				{
+					groups[static_cast<size_t>(7 - i)] = groups[static_cast<size_t>(group_count - 1 - i)];
+					groups[static_cast<size_t>(group_count - 1 - i)] = 0;
+				}
+			}
+
+			for (size_t i = 0; i < 8; ++i)
+			{
+				out[2 * i] = static_cast<uint8_t>(groups[i] >> 8);
+				out[2 * i + 1] = static_cast<uint8_t>(groups[i] & 0xFF);
+			}
+			return true;
+		}
+
+		inline void append_ipv4(std::string & out, uint8_t const * bytes)
+		{
+			for (int i = 0; i < 4; ++i)
+			{
+				if (i > 0)
+					out += '.';
+				out += std::to_string(bytes[i]);
+			}
+		}
+
+		// Canonical text representation of RFC 5952. Lowercase, no leading zeros, the longest run of two or more zero groups is replaced by ::
+		// and IPv4 mapped addresses end in a dotted quad.
+		inline void append_ipv6(std::string & out, std::array<uint8_t, 16> const & bytes)
+		{
+			constexpr char hex_digits[] = "0123456789abcdef";
+
+			std::array<unsigned, 8> groups = {};
+			for (size_t i = 0; i < 8; ++i)
+				groups[i] = unsigned(bytes[2 * i]) << 8 | bytes[2 * i + 1];
+
+			bool const ipv4_mapped = groups[0] == 0 && groups[1] == 0 && groups[2] == 0 && groups[3] == 0 && groups[4] == 0 && groups[5] == 0xFFFF;
+			size_t const group_count = ipv4_mapped ? 6 : 8;
+
+			size_t best_start = 0, best_length = 0;
+			for (size_t i = 0; i < group_count; )
+			{
+				size_t length = 0;
+				while (i + length < group_count && groups[i + length] == 0)
+					++length;
+				if (length > best_length)
+				{
+					best_start = i;
+					best_length = length;
+				}
+				i += length > 0 ? length : 1;
+			}
+			if (best_length < 2)
+				best_length = 0;
+
+			for (size_t i = 0; i < group_count; ++i)
+			{
+				if (best_length > 0 && i == best_start)
+				{
+					out += "::";
+					i += best_length - 1;
+					continue;
+				}
+
+				if (i > 0 && !(best_length > 0 && i == best_start + best_length))
+					out += ':';
+
+				bool leading = true;
+				for (int shift = 12; shift >= 0; shift -= 4)
+				{
+					unsigned const digit = (groups[i] >> shift) & 0xF;
+					if (digit == 0 && leading && shift > 0)
+						continue;
+					leading = false;
+					out += hex_digits[digit];
+				}
+			}
+
+			if (ipv4_mapped)
+			{
+				if (!(best_length > 0 && best_start + best_length == group_count))
+					out += ':';
+				append_ipv4(out, bytes.data() + 12);
+			}
+		}
+	} // namespace detail
+
+	template <>
+	struct parse_traits<ip_address>
+	{
+		static constexpr std::string_view hint = "ip";
+
+		static constexpr std::optional<ip_address> parse(std::string_view text) noexcept
+		{
+			ip_address address;
+
+			if (text.find(':') == std::string_view::npos)
+			{
+				address.family = ip_family::v4;
+				if (!detail::parse_ipv4(text, address.bytes.data()) || !text.empty())
+					return std::nullopt;
+			}
+			else
+			{
+				address.family = ip_family::v6;
+				if (!detail::parse_ipv6(text, address.bytes))
+					return std::nullopt;
+			}
+
+			return address;
+		}
+
+		static std::string to_string(ip_address const & address)
+		{
+			std::string result;
+			if (address.family == ip_family::v4)
+				detail::append_ipv4(result, address.bytes.data());
+			else
+				detail::append_ipv6(result, address.bytes);
+			return result;
+		}
+	};
+
+	template <>
+	struct parse_traits<endpoint>
+	{
+		static constexpr std::string_view hint = "ip:port";
+
+		static constexpr std::optional<endpoint> parse(std::string_view text) noexcept
+		{
+			std::string_view address_text;
+
+			if (text.starts_with('['))
+			{
+				size_t const closing = text.find(']');
+				if (closing == std::string_view::npos)
+					return std::nullopt;
+				address_text = text.substr(1, closing - 1);
+				text.remove_prefix(closing + 1);
+				if (address_text.find(':') == std::string_view::npos) // Brackets are only for IPv6.
+					return std::nullopt;
+			}
+			else
+			{
+				size_t const colon = text.find(':');
+				if (colon == std::string_view::npos)
+					return std::nullopt;
+				address_text = text.substr(0, colon);
+				text.remove_prefix(colon);
+			}
+
+			if (!text.starts_with(':'))
+				return std::nullopt;
+			text.remove_prefix(1);
+
+			std::optional<unsigned> const port = detail::parse_bounded_decimal(text, 65535);
+			if (!port || !text.empty())
+				return std::nullopt;
+
+			std::optional<ip_address> const address = parse_traits<ip_address>::parse(address_text);
+			if (!address)
+				return std::nullopt;
+
+			return endpoint{*address, static_cast<uint16_t>(*port)};
+		}
+
+		static std::string to_string(endpoint const & e)
+		{
+			std::string result;
+			if (e.address.family == ip_family::v6)
+				result += '[';
+			result += parse_traits<ip_address>::to_string(e.address);
+			if (e.address.family == ip_family::v6)
+				result += ']';
+			result += ':';
+			result += std::to_string(e.port);
+			return result;
+		}
+	};
+
+	template <>
+	struct parse_traits<cidr_block>
+	{
+		static constexpr std::string_view hint = "ip/prefix";
+
+		static constexpr std::optional<cidr_block> parse(std::string_view text) noexcept
+		{
+			size_t const slash = text.find('/');
+			if (slash == std::string_view::npos)
+				return std::nullopt;
+
+			std::optional<ip_address> const address = parse_traits<ip_address>::parse(text.substr(0, slash));
+			if (!address)
+				return std::nullopt;
+
+			std::string_view prefix_text = text.substr(slash + 1);
+			std::optional<unsigned> const prefix_length = detail::parse_bounded_decimal(prefix_text, unsigned(address->size() * 8));
+			if (!prefix_length || !prefix_text.empty())
+				return std::nullopt;
+
+			cidr_block const block{*address, static_cast<uint8_t>(*prefix_length)};
+
+			// Reject addresses with bits set after the prefix, which are most likely a mistake.
+			cidr_block const masked = [&block]()
+			{
+				cidr_block b = block;
+				for (size_t i = 0; i < b.address.bytes.size(); ++i)
+				{
+					size_t const bit = i * 8;
+					if (bit >= b.prefix_length)
+						b.address.bytes[i] = 0;
+					else if (b.prefix_length - bit < 8)
+						b.address.bytes[i] &= static_cast<uint8_t>(0xFF << (8 - (b.prefix_length - bit)));
+				}
+				return b;
+			}();
+			if (masked != block)
+				return std::nullopt;
+
+			return block;
+		}
+
+		static std::string to_string(cidr_block const & block)
+		{
+			std::string result = parse_traits<ip_address>::to_string(block.address);
+			result += '/';
+			result += std::to_string(block.prefix_length);
+			return result;
+		}
+	};
+
+} // namespace dodo
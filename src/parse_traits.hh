@@ -1,9 +1,14 @@
 #pragma once
 
 #include <string_view>
+#include <array>
+#include <cassert>
 #include <charconv>
+#include <concepts>
+#include <limits>
 #include <string>
 #include <optional>
+#include <span>
 #include <vector>
 
 namespace dodo
@@ -21,12 +26,67 @@ namespace dodo
 		return parse_traits<T>::to_string(t);
 	}
 
+	// Traits may give a hint to show in the help text instead of the name of the type.
+	template <typename T>
+	concept TraitHinted = requires { {parse_traits<T>::hint} -> std::convertible_to<std::string_view>; };
+
+	// Traits for types that can only take a closed set of values, which can be listed in the help text.
+	template <typename T>
+	concept TraitEnumerable = requires { {parse_traits<T>::value_names()} -> std::convertible_to<std::span<std::string_view const>>; };
+
+	// Traits may explain why a text could not be parsed. The explanation is added to the error message.
+	template <typename T>
+	concept TraitDiagnosed = requires(std::string_view text) { {parse_traits<T>::parse_error(text)} -> std::convertible_to<std::string>; };
+
+	namespace detail
+	{
+		// Not constexpr on purpose. Reaching it while evaluating a constant expression makes compilation fail on the line that calls it.
+		inline void definition_error([[maybe_unused]] char const * message) noexcept
+		{
+			assert(false && message);
+		}
+	} // namespace detail
+
+	namespace detail
+	{
+		// Same result as std::from_chars in base 10. Used in constant evaluation, where std::from_chars can not be called until C++23.
+		template <std::integral T>
+		constexpr std::optional<T> parse_integer(std::string_view text) noexcept
+		{
+			using U = std::make_unsigned_t<T>;
+
+			bool const negative = std::is_signed_v<T> && text.starts_with('-');
+			if (negative)
+				text.remove_prefix(1);
+			if (text.empty())
+				return std::nullopt;
+
+			U const max = negative ? U(U(std::numeric_limits<T>::max()) + 1) : U(std::numeric_limits<T>::max());
+			U value = 0;
+			for (char const c : text)
+			{
+				if (c < '0' || c > '9')
+					return std::nullopt;
+				U const digit = U(c - '0');
+				if (value > U((max - digit) / 10))
+					return std::nullopt;
+				value = U(value * 10 + digit);
+			}
+
+			return negative ? T(U(0) - value) : T(value);
+		}
+	} // namespace detail
+
 	template <typename T>
 	struct charconv_to_string_parse_traits
 	{
-		static std::optional<T> parse(std::string_view text) noexcept
+		static constexpr std::optional<T> parse(std::string_view text) noexcept
 		{
-			T x;
+			if constexpr (std::is_integral_v<T>)
+				if (std::is_constant_evaluated())
+					return detail::parse_integer<T>(text);
+
+			T x{};
 			auto const result = std::from_chars(text.data(), text.data() + text.size(), x);
 			if (result.ec != std::errc() || result.ptr != text.data() + text.size())
 				return std::nullopt;
@@ -71,7 +131,7 @@ namespace dodo
 	template <>
 	struct parse_traits<std::string>
 	{
-		static std::optional<std::string> parse(std::string_view text) noexcept
+		static constexpr std::optional<std::string> parse(std::string_view text) noexcept
 		{
 			return std::string(text);
 		}
@@ -96,35 +156,47 @@ namespace dodo
 		}
 	};
 
-	template <typename T, typename Alloc>
-	struct parse_traits<std::vector<T, Alloc>>
+	namespace detail
 	{
-		static constexpr std::optional<std::vector<T, Alloc>> parse(std::string_view text) noexcept
+		// Parses each of the values separated by spaces in the text with the traits of T and passes it to the function. Stops when a value fails
+		// to parse or the function returns false, and returns whether all values were consumed.
+		template <typename T, typename F>
+		constexpr bool parse_space_separated(std::string_view text, F f) noexcept
 		{
-			std::vector<T, Alloc> v;
-
 			size_t index = 0;
 			while (index != std::string_view::npos)
 			{
 				size_t const end = text.find(' ', index);
 				auto elem = parse_traits<T>::parse(text.substr(index, end - index));
-				if (!elem)
-					return std::nullopt;
-				v.push_back(std::move(*elem));
+				if (!elem || !f(std::move(*elem)))
+					return false;
 
 				index = text.find_first_not_of(' ', end);
 			}
 
-			return v;
+			return true;
 		}
 
-		static std::string to_string(std::vector<T, Alloc> const & v)
+		constexpr size_t count_space_separated(std::string_view text) noexcept
+		{
+			size_t count = 0;
+			size_t index = 0;
+			while (index != std::string_view::npos)
+			{
+				++count;
+				index = text.find_first_not_of(' ', text.find(' ', index));
+			}
+			return count;
+		}
+
+		template <typename Range>
+		std::string join_space_separated(Range const & range)
 		{
 			std::string result;
 
-			for (T const & t : v)
+			for (auto const & t : range)
 			{
-				result += parse_traits<T>::to_string(t);
+				result += parse_traits<std::remove_cvref_t<decltype(t)>>::to_string(t);
 				result += ' ';
 			}
 
@@ -134,6 +206,77 @@ namespace dodo
 
 			return result;
 		}
+	} // namespace detail
+
+	template <typename T, typename Alloc>
+	struct parse_traits<std::vector<T, Alloc>>
+	{
+		static constexpr std::optional<std::vector<T, Alloc>> parse(std::string_view text) noexcept
+		{
+			std::vector<T, Alloc> v;
+
+			bool const parsed = detail::parse_space_separated<T>(text, [&v](T && elem)
+			{
+				v.push_back(std::move(elem));
+				return true;
+			});
+
+			if (!parsed)
+				return std::nullopt;
+			return v;
+		}
+
+		static std::string to_string(std::vector<T, Alloc> const & v)
+		{
+			return detail::join_space_separated(v);
+		}
+
+		static constexpr std::span<std::string_view const> value_names() noexcept requires TraitEnumerable<T>
+		{
+			return parse_traits<T>::value_names();
+		}
+	};
+
+	// Exactly N values separated by spaces.
+	template <typename T, size_t N>
+	struct parse_traits<std::array<T, N>>
+	{
+		static constexpr std::optional<std::array<T, N>> parse(std::string_view text) noexcept
+		{
+			std::array<T, N> a = {};
+			size_t count = 0;
+
+			bool const parsed = detail::parse_space_separated<T>(text, [&a, &count](T && elem)
+			{
+				if (count == N)
+					return false;
+				a[count++] = std::move(elem);
+				return true;
+			});
+
+			if (!parsed || count != N)
+				return std::nullopt;
+			return a;
+		}
+
+		static std::string parse_error(std::string_view text)
+		{
+			size_t const count = detail::count_space_separated(text);
+			if (count != N)
+				return "Expected " + std::to_string(N) + " values, found " + std::to_string(count);
+			else
+				return std::string();
+		}
+
+		static std::string to_string(std::array<T, N> const & a)
+		{
+			return detail::join_space_separated(a);
+		}
+
+		static constexpr std::span<std::string_view const> value_names() noexcept requires TraitEnumerable<T>
+		{
+			return parse_traits<T>::value_names();
+		}
 	};
 
 } // namespace dodo
@@ -0,0 +1,327 @@
+#pragma once
+
+#include "dodo.hh"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// Parse traits for std::filesystem::path and validators that check that paths exist. Not included by dodo.hh because the validators start
+// a pool of threads to check long lists of paths.
+
+namespace dodo
+{
+
+	template <>
+	struct parse_traits<std::filesystem::path>
+	{
+		static constexpr std::string_view hint = "path";
+
+		static std::optional<std::filesystem::path> parse(std::string_view text) noexcept
+		{
+			if (text.empty())
+				return std::nullopt;
+			return std::filesystem::path(text);
+		}
+
+		static std::string to_string(std::filesystem::path const & path)
+		{
+			return path.string();
+		}
+	};
+
+	enum struct path_kind { any, file, directory };
+
+	namespace detail
+	{
+		inline bool path_is(std::filesystem::path const & path, path_kind kind) noexcept
+		{
+			// One call to stat per path.
+			std::error_code error;
+			std::filesystem::file_status const status = std::filesystem::status(path, error);
+
+			switch (kind)
+			{
+				case path_kind::file: return std::filesystem::is_regular_file(status);
+				case path_kind::directory: return std::filesystem::is_directory(status);
+				default: return std::filesystem::exists(status);
+			}
+		}
+
+		// Lists of paths are split among threads when there are enough of them for the threads to pay off.
+		constexpr size_t min_paths_per_thread = 64;
+		constexpr size_t paths_per_batch = 16;
+
+		// Threads that check paths, started the first time a list is long enough to be split and kept until the program exits, so that every
+		// parse after the first does not pay for starting threads. The thread that submits the paths checks them too. Only one list is checked
+		// at a time, and threads that submit a list while another is being checked check theirs alone.
+		class path_check_pool
+		{
+		public:
+			static path_check_pool & instance()
+			{
+				static path_check_pool pool;
+				return pool;
+			}
+
+			// Calls check(begin, end) for consecutive ranges of indices that together cover [0, count).
+			template <typename F>
+			void run(size_t count, F const & check)
+			{
+				std::unique_lock<std::mutex> const submitting(submit_mutex, std::try_to_lock);
+				if (!submitting || threads.empty())
+				{
+					check(0, count);
+					return;
+				}
+
+				{
+					std::lock_guard<std::mutex> const lock(mutex);
+					job_function = [](void const * context, size_t begin, size_t end) { (*static_cast<F const *>(context))(begin, end); };
+					job_context = &check;
+					job_count = count;
+					next_index.store(0, std::memory_order_relaxed);
+					job_running = true;
+					++generation;
+				}
+				wake.notify_all();
+
+				run_job(job_function, job_context, count);
+
+				// Threads that have not joined yet must not run a job whose context is about to go out of scope.
+				std::unique_lock<std::mutex> lock(mutex);
+				job_running = false;
+				done.wait(lock, [this] { return working_threads == 0; });
+			}
+
+		private:
+			using job_function_type = void (*)(void const * context, size_t begin, size_t end);
+
+			path_check_pool()
+			{
+				unsigned const thread_count = std::thread::hardware_concurrency();
+				for (unsigned i = 1; i < thread_count; ++i)
+					threads.emplace_back([this] { work(); });
+			}
+
+			~path_check_pool()
+			{
+				{
+					std::lock_guard<std::mutex> const lock(mutex);
+					stopping = true;
+				}
+				wake.notify_all();
+			}
+
+			void run_job(job_function_type function, void const * context, size_t count) noexcept
+			{
+				for (;;)
+				{
+					size_t const begin = next_index.fetch_add(paths_per_batch, std::memory_order_relaxed);
+					if (begin >= count)
+						return;
+					function(context, begin, std::min(begin + paths_per_batch, count));
+				}
+			}
+
+			void work()
+			{
+				uint64_t seen_generation = 0;
+				std::unique_lock<std::mutex> lock(mutex);
+				for (;;)
+				{
+					wake.wait(lock, [&] { return stopping || generation != seen_generation; });
+					if (stopping)
+						return;
+					seen_generation = generation;
+					if (!job_running)
+						continue;
+
+					++working_threads;
+					job_function_type const function = job_function;
+					void const * const context = job_context;
+					size_t const count = job_count;
+					lock.unlock();
+					run_job(function, context, count);
+					lock.lock();
+					if (--working_threads == 0)
+						done.notify_all();
+				}
+			}
+
+			std::mutex submit_mutex;
+			std::mutex mutex;
+			std::condition_variable wake;
+			std::condition_variable done;
+			uint64_t generation = 0;
+			bool stopping = false;
+			bool job_running = false;
+			size_t working_threads = 0;
+			job_function_type job_function = nullptr;
+			void const * job_context = nullptr;
+			size_t job_count = 0;
+			std::atomic<size_t> next_index = 0;
+			// Last, so that the threads are joined before the rest of the members are destroyed.
+			std::vector<std::jthread> threads;
+		};
+
+		// For each index up to count, whether the path at that index fails the check.
+		template <typename Fails>
+		std::unique_ptr<bool[]> find_failing_paths(size_t count, Fails const & fails)
+		{
+			std::unique_ptr<bool[]> failed(new bool[count]);
+
+			auto const check_paths = [&](size_t begin, size_t end)
+			{
+				for (size_t i = begin; i < end; ++i)
+					failed[i] = fails(i);
+			};
+
+			if (count < 2 * min_paths_per_thread)
+				check_paths(0, count);
+			else
+				path_check_pool::instance().run(count, check_paths);
+
+			return failed;
+		}
+
+		// Indices of the paths that are not of the given kind, in order.
+		template <typename Range>
+		std::vector<size_t> find_paths_that_are_not(Range const & paths, path_kind kind)
+		{
+			size_t const count = std::ranges::size(paths);
+			std::unique_ptr<bool[]> const failed = find_failing_paths(count, [&](size_t i)
+			{
+				return !path_is(std::filesystem::path(paths[i]), kind);
+			});
+
+			std::vector<size_t> result;
+			for (size_t i = 0; i < count; ++i)
+				if (failed[i])
+					result.push_back(i);
+			return result;
+		}
+
+		constexpr std::string_view path_kind_name(path_kind kind) noexcept
+		{
+			switch (kind)
+			{
+				case path_kind::file: return "file";
+				case path_kind::directory: return "directory";
+				default: return "path";
+			}
+		}
+
+		// Names the first few of the missing paths. missing_path(i) is the i-th of them.
+		template <typename MissingPath>
+		std::string missing_paths_message(path_kind kind, size_t missing_count, MissingPath missing_path)
+		{
+			constexpr size_t max_paths_in_message = 10;
+
+			std::string result = "No such " + std::string(path_kind_name(kind)) + ": ";
+			for (size_t i = 0; i < missing_count && i < max_paths_in_message; ++i)
+			{
+				if (i > 0)
+					result += ", ";
+				result += std::filesystem::path(missing_path(i)).string();
+			}
+			if (missing_count > max_paths_in_message)
+				result += " and " + std::to_string(missing_count - max_paths_in_message) + " more";
+			return result;
+		}
+
+		// Paths of all the path options of a parse, checked together when the parse finishes. Each check is a range of the paths and
+		// reports the ones that are missing after the context of its option.
+		struct path_batch
+		{
+			struct check
+			{
+				std::string context;
+				path_kind kind;
+				size_t first;
+				size_t count;
+			};
+
+			std::optional<std::string> resolve() const
+			{
+				std::unique_ptr<bool[]> const failed = find_failing_paths(paths.size(), [this](size_t i)
+				{
+					return !path_is(paths[i], kinds[i]);
+				});
+
+				for (check const & c : checks)
+				{
+					std::vector<size_t> missing;
+					for (size_t i = c.first; i < c.first + c.count; ++i)
+						if (failed[i])
+							missing.push_back(i);
+
+					if (!missing.empty())
+						return c.context + missing_paths_message(c.kind, missing.size(), [&](size_t i) -> auto const & { return paths[missing[i]]; });
+				}
+				return std::nullopt;
+			}
+
+			std::vector<std::filesystem::path> paths;
+			std::vector<path_kind> kinds;
+			std::vector<check> checks;
+		};
+	} // namespace detail
+
+	// Checks that a path, or every path of a list, exists and is of the given kind. The error message names the paths that failed the check.
+	// In the options of a parser, the paths of all options are checked together after everything else has been parsed, in parallel when
+	// there are many of them.
+	template <path_kind Kind>
+	struct path_exists
+	{
+		template <typename U>
+		bool operator () (U const & value) const
+		{
+			if constexpr (std::is_constructible_v<std::filesystem::path, U const &>)
+				return detail::path_is(std::filesystem::path(value), Kind);
+			else
+				return detail::find_paths_that_are_not(value, Kind).empty();
+		}
+
+		std::string description() const
+		{
+			return "Must be an existing " + std::string(detail::path_kind_name(Kind));
+		}
+
+		template <typename U>
+		std::string error_message(U const & value) const
+		{
+			if constexpr (std::is_constructible_v<std::filesystem::path, U const &>)
+				return detail::missing_paths_message(Kind, 1, [&](size_t) -> U const & { return value; });
+			else
+			{
+				std::vector<size_t> const missing = detail::find_paths_that_are_not(value, Kind);
+				return detail::missing_paths_message(Kind, missing.size(), [&](size_t i) -> auto const & { return value[missing[i]]; });
+			}
+		}
+
+		template <typename U>
+		void defer(U const & value, detail::deferred_checks & checks, std::string const & context) const
+		{
+			detail::path_batch & batch = checks.get<detail::path_batch>();
+			size_t const first = batch.paths.size();
+
+			if constexpr (std::is_constructible_v<std::filesystem::path, U const &>)
+				batch.paths.emplace_back(value);
+			else
+				for (auto const & path : value)
+					batch.paths.emplace_back(path);
+
+			batch.kinds.resize(batch.paths.size(), Kind);
+			batch.checks.push_back({context, Kind, first, batch.paths.size() - first});
+		}
+	};
+
+	inline constexpr path_exists<path_kind::any> existing_path;
+	inline constexpr path_exists<path_kind::file> existing_file;
+	inline constexpr path_exists<path_kind::directory> existing_directory;
+
+} // namespace dodo
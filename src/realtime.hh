@@ -0,0 +1,239 @@
+#pragma once
+
+#include "dodo.hh"
+#include <cstdint>
+#include <type_traits>
+
+// Parsing for threads that may not allocate or block, such as audio or render threads that read console commands. Only parsers whose result
+// holds no heap storage are accepted, errors are codes instead of strings, and the amount of arguments and their length is bounded, which bounds
+// the work done by a call to parse_realtime.
+//
+// constexpr auto cli = dodo_Opt(float, gain)["--gain"] | dodo_Opt(int, channel)["--channel"].by_default(0);
+// static_assert(dodo::RealtimeParser<decltype(cli)>);
+// auto const result = dodo::parse_realtime<dodo::realtime_limits<8, 64>>(cli, args);
+
+namespace dodo
+{
+
+    template <size_t MaxArguments, size_t MaxArgumentLength>
+    struct realtime_limits
+    {
+        static_assert(MaxArguments <= UINT16_MAX, "realtime_limits can allow up to 65535 arguments.");
+
+        static constexpr size_t max_arguments = MaxArguments;
+        static constexpr size_t max_argument_length = MaxArgumentLength;
+    };
+
+    using default_realtime_limits = realtime_limits<16, 256>;
+
+    enum struct parse_error_code : uint8_t
+    {
+        too_many_arguments,     // More arguments than the limit, or more positional arguments than the parser takes.
+        argument_too_long,      // An argument is longer than the limit.
+        unrecognized_argument,  // No option matches the argument, or the option it matches was already given.
+        conversion_failed,      // The argument could not be converted to the type of the option.
+        validation_failed,      // The value did not pass the checks of the option.
+        missing_option,         // An option without default value was not given.
+        missing_argument,       // A positional argument without default value was not given.
+    };
+
+    constexpr std::string_view error_message(parse_error_code code) noexcept
+    {
+        switch (code)
+        {
+            case parse_error_code::too_many_arguments: return "Too many arguments";
+            case parse_error_code::argument_too_long: return "Argument too long";
+            case parse_error_code::unrecognized_argument: return "Unrecognized argument";
+            case parse_error_code::conversion_failed: return "Could not convert argument";
+            case parse_error_code::validation_failed: return "Validation check failed";
+            case parse_error_code::missing_option: return "Missing option";
+            case parse_error_code::missing_argument: return "Missing argument";
+        }
+        return "Unknown error";
+    }
+
+    struct realtime_error
+    {
+        parse_error_code code;
+        uint16_t argument_index; // Index of the argument that caused the error. The amount of arguments for missing options and arguments.
+
+        constexpr bool operator == (realtime_error const & other) const noexcept = default;
+    };
+
+    namespace detail
+    {
+        template <typename T>
+        constexpr bool is_realtime_parser_shape = false;
+
+        template <SingleOption ... Options>
+        constexpr bool is_realtime_parser_shape<CompoundOption<Options...>> = true;
+
+        template <SingleArgument ... Arguments>
+        constexpr bool is_realtime_parser_shape<CompoundArgument<Arguments...>> = true;
+
+        template <typename Arguments, typename Options>
+        constexpr bool is_realtime_parser_shape<CompoundParser<Arguments, Options>> = true;
+    } // namespace detail
+
+    // Parsers of options and positional arguments whose result can be destroyed without freeing anything. This rules out std::string,
+    // std::vector and any other type that owns heap storage. Commands are not supported.
+    template <typename P>
+    concept RealtimeParser = detail::is_realtime_parser_shape<P> && std::is_trivially_destructible_v<typename P::parse_result_type>;
+
+    namespace detail
+    {
+        template <typename Single>
+        auto parse_single_realtime(Single const & single, std::string_view text, uint16_t index) noexcept
+            -> expected<typename Single::parse_result_type, realtime_error>
+        {
+            if constexpr (HasImplicitValue<Single>)
+                if (text.empty())
+                    return make_parse_result<typename Single::parse_result_type>(single.implicit_value);
+
+            std::optional<typename Single::parse_result_type> result = single.parse_impl(text);
+            if (!result)
+                return Error(realtime_error{parse_error_code::conversion_failed, index});
+
+            if constexpr (HasValidationCheck<Single>)
+                if (!single.passes(result->_get()))
+                    return Error(realtime_error{parse_error_code::validation_failed, index});
+
+            return std::move(*result);
+        }
+
+        template <SingleOption ... Options>
+        auto parse_realtime_impl(CompoundOption<Options...> const & parser, ArgsView args, uint16_t first_index) noexcept
+            -> expected<typename CompoundOption<Options...>::parse_result_type, realtime_error>
+        {
+            std::tuple<std::optional<typename Options::parse_result_type>...> results;
+            std::optional<realtime_error> error;
+
+            for (size_t i = 0; i < args.size() && !error; ++i)
+            {
+                auto const index = static_cast<uint16_t>(first_index + i);
+
+                // Patterns are unique, so the first option that matches the argument is the only one that can take it.
+                bool const matched = ([&]<typename Option>(Option const & option, auto & result)
+                {
+                    std::optional<std::string_view> const text = option.match(args[i]);
+                    if (!text)
+                        return false;
+                    if (result)
+                    {
+                        error = realtime_error{parse_error_code::unrecognized_argument, index};
+                        return true;
+                    }
+
+                    auto parsed = parse_single_realtime(option, *text, index);
+                    if (parsed)
+                        result = std::move(*parsed);
+                    else
+                        error = parsed.error();
+                    return true;
+                }(parser.template access_option<Options>(), std::get<std::optional<typename Options::parse_result_type>>(results)) || ...);
+
+                if (!matched)
+                    error = realtime_error{parse_error_code::unrecognized_argument, index};
+            }
+
+            if (error)
+                return Error(*error);
+
+            auto const missing_index = static_cast<uint16_t>(first_index + args.size());
+            bool const all_given = ([&]<typename Option>(Option const & option, auto & result)
+            {
+                if constexpr (HasDefaultValue<Option>)
+                    if (!result)
+                        result = make_parse_result<typename Option::parse_result_type>(option.default_value);
+                return result.has_value();
+            }(parser.template access_option<Options>(), std::get<std::optional<typename Options::parse_result_type>>(results)) && ...);
+
+            if (!all_given)
+                return Error(realtime_error{parse_error_code::missing_option, missing_index});
+
+            return merge_results<typename CompoundOption<Options...>::parse_result_type>(std::move(*std::get<std::optional<typename Options::parse_result_type>>(results))...);
+        }
+
+        template <SingleArgument ... Arguments>
+        auto parse_realtime_impl(CompoundArgument<Arguments...> const & parser, ArgsView args, uint16_t first_index) noexcept
+            -> expected<typename CompoundArgument<Arguments...>::parse_result_type, realtime_error>
+        {
+            if (args.size() > sizeof...(Arguments))
+                return Error(realtime_error{parse_error_code::too_many_arguments, static_cast<uint16_t>(first_index + sizeof...(Arguments))});
+
+            std::tuple<std::optional<typename Arguments::parse_result_type>...> results;
+            std::optional<realtime_error> error;
+
+            [&]<size_t ... Is>(std::index_sequence<Is...>)
+            {
+                ([&]<typename Argument>(Argument const & argument, auto & result)
+                {
+                    auto const index = static_cast<uint16_t>(first_index + Is);
+
+                    if (Is >= args.size())
+                    {
+                        if constexpr (HasDefaultValue<Argument>)
+                            result = make_parse_result<typename Argument::parse_result_type>(argument.default_value);
+                        else
+                            error = realtime_error{parse_error_code::missing_argument, index};
+                        return !error;
+                    }
+
+                    auto parsed = parse_single_realtime(argument, args[Is], index);
+                    if (parsed)
+                        result = std::move(*parsed);
+                    else
+                        error = parsed.error();
+                    return !error;
+                }(parser.template access_argument<Arguments>(), std::get<Is>(results)) && ...);
+            }(std::index_sequence_for<Arguments...>());
+
+            if (error)
+                return Error(*error);
+
+            return [&]<size_t ... Is>(std::index_sequence<Is...>)
+            {
+                return merge_results<typename CompoundArgument<Arguments...>::parse_result_type>(std::move(*std::get<Is>(results))...);
+            }(std::index_sequence_for<Arguments...>());
+        }
+
+        template <typename Arguments, typename Options>
+        auto parse_realtime_impl(CompoundParser<Arguments, Options> const & parser, ArgsView args, uint16_t first_index) noexcept
+            -> expected<typename CompoundParser<Arguments, Options>::parse_result_type, realtime_error>
+        {
+            auto const first_option = std::find_if(args.begin(), args.end(), [](std::string_view arg) { return arg.starts_with('-'); });
+            size_t const positional_arg_count = size_t(first_option - args.begin());
+
+            auto parsed_args = parse_realtime_impl(parser.access_arguments(), args.first(positional_arg_count), first_index);
+            if (!parsed_args)
+                return Error(parsed_args.error());
+
+            auto opts = parse_realtime_impl(parser.access_options(), args.last(args.size() - positional_arg_count), static_cast<uint16_t>(first_index + positional_arg_count));
+            if (!opts)
+                return Error(opts.error());
+
+            return merge_parser_results<typename CompoundParser<Arguments, Options>::parse_result_type, Arguments>(std::move(*parsed_args), std::move(*opts));
+        }
+    } // namespace detail
+
+    // Parses the arguments without allocating. The limits are checked before anything is parsed, so an argument list over the limits is rejected
+    // in time proportional to the limits.
+    template <typename Limits = default_realtime_limits, typename P>
+    auto parse_realtime(P const & parser, ArgsView args) noexcept -> expected<typename P::parse_result_type, realtime_error>
+    {
+        static_assert(detail::is_realtime_parser_shape<P>, "parse_realtime only supports parsers of options and positional arguments.");
+        static_assert(std::is_trivially_destructible_v<typename P::parse_result_type>,
+            "parse_realtime does not support options of types that own heap storage. Use std::string_view instead of std::string, and std::array or "
+            "dodo::static_vector instead of std::vector.");
+
+        if (args.size() > Limits::max_arguments)
+            return Error(realtime_error{parse_error_code::too_many_arguments, static_cast<uint16_t>(Limits::max_arguments)});
+
+        for (size_t i = 0; i < args.size(); ++i)
+            if (args[i].size() > Limits::max_argument_length)
+                return Error(realtime_error{parse_error_code::argument_too_long, static_cast<uint16_t>(i)});
+
+        return detail::parse_realtime_impl(parser, args, 0);
+    }
+
+} // namespace dodo
@@ -0,0 +1,485 @@
+#pragma once
+
+#include "fixed_string.hh"
+#include "validators.hh"
+#include <array>
+#include <cstdint>
+
+// Regular expressions compiled at compile time into a DFA. The pattern is parsed into a Glushkov automaton, where each character of the pattern
+// is a state, which is turned into a DFA by subset construction. Bytes that no character of the pattern tells apart share a column of the
+// transition table, so matching costs two table lookups per character of the text.
+//
+// Supported syntax: literals, '.', escapes (\d \w \s \D \W \S and escaped special characters), classes ([a-z_], [^0-9]), groups ((...) and
+// (?:...)), alternation (|) and quantifiers (*, +, ?, {n}, {n,}, {n,m}), which may be stacked, as in a{2}{3}, to repeat the quantified atom.
+// The whole text must match, so ^ and $ are accepted at the ends of the pattern but are not necessary. Patterns may have up to 63 characters
+// after expanding {n,m}.
+
+namespace dodo
+{
+
+	namespace detail
+	{
+		struct regex_char_set
+		{
+			constexpr void insert(unsigned char c) noexcept { bits[c / 64] |= uint64_t(1) << (c % 64); }
+			constexpr void insert_range(unsigned char first, unsigned char last) noexcept { for (unsigned c = first; c <= last; ++c) insert(static_cast<unsigned char>(c)); }
+			constexpr void insert(regex_char_set const & other) noexcept { for (size_t i = 0; i < 4; ++i) bits[i] |= other.bits[i]; }
+			constexpr void invert() noexcept { for (uint64_t & word : bits) word = ~word; }
+			constexpr bool contains(unsigned char c) const noexcept { return (bits[c / 64] >> (c % 64)) & 1; }
+
+			uint64_t bits[4] = {};
+		};
+
+		constexpr size_t max_regex_positions = 64;
+
+		// Glushkov automaton. Position 0 is the start state, and the others are the characters of the pattern.
+		struct regex_nfa
+		{
+			std::array<regex_char_set, max_regex_positions> sets = {};
+			std::array<uint64_t, max_regex_positions> follow = {};
+			uint64_t accepting = 0;
+			size_t position_count = 1;
+		};
+
+		// Positions of a subexpression that can be first and last in a match, and whether it matches the empty string.
+		struct regex_fragment
+		{
+			uint64_t first = 0;
+			uint64_t last = 0;
+			bool nullable = true;
+		};
+
+		struct regex_parser
+		{
+			constexpr regex_fragment parse_alternation() noexcept
+			{
+				regex_fragment result = parse_concatenation();
+				while (peek('|'))
+				{
+					++index;
+					regex_fragment const other = parse_concatenation();
+					result = regex_fragment{result.first | other.first, result.last | other.last, result.nullable || other.nullable};
+				}
+				return result;
+			}
+
+			constexpr regex_fragment parse_concatenation() noexcept
+			{
+				regex_fragment result;
+				while (index < pattern.size() && !peek('|') && !peek(')'))
+					result = concatenate(result, parse_repetition());
+				return result;
+			}
+
+			// Parses an atom and the quantifiers after it, up to end.
+			constexpr regex_fragment parse_repetition(size_t end = std::string_view::npos) noexcept
+			{
+				size_t const atom_begin = index;
+				regex_fragment result = parse_atom();
+
+				while (index < pattern.size() && index < end)
+				{
+					size_t const quantified_end = index;
+					char const c = pattern[index];
+					if (c == '*')
+					{
+						++index;
+						result = repeat(result);
+						result.nullable = true;
+					}
+					else if (c == '+')
+					{
+						++index;
+						result = repeat(result);
+					}
+					else if (c == '?')
+					{
+						++index;
+						result.nullable = true;
+					}
+					else if (c == '{')
+					{
+						++index;
+						size_t const min = parse_count();
+						size_t max = min;
+						bool unbounded = false;
+						if (peek(','))
+						{
+							++index;
+							if (peek('}'))
+								unbounded = true;
+							else
+								max = parse_count();
+						}
+						if (!peek('}') || max < min || (min == 0 && max == 0 && !unbounded))
+							definition_error("Invalid repetition in regex.");
+						++index;
+						size_t const after_quantifier = index;
+
+						// The atom and the quantifiers before this one are parsed again for each copy, which gives each copy its own
+						// positions, so that stacked quantifiers like a{2}{3} or a+{2} repeat the whole quantified atom.
+						regex_fragment repeated = min > 0 ? result : regex_fragment{};
+						if (min == 0)
+						{
+							result.nullable = true;
+							repeated = unbounded ? repeat(result) : result;
+						}
+						for (size_t i = 1; i < (min > 0 ? min : 1); ++i)
+							repeated = concatenate(repeated, reparse_repetition(atom_begin, quantified_end));
+						if (unbounded && min > 0)
+						{
+							regex_fragment star = repeat(reparse_repetition(atom_begin, quantified_end));
+							star.nullable = true;
+							repeated = concatenate(repeated, star);
+						}
+						for (size_t i = (min > 0 ? min : 1); i < max && !unbounded; ++i)
+						{
+							regex_fragment optional = reparse_repetition(atom_begin, quantified_end);
+							optional.nullable = true;
+							repeated = concatenate(repeated, optional);
+						}
+
+						index = after_quantifier;
+						result = repeated;
+					}
+					else
+						break;
+				}
+
+				return result;
+			}
+
+			constexpr regex_fragment parse_atom() noexcept
+			{
+				char const c = pattern[index++];
+				switch (c)
+				{
+					case '(':
+					{
+						if (pattern.substr(index).starts_with("?:"))
+							index += 2;
+						regex_fragment const inner = parse_alternation();
+						if (!peek(')'))
+							definition_error("Unbalanced parenthesis in regex.");
+						++index;
+						return inner;
+					}
+					case '[':
+						return add_position(parse_class());
+					case '.':
+					{
+						regex_char_set any;
+						any.invert();
+						return add_position(any);
+					}
+					case '\\':
+						return add_position(parse_escape());
+					case '^':
+						if (index != 1)
+							definition_error("^ can only be used at the beginning of a regex.");
+						return regex_fragment{};
+					case '$':
+						if (index != pattern.size())
+							definition_error("$ can only be used at the end of a regex.");
+						return regex_fragment{};
+					case ')': case '*': case '+': case '?': case '{': case '}': case ']': case '|':
+						definition_error("Unexpected special character in regex.");
+						return regex_fragment{};
+					default:
+					{
+						regex_char_set set;
+						set.insert(static_cast<unsigned char>(c));
+						return add_position(set);
+					}
+				}
+			}
+
+			constexpr regex_char_set parse_class() noexcept
+			{
+				regex_char_set set;
+				bool const negated = peek('^');
+				if (negated)
+					++index;
+
+				bool first = true;
+				while (index < pattern.size() && (first || pattern[index] != ']'))
+				{
+					first = false;
+					if (pattern[index] == '\\')
+					{
+						++index;
+						set.insert(parse_escape());
+						continue;
+					}
+
+					auto const low = static_cast<unsigned char>(pattern[index++]);
+					if (peek('-') && index + 1 < pattern.size() && pattern[index + 1] != ']')
+					{
+						auto const high = static_cast<unsigned char>(pattern[index + 1]);
+						if (high < low)
+							definition_error("Invalid range in regex class.");
+						set.insert_range(low, high);
+						index += 2;
+					}
+					else
+						set.insert(low);
+				}
+
+				if (!peek(']'))
+					definition_error("Unterminated class in regex.");
+				++index;
+
+				if (negated)
+					set.invert();
+				return set;
+			}
+
+			constexpr regex_char_set parse_escape() noexcept
+			{
+				if (index == pattern.size())
+				{
+					definition_error("Regex ends in an escape character.");
+					return regex_char_set{};
+				}
+
+				char const c = pattern[index++];
+				regex_char_set set;
+				switch (c)
+				{
+					case 'd': case 'D':
+						set.insert_range('0', '9');
+						break;
+					case 'w': case 'W':
+						set.insert_range('a', 'z');
+						set.insert_range('A', 'Z');
+						set.insert_range('0', '9');
+						set.insert('_');
+						break;
+					case 's': case 'S':
+						for (char const space : {' ', '\t', '\n', '\r', '\f', '\v'})
+							set.insert(static_cast<unsigned char>(space));
+						break;
+					case 'n': set.insert('\n'); break;
+					case 't': set.insert('\t'); break;
+					case 'r': set.insert('\r'); break;
+					default:
+						if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9'))
+							definition_error("Unknown escape sequence in regex.");
+						set.insert(static_cast<unsigned char>(c));
+				}
+
+				if (c == 'D' || c == 'W' || c == 'S')
+					set.invert();
+				return set;
+			}
+
+			constexpr size_t parse_count() noexcept
+			{
+				size_t count = 0;
+				size_t digits = 0;
+				while (index < pattern.size() && pattern[index] >= '0' && pattern[index] <= '9')
+				{
+					count = count * 10 + size_t(pattern[index++] - '0');
+					++digits;
+				}
+				if (digits == 0 || count >= max_regex_positions)
+					definition_error("Invalid repetition count in regex.");
+				return count;
+			}
+
+			constexpr regex_fragment reparse_repetition(size_t begin, size_t end) noexcept
+			{
+				index = begin;
+				regex_fragment const result = parse_repetition(end);
+				if (index != end)
+					definition_error("Regex could not be parsed.");
+				return result;
+			}
+
+			constexpr regex_fragment add_position(regex_char_set const & set) noexcept
+			{
+				if (nfa.position_count == max_regex_positions)
+				{
+					definition_error("Regex is too long. The limit is 63 characters after expanding repetitions.");
+					return regex_fragment{};
+				}
+
+				size_t const position = nfa.position_count++;
+				nfa.sets[position] = set;
+				uint64_t const bit = uint64_t(1) << position;
+				return regex_fragment{bit, bit, false};
+			}
+
+			constexpr void add_follow(uint64_t from, uint64_t to) noexcept
+			{
+				for (size_t p = 0; p < nfa.position_count; ++p)
+					if (from & (uint64_t(1) << p))
+						nfa.follow[p] |= to;
+			}
+
+			constexpr regex_fragment concatenate(regex_fragment a, regex_fragment b) noexcept
+			{
+				add_follow(a.last, b.first);
+				return regex_fragment{
+					a.first | (a.nullable ? b.first : 0),
+					b.last | (b.nullable ? a.last : 0),
+					a.nullable && b.nullable
+				};
+			}
+
+			// Loop back from the end of the fragment to its beginning. Used for * and +.
+			constexpr regex_fragment repeat(regex_fragment a) noexcept
+			{
+				add_follow(a.last, a.first);
+				return a;
+			}
+
+			constexpr bool peek(char c) const noexcept { return index < pattern.size() && pattern[index] == c; }
+
+			std::string_view pattern;
+			size_t index = 0;
+			regex_nfa nfa;
+		};
+
+		constexpr regex_nfa parse_regex(std::string_view pattern) noexcept
+		{
+			regex_parser parser{pattern, 0, {}};
+			regex_fragment const whole = parser.parse_alternation();
+			if (parser.index != pattern.size())
+				definition_error("Unbalanced parenthesis in regex.");
+
+			parser.nfa.follow[0] = whole.first;
+			parser.nfa.accepting = whole.last | (whole.nullable ? 1 : 0);
+			return parser.nfa;
+		}
+
+		constexpr size_t max_regex_dfa_states = 512;
+
+		// Bytes that are in the same sets of the pattern behave the same in every state, so they are given the same column in the DFA.
+		struct regex_byte_classes
+		{
+			std::array<uint8_t, 256> class_of = {};
+			std::array<uint64_t, 256> positions = {}; // Positions of the NFA that accept each class.
+			size_t count = 0;
+		};
+
+		constexpr regex_byte_classes make_byte_classes(regex_nfa const & nfa) noexcept
+		{
+			regex_byte_classes classes;
+			for (unsigned c = 0; c < 256; ++c)
+			{
+				uint64_t positions = 0;
+				for (size_t p = 1; p < nfa.position_count; ++p)
+					if (nfa.sets[p].contains(static_cast<unsigned char>(c)))
+						positions |= uint64_t(1) << p;
+
+				size_t k = 0;
+				while (k < classes.count && classes.positions[k] != positions)
+					++k;
+				if (k == classes.count)
+					classes.positions[classes.count++] = positions;
+				classes.class_of[c] = static_cast<uint8_t>(k);
+			}
+			return classes;
+		}
+
+		// Subset construction. Each state of the DFA is a set of positions of the NFA. State 0 is the start state. Calls visit(state, class,
+		// next_state) for every transition and returns the amount of states.
+		template <typename Visit>
+		constexpr size_t explore_regex_dfa(regex_nfa const & nfa, regex_byte_classes const & classes, Visit visit) noexcept
+		{
+			std::array<uint64_t, max_regex_dfa_states> states = {};
+			states[0] = 1;
+			size_t state_count = 1;
+
+			for (size_t s = 0; s < state_count; ++s)
+			{
+				uint64_t reachable = 0;
+				for (size_t p = 0; p < nfa.position_count; ++p)
+					if (states[s] & (uint64_t(1) << p))
+						reachable |= nfa.follow[p];
+
+				for (size_t k = 0; k < classes.count; ++k)
+				{
+					uint64_t const next = reachable & classes.positions[k];
+
+					size_t t = 0;
+					while (t < state_count && states[t] != next)
+						++t;
+					if (t == state_count)
+					{
+						if (state_count == max_regex_dfa_states)
+						{
+							definition_error("Regex needs too many states.");
+							return state_count;
+						}
+						states[state_count++] = next;
+					}
+
+					visit(s, k, t, states[t] & nfa.accepting);
+				}
+			}
+
+			return state_count;
+		}
+
+		template <size_t StateCount, size_t ClassCount>
+		struct regex_dfa
+		{
+			using state_type = std::conditional_t<(StateCount <= 256), uint8_t, uint16_t>;
+
+			constexpr bool match(std::string_view text) const noexcept
+			{
+				size_t state = 0;
+				for (char const c : text)
+					state = transitions[state * ClassCount + class_of[static_cast<unsigned char>(c)]];
+				return accepting[state];
+			}
+
+			std::array<uint8_t, 256> class_of = {};
+			std::array<state_type, StateCount * ClassCount> transitions = {};
+			std::array<bool, StateCount> accepting = {};
+		};
+
+		template <fixed_string Pattern>
+		constexpr auto compile_regex() noexcept
+		{
+			constexpr regex_nfa nfa = parse_regex(Pattern.view());
+			constexpr regex_byte_classes classes = make_byte_classes(nfa);
+			constexpr size_t state_count = explore_regex_dfa(nfa, classes, [](size_t, size_t, size_t, bool) {});
+
+			regex_dfa<state_count, classes.count> dfa;
+			dfa.class_of = classes.class_of;
+			dfa.accepting[0] = (nfa.accepting & 1) != 0;
+			explore_regex_dfa(nfa, classes, [&dfa](size_t state, size_t byte_class, size_t next, bool accepting)
+			{
+				dfa.transitions[state * classes.count + byte_class] = static_cast<typename decltype(dfa)::state_type>(next);
+				dfa.accepting[next] = accepting;
+			});
+			return dfa;
+		}
+	} // namespace detail
+
+	// Validator that checks that the whole value matches a regular expression, compiled at compile time.
+	template <fixed_string Pattern>
+	struct regex_validator
+	{
+		static constexpr auto dfa = detail::compile_regex<Pattern>();
+
+		template <typename U>
+		constexpr bool operator () (U const & value) const noexcept
+		{
+			if constexpr (std::is_convertible_v<U const &, std::string_view>)
+				return dfa.match(value);
+			else
+				return detail::all_elements(value, [](auto const & x) { return dfa.match(x); });
+		}
+
+		std::string description() const { return "Pattern: " + std::string(Pattern.view()); }
+		std::string error_message() const { return "Value must match the pattern " + std::string(Pattern.view()) + '.'; }
+	};
+
+	template <fixed_string Pattern>
+	constexpr regex_validator<Pattern> matches = {};
+
+} // namespace dodo
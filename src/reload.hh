@@ -0,0 +1,322 @@
+#pragma once
+
+#include "dodo.hh"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+#if defined(__linux__)
+    #include <poll.h>
+    #include <sys/eventfd.h>
+    #include <sys/inotify.h>
+    #include <unistd.h>
+#endif
+
+// Configuration read from a file that can be reloaded while the program runs. A dodo::ReloadableConfig parses the file into a snapshot. Readers
+// get the current snapshot with current(), which does a single atomic add and never waits, and keep it alive for as long as they hold it.
+// reload() parses the file again and publishes the new result for readers that call current() afterwards. If the file fails to parse, the
+// previous snapshot stays and the error is returned. On Linux, a dodo::ConfigWatcher reloads the configuration from a background thread when
+// the file changes, and when request_reload() is called, which is safe to do from a signal handler.
+//
+// constexpr auto cli = dodo::opt<&ServerConfig::port>["--port"] | dodo::opt<&ServerConfig::workers>["--workers"].by_default(4);
+// dodo::ReloadableConfig config(cli, "server.conf");
+// if (auto const loaded = config.reload(); !loaded) log(loaded.error());
+// dodo::ConfigWatcher const watcher(config, [](std::string const & error) { log(error); });
+// ...
+// auto const snapshot = config.current();
+// serve(snapshot->port);
+
+namespace dodo
+{
+
+    namespace detail
+    {
+        // An atomically swapped, reference counted value. Readers add one to a counter packed in the same word as the index of the current value,
+        // which gives them a reference. When a new value is published, the writer moves that count to the reference count of the old value, so
+        // readers never need to retry. Copies of a reference add to the reference count of the value directly. The value is destroyed by whoever
+        // drops its last reference.
+        template <typename T>
+        struct snapshot_cell
+        {
+            static constexpr int index_bits = 8;
+            static constexpr uint64_t index_mask = (uint64_t(1) << index_bits) - 1;
+            static constexpr uint64_t one_reader = uint64_t(1) << index_bits;
+            // No value has been published yet.
+            static constexpr uint64_t empty_index = index_mask;
+            static constexpr size_t max_values = empty_index;
+
+            // Added to the reference count of the current value, so that it can not reach zero before the readers counted in state are moved
+            // to it. Bigger than any reader count.
+            static constexpr int64_t reference_bias = int64_t(1) << 62;
+
+            struct node
+            {
+                // References are dropped from here, and the writer adds the readers counted in state, minus the bias, when the value is replaced.
+                // It reaches zero once all of them are done.
+                mutable std::atomic<int64_t> references = reference_bias;
+                // Parse results may point into the arguments they were parsed from.
+                std::unique_ptr<Args const> arguments;
+                T value;
+            };
+
+            snapshot_cell() noexcept = default;
+            snapshot_cell(snapshot_cell const &) = delete;
+            snapshot_cell & operator = (snapshot_cell const &) = delete;
+
+            // All references must have been dropped.
+            ~snapshot_cell()
+            {
+                for (std::atomic<node *> & slot : slots)
+                    delete slot.load(std::memory_order_acquire);
+            }
+
+            // Returns the index of the current value, or empty_index, and a reference to it. Wait free.
+            uint64_t acquire() const noexcept
+            {
+                return state.fetch_add(one_reader, std::memory_order_acquire) & index_mask;
+            }
+
+            node * get(uint64_t index) const noexcept
+            {
+                return index == empty_index ? nullptr : slots[index].load(std::memory_order_acquire);
+            }
+
+            void release(uint64_t index) const noexcept
+            {
+                if (index != empty_index && slots[index].load(std::memory_order_acquire)->references.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                    destroy(index);
+            }
+
+            // Publishers must be serialized by the caller. Fails if every slot holds a value that is still referenced.
+            bool publish(std::unique_ptr<Args const> arguments, T value)
+            {
+                size_t free_index = 0;
+                while (free_index < max_values && slots[free_index].load(std::memory_order_acquire) != nullptr)
+                    ++free_index;
+                if (free_index == max_values)
+                    return false;
+
+                slots[free_index].store(new node{{reference_bias}, std::move(arguments), std::move(value)}, std::memory_order_release);
+
+                uint64_t const previous = state.exchange(free_index, std::memory_order_acq_rel);
+                uint64_t const previous_index = previous & index_mask;
+                if (previous_index != empty_index)
+                {
+                    int64_t const adjustment = static_cast<int64_t>(previous >> index_bits) - reference_bias;
+                    if (slots[previous_index].load(std::memory_order_acquire)->references.fetch_add(adjustment, std::memory_order_acq_rel) + adjustment == 0)
+                        destroy(previous_index);
+                }
+                return true;
+            }
+
+        private:
+            void destroy(uint64_t index) const noexcept
+            {
+                delete slots[index].exchange(nullptr, std::memory_order_acq_rel);
+            }
+
+            // 56 bits of reader count allow for several years of calls to current() at a hundred million per second between two reloads.
+            mutable std::atomic<uint64_t> state = empty_index;
+            mutable std::array<std::atomic<node *>, max_values> slots = {};
+        };
+
+        // Lines whose first character that is not a space is # are comments.
+        inline std::string remove_comment_lines(std::string const & text)
+        {
+            std::string out;
+            std::istringstream lines(text);
+            for (std::string line; std::getline(lines, line); )
+            {
+                size_t const first = line.find_first_not_of(" \t\r");
+                if (first != std::string::npos && line[first] != '#')
+                {
+                    out += line;
+                    out += '\n';
+                }
+            }
+            return out;
+        }
+    } // namespace detail
+
+    // A reference to a published configuration, which stays valid while the snapshot exists even if a new one is published. Empty if no
+    // configuration had been loaded when it was taken.
+    template <typename T>
+    struct ConfigSnapshot
+    {
+        ConfigSnapshot(ConfigSnapshot const & other) noexcept : cell(other.cell), index(other.index), current(other.current)
+        {
+            if (current)
+                current->references.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        ConfigSnapshot(ConfigSnapshot && other) noexcept
+            : cell(other.cell)
+            , index(std::exchange(other.index, detail::snapshot_cell<T>::empty_index))
+            , current(std::exchange(other.current, nullptr))
+        {}
+
+        ConfigSnapshot & operator = (ConfigSnapshot other) noexcept
+        {
+            std::swap(cell, other.cell);
+            std::swap(index, other.index);
+            std::swap(current, other.current);
+            return *this;
+        }
+
+        ~ConfigSnapshot() { cell->release(index); }
+
+        explicit operator bool() const noexcept { return current != nullptr; }
+        T const & operator * () const noexcept { return current->value; }
+        T const * operator -> () const noexcept { return &current->value; }
+
+    private:
+        explicit ConfigSnapshot(detail::snapshot_cell<T> const & cell_) noexcept : cell(&cell_), index(cell_.acquire()), current(cell_.get(index)) {}
+
+        detail::snapshot_cell<T> const * cell;
+        uint64_t index;
+        typename detail::snapshot_cell<T>::node const * current;
+
+        template <Parser P> friend struct ReloadableConfig;
+    };
+
+    // The file has the same syntax as dodo::Args::from_command_line, except that lines that start with # are comments, so options can go one
+    // per line. All snapshots must be destroyed before the ReloadableConfig.
+    template <Parser P>
+    struct ReloadableConfig
+    {
+        using parse_result_type = typename P::parse_result_type;
+
+        explicit ReloadableConfig(P parser_, std::filesystem::path path_) : parser(std::move(parser_)), file_path(std::move(path_)) {}
+
+        // The last configuration that was loaded successfully. Never waits for reload.
+        ConfigSnapshot<parse_result_type> current() const noexcept { return ConfigSnapshot<parse_result_type>(snapshots); }
+
+        // Reads and parses the file and publishes the result. If it fails, the current snapshot does not change.
+        auto reload() -> expected<void, std::string>
+        {
+            std::ifstream file(file_path, std::ios::binary);
+            if (!file)
+                return detail::make_error("Could not open config file \"", file_path.string(), '"');
+            std::stringstream text;
+            text << file.rdbuf();
+
+            // Constructed in place, since moving an Args may move the buffer its arguments point to.
+            std::unique_ptr<Args const> arguments(new Args const(Args::from_command_line(detail::remove_comment_lines(text.str()))));
+            auto parsed = parser.parse(*arguments);
+            if (!parsed)
+                return detail::make_error("Could not reload config file \"", file_path.string(), "\":\n\t", parsed.error());
+
+            std::lock_guard const lock(publish_mutex);
+            if (!snapshots.publish(std::move(arguments), std::move(*parsed)))
+                return detail::make_error("Could not reload config file \"", file_path.string(), "\": too many old snapshots are still in use");
+            return success;
+        }
+
+        std::filesystem::path const & path() const noexcept { return file_path; }
+
+    private:
+        P parser;
+        std::filesystem::path file_path;
+        std::mutex publish_mutex;
+        detail::snapshot_cell<parse_result_type> snapshots;
+    };
+
+#if defined(__linux__)
+
+    // Reloads a configuration from a background thread whenever a write to its file is finished, or another file is moved over it, and when
+    // request_reload is called. Errors, including a failure to watch the file, are reported through the callback, from the background thread.
+    struct ConfigWatcher
+    {
+        template <Parser P>
+        ConfigWatcher(ReloadableConfig<P> & config, std::function<void(std::string const &)> on_error)
+        {
+            wake_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+            inotify_fd = inotify_init1(IN_CLOEXEC | IN_NONBLOCK);
+            // Editors often replace the file instead of writing to it, so the directory is watched and events are filtered by name. Creating
+            // the file is not a change, since it is still empty. Its contents are read when the writer closes it.
+            std::filesystem::path const directory = config.path().has_parent_path() ? config.path().parent_path() : std::filesystem::path(".");
+            if (wake_fd < 0 || inotify_fd < 0 || inotify_add_watch(inotify_fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0)
+            {
+                on_error(detail::make_error("Could not watch config file \"", config.path().string(), '"').value);
+                return;
+            }
+
+            thread = std::jthread([this, &config, on_error = std::move(on_error), file_name = config.path().filename().string()](std::stop_token stop)
+            {
+                while (!stop.stop_requested())
+                {
+                    if (wait_for_change(file_name) && !stop.stop_requested())
+                        if (auto const reloaded = config.reload(); !reloaded)
+                            on_error(reloaded.error());
+                }
+            });
+        }
+
+        ConfigWatcher(ConfigWatcher const &) = delete;
+        ConfigWatcher & operator = (ConfigWatcher const &) = delete;
+
+        ~ConfigWatcher()
+        {
+            if (thread.joinable())
+            {
+                thread.request_stop();
+                request_reload();
+                thread.join();
+            }
+            if (inotify_fd >= 0) close(inotify_fd);
+            if (wake_fd >= 0) close(wake_fd);
+        }
+
+        // Async signal safe, so it can be called from a SIGHUP handler.
+        void request_reload() const noexcept
+        {
+            uint64_t const one = 1;
+            [[maybe_unused]] auto const written = write(wake_fd, &one, sizeof(one));
+        }
+
+    private:
+        // Blocks until the file changes or a reload is requested, and returns true if the configuration should be reloaded.
+        bool wait_for_change(std::string_view file_name) const noexcept
+        {
+            pollfd fds[2] = {{wake_fd, POLLIN, 0}, {inotify_fd, POLLIN, 0}};
+            if (poll(fds, 2, -1) <= 0)
+                return false;
+
+            bool reload = false;
+            if (fds[0].revents & POLLIN)
+            {
+                uint64_t count;
+                reload = read(wake_fd, &count, sizeof(count)) == sizeof(count);
+            }
+            if (fds[1].revents & POLLIN)
+            {
+                alignas(inotify_event) char buffer[4096];
+                for (ssize_t length; (length = read(inotify_fd, buffer, sizeof(buffer))) > 0; )
+                {
+                    for (char const * event_start = buffer; event_start < buffer + length; )
+                    {
+                        inotify_event const * event = reinterpret_cast<inotify_event const *>(event_start);
+                        if (event->len > 0 && std::string_view(event->name) == file_name)
+                            reload = true;
+                        event_start += sizeof(inotify_event) + event->len;
+                    }
+                }
+            }
+            return reload;
+        }
+
+        int wake_fd = -1;
+        int inotify_fd = -1;
+        std::jthread thread;
+    };
+
+#endif // defined(__linux__)
+
+} // namespace dodo
@@ -0,0 +1,544 @@
+#pragma once
+
+#include "diff.hh"
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <span>
+
+#if defined(__linux__)
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+// Parse results written to a block of memory that other processes can map and read in place, for servers that parse their configuration once
+// and share it with many workers. The block holds no pointers, only offsets from its start, so it can be mapped at any address. Reading it
+// only checks a header and the bounds of each field, so its cost does not depend on the size of the values. dodo::SharedConfigView reads
+// the fields of a result from a block: numbers and enums are read in place, strings as std::string_view, ranges of numbers, enums or arrays
+// of those as std::span and ranges of strings as dodo::shared_string_list. Other types may hold pointers into the writing process and do
+// not compile. On Linux, dodo::publish_shared writes the block to a sealed memfd and
+// dodo::open_shared maps it in a worker.
+//
+// auto const shared = dodo::publish_shared(cli, config);  // In the master, before forking.
+// auto const view = shared->view();                        // In a worker. Or dodo::open_shared(cli, fd) after exec.
+// listen(view.get<&ServerConfig::port>());
+
+namespace dodo
+{
+
+    namespace detail
+    {
+        struct shared_header
+        {
+            uint64_t magic;
+            // Hash of the types of the fields, so that a block is not read with a parser different from the one that wrote it.
+            uint64_t layout_hash;
+            uint64_t size;
+            uint64_t field_count;
+            // Followed by the offset of each field.
+        };
+
+        // Strings, ranges and lists of strings. The offset is from the start of the block.
+        struct shared_array
+        {
+            uint64_t size;
+            uint64_t offset;
+        };
+
+        constexpr uint64_t shared_magic = 0x316766636f646f64; // "dodocfg1" in little endian.
+
+        template <typename T>
+        constexpr bool shared_as_string = std::is_convertible_v<T const &, std::string_view>;
+
+        template <typename T>
+        constexpr bool shared_as_string_list = false;
+
+        template <typename T> requires std::ranges::sized_range<T const>
+        constexpr bool shared_as_string_list<T> = shared_as_string<std::ranges::range_value_t<T const>>;
+
+        // Only types that are known to hold no pointers are copied into the block as they are. A trivially copyable type may still hold
+        // std::string_view or other pointers into the memory of the process that wrote it, which would dangle in any other process.
+        template <typename T>
+        constexpr bool shared_in_place = std::is_arithmetic_v<T> || std::is_enum_v<T>;
+
+        template <typename T, size_t N>
+        constexpr bool shared_in_place<T[N]> = shared_in_place<T>;
+
+        template <typename T, size_t N>
+        constexpr bool shared_in_place<std::array<T, N>> = shared_in_place<T>;
+
+        template <typename T>
+        constexpr bool shared_as_span = false;
+
+        template <typename T> requires std::ranges::sized_range<T const>
+        constexpr bool shared_as_span<T> = shared_in_place<std::ranges::range_value_t<T const>>;
+
+        // How a field is stored. Strings and ranges are checked first, so that an array of strings is stored as a list of strings and an
+        // array of numbers as a span, never in place.
+        enum class shared_storage { string, string_list, span, in_place, unsupported };
+
+        template <typename T>
+        constexpr shared_storage shared_storage_of = shared_as_string<T> ? shared_storage::string
+            : shared_as_string_list<T> ? shared_storage::string_list
+            : shared_as_span<T> ? shared_storage::span
+            : shared_in_place<T> ? shared_storage::in_place
+            : shared_storage::unsupported;
+
+        // Computes the layout of a block and, if it has memory to write to, writes it.
+        struct shared_writer
+        {
+            size_t allocate(size_t bytes, size_t alignment) noexcept
+            {
+                size = (size + alignment - 1) / alignment * alignment;
+                size_t const at = size;
+                size += bytes;
+                return at;
+            }
+
+            void write(size_t at, void const * data, size_t bytes) noexcept
+            {
+                if (out && bytes > 0)
+                    std::memcpy(out + at, data, bytes);
+            }
+
+            size_t write_array(uint64_t count, uint64_t offset) noexcept
+            {
+                shared_array const array = {count, offset};
+                size_t const at = allocate(sizeof(array), alignof(shared_array));
+                write(at, &array, sizeof(array));
+                return at;
+            }
+
+            // Returns the offset of the value, or of the shared_array that describes it.
+            template <typename T>
+            size_t write_value(T const & value) noexcept
+            {
+                static_assert(shared_storage_of<T> != shared_storage::unsupported,
+                    "Shared configurations support numbers, enums, strings, and ranges and arrays of those.");
+
+                if constexpr (shared_storage_of<T> == shared_storage::string)
+                {
+                    std::string_view const text = value;
+                    size_t const data = allocate(text.size(), 1);
+                    write(data, text.data(), text.size());
+                    return write_array(text.size(), data);
+                }
+                else if constexpr (shared_storage_of<T> == shared_storage::string_list)
+                {
+                    size_t const count = std::ranges::size(value);
+                    size_t const entries = allocate(count * sizeof(shared_array), alignof(shared_array));
+                    size_t i = 0;
+                    for (auto const & element : value)
+                    {
+                        std::string_view const text = element;
+                        size_t const data = allocate(text.size(), 1);
+                        write(data, text.data(), text.size());
+                        shared_array const entry = {text.size(), data};
+                        write(entries + i++ * sizeof(shared_array), &entry, sizeof(entry));
+                    }
+                    return write_array(count, entries);
+                }
+                else if constexpr (shared_storage_of<T> == shared_storage::span)
+                {
+                    using element_type = std::ranges::range_value_t<T const>;
+                    size_t const count = std::ranges::size(value);
+                    size_t const data = allocate(count * sizeof(element_type), alignof(element_type));
+                    size_t i = 0;
+                    for (auto const & element : value)
+                    {
+                        element_type const copy = element;
+                        write(data + i++ * sizeof(element_type), &copy, sizeof(element_type));
+                    }
+                    return write_array(count, data);
+                }
+                else
+                {
+                    size_t const at = allocate(sizeof(T), alignof(T));
+                    write(at, std::addressof(value), sizeof(T));
+                    return at;
+                }
+            }
+
+            std::byte * out = nullptr;
+            size_t size = 0;
+        };
+
+        template <typename Result, typename ... Parts>
+        size_t write_shared_fields(shared_writer & writer, Result const & result, field_list<Parts...>) noexcept
+        {
+            size_t const header = writer.allocate(sizeof(shared_header) + sizeof...(Parts) * sizeof(uint64_t), alignof(shared_header));
+            uint64_t field_offsets[sizeof...(Parts) + 1] = {writer.write_value(field_value<Parts>(result))...};
+            writer.write(header + sizeof(shared_header), field_offsets, sizeof...(Parts) * sizeof(uint64_t));
+            return header;
+        }
+
+        template <typename ... Parts>
+        constexpr uint64_t shared_layout_hash(field_list<Parts...>) noexcept
+        {
+            // FNV-1a of the names of the types, as in content_hash, but usable in constant expressions.
+            uint64_t hash = 0xcbf29ce484222325;
+            auto const add = [&hash](std::string_view text)
+            {
+                for (char const c : text)
+                {
+                    hash ^= static_cast<unsigned char>(c);
+                    hash *= 0x100000001b3;
+                }
+                hash ^= ';';
+                hash *= 0x100000001b3;
+            };
+            (add(type_name<typename Parts::value_type>()), ...);
+            return hash;
+        }
+
+        template <size_t I, typename Fields>
+        struct field_at;
+
+        template <size_t I, typename First, typename ... Rest>
+        struct field_at<I, field_list<First, Rest...>> : field_at<I - 1, field_list<Rest...>> {};
+
+        template <typename First, typename ... Rest>
+        struct field_at<0, field_list<First, Rest...>>
+        {
+            using value_type = typename First::value_type;
+        };
+
+        template <auto Member, typename Part>
+        constexpr bool is_bound_to() noexcept
+        {
+            if constexpr (MemberBound<Part>)
+                if constexpr (std::is_same_v<std::remove_cv_t<decltype(Part::member)>, decltype(Member)>)
+                    return Part::member == Member;
+            return false;
+        }
+
+        // Index of the field of the option bound to the member.
+        template <auto Member, typename ... Parts>
+        constexpr size_t field_with_member(field_list<Parts...>) noexcept
+        {
+            size_t index = 0;
+            bool const found = ((is_bound_to<Member, Parts>() || (++index, false)) || ...);
+            return found ? index : sizeof...(Parts);
+        }
+    } // namespace detail
+
+    // A list of strings in a shared block.
+    struct shared_string_list
+    {
+        struct iterator
+        {
+            using value_type = std::string_view;
+            using difference_type = ptrdiff_t;
+
+            // Entries are checked as they are read, so that opening a block does not take longer for longer lists. An entry that points
+            // outside of the block reads as an empty string.
+            std::string_view operator * () const noexcept
+            {
+                if (entry->offset > block_size || entry->size > block_size - entry->offset)
+                    return std::string_view();
+                return std::string_view(reinterpret_cast<char const *>(base + entry->offset), entry->size);
+            }
+            iterator & operator ++ () noexcept { ++entry; return *this; }
+            iterator operator ++ (int) noexcept { iterator const old = *this; ++entry; return old; }
+            bool operator == (iterator const & other) const noexcept { return entry == other.entry; }
+
+            std::byte const * base;
+            size_t block_size;
+            detail::shared_array const * entry;
+        };
+
+        size_t size() const noexcept { return entries.size(); }
+        bool empty() const noexcept { return entries.empty(); }
+        std::string_view operator [] (size_t i) const noexcept { return *iterator{base, block_size, &entries[i]}; }
+        iterator begin() const noexcept { return iterator{base, block_size, entries.data()}; }
+        iterator end() const noexcept { return iterator{base, block_size, entries.data() + entries.size()}; }
+
+        std::byte const * base;
+        size_t block_size;
+        std::span<detail::shared_array const> entries;
+    };
+
+    namespace detail
+    {
+        template <typename T>
+        struct shared_field_type
+        {
+            using type = T const &;
+        };
+
+        template <typename T> requires(shared_storage_of<T> == shared_storage::string)
+        struct shared_field_type<T>
+        {
+            using type = std::string_view;
+        };
+
+        template <typename T> requires(shared_storage_of<T> == shared_storage::string_list)
+        struct shared_field_type<T>
+        {
+            using type = shared_string_list;
+        };
+
+        template <typename T> requires(shared_storage_of<T> == shared_storage::span)
+        struct shared_field_type<T>
+        {
+            using type = std::span<std::ranges::range_value_t<T const> const>;
+        };
+    } // namespace detail
+
+    namespace detail
+    {
+        inline uint64_t shared_field_offset(std::span<std::byte const> block, size_t field) noexcept
+        {
+            uint64_t offset;
+            std::memcpy(&offset, block.data() + sizeof(shared_header) + field * sizeof(uint64_t), sizeof(offset));
+            return offset;
+        }
+
+        inline bool shared_range_fits(std::span<std::byte const> block, uint64_t offset, uint64_t count, size_t element_size, size_t alignment) noexcept
+        {
+            return offset <= block.size() && count <= (block.size() - offset) / element_size && offset % alignment == 0;
+        }
+
+        // Whether the field of type T at offset, and the data it points to, are in the block and aligned for their type, so that get reads
+        // nothing outside of it. Only the entries of lists of strings are left to be checked when they are read.
+        template <typename T>
+        bool shared_field_fits(std::span<std::byte const> block, uint64_t offset) noexcept
+        {
+            if constexpr (shared_storage_of<T> == shared_storage::in_place)
+                return shared_range_fits(block, offset, 1, sizeof(T), alignof(T));
+            else
+            {
+                if (!shared_range_fits(block, offset, 1, sizeof(shared_array), alignof(shared_array)))
+                    return false;
+
+                shared_array array;
+                std::memcpy(&array, block.data() + offset, sizeof(array));
+                if constexpr (shared_storage_of<T> == shared_storage::string)
+                    return shared_range_fits(block, array.offset, array.size, 1, 1);
+                else if constexpr (shared_storage_of<T> == shared_storage::string_list)
+                    return shared_range_fits(block, array.offset, array.size, sizeof(shared_array), alignof(shared_array));
+                else
+                {
+                    using element_type = std::ranges::range_value_t<T const>;
+                    return shared_range_fits(block, array.offset, array.size, sizeof(element_type), alignof(element_type));
+                }
+            }
+        }
+
+        template <typename ... Parts>
+        bool shared_fields_fit(std::span<std::byte const> block, field_list<Parts...>) noexcept
+        {
+            if (block.size() < sizeof(shared_header) + sizeof...(Parts) * sizeof(uint64_t))
+                return false;
+
+            size_t field = 0;
+            return (shared_field_fits<typename Parts::value_type>(block, shared_field_offset(block, field++)) && ...);
+        }
+    } // namespace detail
+
+    // Type through which a field of type T is read from a shared block.
+    template <typename T>
+    using shared_field_t = typename detail::shared_field_type<T>::type;
+
+    // Size of the block that write_shared writes for this result.
+    template <typename P>
+    size_t shared_size(P const & parser, typename P::parse_result_type const & result) noexcept
+    {
+        static_cast<void>(parser);
+        detail::shared_writer writer;
+        detail::write_shared_fields(writer, result, detail::fields_t<P>());
+        return writer.size;
+    }
+
+    // out must be at least shared_size bytes and aligned to 8 bytes.
+    template <typename P>
+    void write_shared(P const & parser, typename P::parse_result_type const & result, std::span<std::byte> out) noexcept
+    {
+        static_cast<void>(parser);
+        detail::shared_writer writer{out.data()};
+        detail::write_shared_fields(writer, result, detail::fields_t<P>());
+        detail::shared_header const header = {detail::shared_magic, detail::shared_layout_hash(detail::fields_t<P>()), writer.size, field_count<P>};
+        writer.write(0, &header, sizeof(header));
+    }
+
+    // Reads the fields of a result from a shared block. Does not own the block.
+    template <typename P>
+    struct SharedConfigView
+    {
+        // Field by index, as given by dodo::field_index.
+        template <size_t I>
+        auto get() const noexcept -> shared_field_t<typename detail::field_at<I, detail::fields_t<P>>::value_type>
+        {
+            using T = typename detail::field_at<I, detail::fields_t<P>>::value_type;
+
+            std::byte const * const field = block.data() + detail::shared_field_offset(block, I);
+
+            if constexpr (detail::shared_storage_of<T> == detail::shared_storage::string)
+            {
+                auto const & array = *reinterpret_cast<detail::shared_array const *>(field);
+                return std::string_view(reinterpret_cast<char const *>(block.data() + array.offset), array.size);
+            }
+            else if constexpr (detail::shared_storage_of<T> == detail::shared_storage::in_place)
+                return *std::launder(reinterpret_cast<T const *>(field));
+            else
+            {
+                auto const & array = *reinterpret_cast<detail::shared_array const *>(field);
+                if constexpr (detail::shared_storage_of<T> == detail::shared_storage::string_list)
+                    return shared_string_list{block.data(), block.size(), {reinterpret_cast<detail::shared_array const *>(block.data() + array.offset), array.size}};
+                else
+                {
+                    using element_type = typename shared_field_t<T>::element_type;
+                    return shared_field_t<T>{reinterpret_cast<element_type const *>(block.data() + array.offset), array.size};
+                }
+            }
+        }
+
+        // Field of an option bound to a member, as in view.get<&Config::port>().
+        template <auto Member> requires std::is_member_object_pointer_v<decltype(Member)>
+        auto get() const noexcept -> decltype(auto)
+        {
+            constexpr size_t index = detail::field_with_member<Member>(detail::fields_t<P>());
+            static_assert(index < field_count<P>, "No option of the parser is bound to this member.");
+            return get<index>();
+        }
+
+        std::span<std::byte const> block;
+    };
+
+    // Fails if the block is smaller than its header says, was written for a parser whose fields have different types, or has fields that
+    // point outside of it. Takes time proportional to the number of fields, not to the size of their values.
+    template <typename P>
+    auto view_shared(P const & parser, std::span<std::byte const> block) noexcept -> expected<SharedConfigView<P>, std::string>
+    {
+        static_cast<void>(parser);
+
+        detail::shared_header header;
+        if (block.size() < sizeof(header))
+            return detail::make_error("Shared configuration is too small");
+        std::memcpy(&header, block.data(), sizeof(header));
+        if (header.magic != detail::shared_magic)
+            return detail::make_error("Shared configuration has no valid header");
+        if (header.layout_hash != detail::shared_layout_hash(detail::fields_t<P>()) || header.field_count != field_count<P>)
+            return detail::make_error("Shared configuration was written by a different parser");
+        if (header.size > block.size())
+            return detail::make_error("Shared configuration is truncated");
+        if (!detail::shared_fields_fit(block.first(header.size), detail::fields_t<P>()))
+            return detail::make_error("Shared configuration has fields outside of it");
+        return SharedConfigView<P>{block.first(header.size)};
+    }
+
+#if defined(__linux__)
+
+    // A read only mapping of a shared configuration in a memfd. The memfd is sealed, so no process can change or resize it once published.
+    // Processes forked after publish_shared inherit the mapping. The descriptor is inherited across exec, so other programs can map it
+    // with open_shared.
+    template <typename P>
+    struct SharedConfig
+    {
+        SharedConfig(SharedConfig && other) noexcept
+            : descriptor(std::exchange(other.descriptor, -1))
+            , mapping(std::exchange(other.mapping, nullptr))
+            , mapping_size(std::exchange(other.mapping_size, 0))
+            , view_(other.view_)
+        {}
+
+        SharedConfig & operator = (SharedConfig other) noexcept
+        {
+            std::swap(descriptor, other.descriptor);
+            std::swap(mapping, other.mapping);
+            std::swap(mapping_size, other.mapping_size);
+            std::swap(view_, other.view_);
+            return *this;
+        }
+
+        ~SharedConfig()
+        {
+            if (mapping) munmap(mapping, mapping_size);
+            if (descriptor >= 0) close(descriptor);
+        }
+
+        SharedConfigView<P> view() const noexcept { return view_; }
+        int fd() const noexcept { return descriptor; }
+
+    private:
+        SharedConfig(int descriptor_, void * mapping_, size_t mapping_size_, SharedConfigView<P> view__) noexcept
+            : descriptor(descriptor_), mapping(mapping_), mapping_size(mapping_size_), view_(view__)
+        {}
+
+        int descriptor;
+        void * mapping;
+        size_t mapping_size;
+        SharedConfigView<P> view_;
+
+        template <typename Q> friend auto open_shared(Q const & parser, int fd) -> expected<SharedConfig<Q>, std::string>;
+    };
+
+    // Maps a shared configuration from a memfd, such as one published by publish_shared in a parent process. Takes ownership of the descriptor.
+    template <typename P>
+    auto open_shared(P const & parser, int fd) -> expected<SharedConfig<P>, std::string>
+    {
+        struct stat status;
+        if (fstat(fd, &status) != 0 || status.st_size <= 0)
+        {
+            close(fd);
+            return detail::make_error("Could not read the size of the shared configuration");
+        }
+
+        size_t const size = static_cast<size_t>(status.st_size);
+        void * const mapping = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        if (mapping == MAP_FAILED)
+        {
+            close(fd);
+            return detail::make_error("Could not map the shared configuration");
+        }
+
+        auto view = view_shared(parser, std::span(static_cast<std::byte const *>(mapping), size));
+        if (!view)
+        {
+            munmap(mapping, size);
+            close(fd);
+            return Error(std::move(view.error()));
+        }
+        return SharedConfig<P>(fd, mapping, size, *view);
+    }
+
+    // Writes a result to a new memfd, seals it and maps it read only.
+    template <typename P>
+    auto publish_shared(P const & parser, typename P::parse_result_type const & result) -> expected<SharedConfig<P>, std::string>
+    {
+        size_t const size = shared_size(parser, result);
+
+        int const fd = memfd_create("dodo-shared-config", MFD_ALLOW_SEALING);
+        if (fd < 0)
+            return detail::make_error("Could not create the shared configuration");
+
+        if (ftruncate(fd, static_cast<off_t>(size)) != 0)
+        {
+            close(fd);
+            return detail::make_error("Could not allocate ", std::to_string(size), " bytes for the shared configuration");
+        }
+
+        void * const writable = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (writable == MAP_FAILED)
+        {
+            close(fd);
+            return detail::make_error("Could not map the shared configuration");
+        }
+        write_shared(parser, result, std::span(static_cast<std::byte *>(writable), size));
+        munmap(writable, size);
+
+        // Sealing for writes needs no writable mapping to exist, so the block is written through a mapping that is then replaced.
+        if (fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL) != 0)
+        {
+            close(fd);
+            return detail::make_error("Could not seal the shared configuration");
+        }
+
+        return open_shared(parser, fd);
+    }
+
+#endif // defined(__linux__)
+
+} // namespace dodo
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "parse_traits.hh"
+#include <array>
+#include <concepts>
+#include <initializer_list>
+
+namespace dodo
+{
+
+	// Vector of up to N elements stored inline, so that it never allocates. All N elements are constructed up front, so T must be default
+	// constructible. Parsed from values separated by spaces, as std::vector, and giving more than N values is an error.
+	template <std::default_initializable T, size_t N>
+	struct static_vector
+	{
+		using value_type = T;
+		using iterator = T *;
+		using const_iterator = T const *;
+
+		constexpr static_vector() noexcept = default;
+
+		constexpr static_vector(std::initializer_list<T> values) noexcept
+			: static_vector(values.begin(), values.end())
+		{}
+
+		// Allows static_vector to be used with by_default_range and implicitly_range.
+		constexpr static_vector(T const * first, T const * last) noexcept
+		{
+			for (; first != last; ++first)
+				push_back(*first);
+		}
+
+		constexpr iterator begin() noexcept { return elements.data(); }
+		constexpr iterator end() noexcept { return elements.data() + count; }
+		constexpr const_iterator begin() const noexcept { return elements.data(); }
+		constexpr const_iterator end() const noexcept { return elements.data() + count; }
+
+		constexpr T * data() noexcept { return elements.data(); }
+		constexpr T const * data() const noexcept { return elements.data(); }
+		constexpr size_t size() const noexcept { return count; }
+		constexpr bool empty() const noexcept { return count == 0; }
+		static constexpr size_t capacity() noexcept { return N; }
+
+		constexpr T & operator [] (size_t i) noexcept { assert(i < count); return elements[i]; }
+		constexpr T const & operator [] (size_t i) const noexcept { assert(i < count); return elements[i]; }
+
+		// Returns false if the vector is full.
+		constexpr bool try_push_back(T value) noexcept
+		{
+			if (count == N)
+				return false;
+			elements[count++] = std::move(value);
+			return true;
+		}
+
+		constexpr void push_back(T value) noexcept
+		{
+			[[maybe_unused]] bool const pushed = try_push_back(std::move(value));
+			assert(pushed);
+		}
+
+		constexpr void clear() noexcept { count = 0; }
+
+		constexpr bool operator == (static_vector const & other) const noexcept
+		{
+			if (count != other.count)
+				return false;
+			for (size_t i = 0; i < count; ++i)
+				if (!(elements[i] == other.elements[i]))
+					return false;
+			return true;
+		}
+
+	private:
+		std::array<T, N> elements = {};
+		size_t count = 0;
+	};
+
+	template <typename T, size_t N>
+	struct parse_traits<static_vector<T, N>>
+	{
+		static constexpr std::optional<static_vector<T, N>> parse(std::string_view text) noexcept
+		{
+			static_vector<T, N> v;
+
+			bool const parsed = detail::parse_space_separated<T>(text, [&v](T && elem)
+			{
+				return v.try_push_back(std::move(elem));
+			});
+
+			if (!parsed)
+				return std::nullopt;
+			return v;
+		}
+
+		static std::string parse_error(std::string_view text)
+		{
+			size_t const count = detail::count_space_separated(text);
+			if (count > N)
+				return "Expected at most " + std::to_string(N) + " values, found " + std::to_string(count);
+			else
+				return std::string();
+		}
+
+		static std::string to_string(static_vector<T, N> const & v)
+		{
+			return detail::join_space_separated(v);
+		}
+
+		static constexpr std::span<std::string_view const> value_names() noexcept requires TraitEnumerable<T>
+		{
+			return parse_traits<T>::value_names();
+		}
+	};
+
+} // namespace dodo
@@ -0,0 +1,246 @@
+#pragma once
+
+#include "parse_traits.hh"
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+
+namespace dodo
+{
+
+	// Amount of bytes. Parsed from a number followed by an optional unit. Units can be SI (kB, MB, GB, TB, PB, EB), which are powers of 1000,
+	// or IEC (KiB, MiB, GiB, TiB, PiB, EiB), which are powers of 1024. The trailing B may be omitted, and k and K are equivalent. The number may
+	// have a fractional part, as long as the result is a whole number of bytes. 1.5KiB is 1536 bytes, 1.5B is an error.
+	struct byte_size
+	{
+		uint64_t bytes = 0;
+
+		constexpr bool operator == (byte_size const & other) const noexcept = default;
+	};
+
+	// Bits per second. Parsed from a number followed by a unit. Units can be in bits per second (bps, kbps, Mbps, Gbps, Tbps, also written bit/s,
+	// kbit/s...) or in bytes per second (B/s, kB/s, KiB/s, MB/s, MiB/s...), which are converted to bits per second. A number without unit is in
+	// bits per second, so 10M is the same as 10Mbps.
+	struct bit_rate
+	{
+		uint64_t bits_per_second = 0;
+
+		constexpr bool operator == (bit_rate const & other) const noexcept = default;
+	};
+
+	namespace detail
+	{
+		// Number with a fractional part, as digits / scale, where scale is a power of 10.
+		struct unsigned_decimal
+		{
+			uint64_t digits;
+			uint64_t scale;
+		};
+
+		constexpr uint64_t power(uint64_t base, int exponent) noexcept
+		{
+			uint64_t result = 1;
+			for (int i = 0; i < exponent; ++i)
+				result *= base;
+			return result;
+		}
+
+		constexpr std::optional<uint64_t> checked_multiply(uint64_t a, uint64_t b) noexcept
+		{
+			if (b > 1 && a > std::numeric_limits<uint64_t>::max() / b)
+				return std::nullopt;
+			else
+				return a * b;
+		}
+
+		// Accumulates the digits at the beginning of the text into value, and returns how many were read. Returns -1 on overflow.
+		constexpr int accumulate_digits(std::string_view text, uint64_t & value) noexcept
+		{
+			// Overflow is checked against constants to avoid a division per digit.
+			constexpr uint64_t max_before_last_digit = std::numeric_limits<uint64_t>::max() / 10;
+			constexpr unsigned max_last_digit = std::numeric_limits<uint64_t>::max() % 10;
+
+			size_t i = 0;
+			for (; i < text.size(); ++i)
+			{
+				unsigned const digit = static_cast<unsigned char>(text[i]) - unsigned('0');
+				if (digit > 9)
+					break;
+				if (value > max_before_last_digit || (value == max_before_last_digit && digit > max_last_digit))
+					return -1;
+				value = value * 10 + digit;
+			}
+			return static_cast<int>(i);
+		}
+
+		// Parses [0-9]+(.[0-9]+)? from the beginning of the text and removes it from the text.
+		constexpr std::optional<unsigned_decimal> parse_unsigned_decimal(std::string_view & text) noexcept
+		{
+			unsigned_decimal result = {0, 1};
+
+			int const integer_digits = accumulate_digits(text, result.digits);
+			if (integer_digits <= 0)
+				return std::nullopt;
+			text.remove_prefix(static_cast<size_t>(integer_digits));
+
+			if (!text.empty() && text[0] == '.')
+			{
+				text.remove_prefix(1);
+				int const fractional_digits = accumulate_digits(text, result.digits);
+				if (fractional_digits <= 0 || fractional_digits > std::numeric_limits<uint64_t>::digits10)
+					return std::nullopt;
+				text.remove_prefix(static_cast<size_t>(fractional_digits));
+				result.scale = power(10, fractional_digits);
+			}
+
+			return result;
+		}
+
+		// Multiplies a decimal by an integer. Fails if the result overflows or is not a whole number.
+		constexpr std::optional<uint64_t> scale_decimal(unsigned_decimal number, uint64_t multiplier) noexcept
+		{
+			if (number.scale == 1)
+				return checked_multiply(number.digits, multiplier);
+
+			uint64_t const common = std::gcd(multiplier, number.scale);
+			multiplier /= common;
+			number.scale /= common;
+
+			if (number.digits % number.scale != 0)
+				return std::nullopt;
+
+			return checked_multiply(number.digits / number.scale, multiplier);
+		}
+
+		// Exponent of a metric prefix letter. 0 if it is not a prefix.
+		constexpr int unit_prefix_exponent(char c) noexcept
+		{
+			switch (c)
+			{
+				case 'k': case 'K': return 1;
+				case 'M': return 2;
+				case 'G': return 3;
+				case 'T': return 4;
+				case 'P': return 5;
+				case 'E': return 6;
+				default: return 0;
+			}
+		}
+
+		// Parses an optional SI or IEC prefix from the beginning of the text and removes it from the text. Returns the multiplier.
+		constexpr uint64_t parse_unit_prefix(std::string_view & text) noexcept
+		{
+			if (text.empty())
+				return 1;
+
+			int const exponent = unit_prefix_exponent(text[0]);
+			if (exponent == 0)
+				return 1;
+
+			if (text.size() > 1 && text[1] == 'i')
+			{
+				text.remove_prefix(2);
+				return power(1024, exponent);
+			}
+			else
+			{
+				text.remove_prefix(1);
+				return power(1000, exponent);
+			}
+		}
+
+		struct unit_name
+		{
+			std::string_view name;
+			uint64_t multiplier;
+		};
+
+		// Writes the value with the unit that gives the smallest whole number. The first unit is used for 0.
+		template <size_t N>
+		std::string to_string_with_units(uint64_t value, std::array<unit_name, N> const & units)
+		{
+			unit_name const * best = &units[0];
+			if (value != 0)
+				for (unit_name const & unit : units)
+					if (value % unit.multiplier == 0 && unit.multiplier > best->multiplier)
+						best = &unit;
+
+			std::string result = std::to_string(value / best->multiplier);
+			result += best->name;
+			return result;
+		}
+	} // namespace detail
+
+	template <>
+	struct parse_traits<byte_size>
+	{
+		static constexpr std::string_view hint = "size";
+
+		static constexpr std::optional<byte_size> parse(std::string_view text) noexcept
+		{
+			std::optional<detail::unsigned_decimal> const number = detail::parse_unsigned_decimal(text);
+			if (!number)
+				return std::nullopt;
+
+			uint64_t const multiplier = detail::parse_unit_prefix(text);
+			if (text == "B")
+				text.remove_prefix(1);
+			if (!text.empty())
+				return std::nullopt;
+
+			std::optional<uint64_t> const bytes = detail::scale_decimal(*number, multiplier);
+			if (!bytes)
+				return std::nullopt;
+
+			return byte_size{*bytes};
+		}
+
+		static std::string to_string(byte_size size)
+		{
+			static constexpr std::array<detail::unit_name, 13> units = {{
+				{"B", 1},
+				{"EiB", detail::power(1024, 6)}, {"PiB", detail::power(1024, 5)}, {"TiB", detail::power(1024, 4)},
+				{"GiB", detail::power(1024, 3)}, {"MiB", detail::power(1024, 2)}, {"KiB", 1024},
+				{"EB", detail::power(1000, 6)}, {"PB", detail::power(1000, 5)}, {"TB", detail::power(1000, 4)},
+				{"GB", detail::power(1000, 3)}, {"MB", detail::power(1000, 2)}, {"kB", 1000},
+			}};
+			return detail::to_string_with_units(size.bytes, units);
+		}
+	};
+
+	template <>
+	struct parse_traits<bit_rate>
+	{
+		static constexpr std::string_view hint = "rate";
+
+		static constexpr std::optional<bit_rate> parse(std::string_view text) noexcept
+		{
+			std::optional<detail::unsigned_decimal> const number = detail::parse_unsigned_decimal(text);
+			if (!number)
+				return std::nullopt;
+
+			uint64_t multiplier = detail::parse_unit_prefix(text);
+			if (text == "B/s")
+				multiplier *= 8;
+			else if (!text.empty() && text != "bps" && text != "bit/s")
+				return std::nullopt;
+
+			std::optional<uint64_t> const bits = detail::scale_decimal(*number, multiplier);
+			if (!bits)
+				return std::nullopt;
+
+			return bit_rate{*bits};
+		}
+
+		static std::string to_string(bit_rate rate)
+		{
+			static constexpr std::array<detail::unit_name, 7> units = {{
+				{"bps", 1}, {"kbps", 1000}, {"Mbps", detail::power(1000, 2)}, {"Gbps", detail::power(1000, 3)},
+				{"Tbps", detail::power(1000, 4)}, {"Pbps", detail::power(1000, 5)}, {"Ebps", detail::power(1000, 6)},
+			}};
+			return detail::to_string_with_units(rate.bits_per_second, units);
+		}
+	};
+
+} // namespace dodo
@@ -0,0 +1,142 @@
+#pragma once
+
+#include "parse_traits.hh"
+#include <array>
+#include <concepts>
+#include <ranges>
+#include <type_traits>
+#include <utility>
+
+// Predicates for the common checks, to be given to .check(). They describe themselves in the help text and in the error message, and can be
+// used on options of vector types, in which case every element is checked. Elements are checked without early exit, so that the loop can be
+// vectorized by the compiler.
+
+namespace dodo
+{
+
+	namespace detail
+	{
+		template <typename Range, typename F>
+		constexpr bool all_elements(Range const & range, F f) noexcept
+		{
+			bool all = true;
+			for (auto const & element : range)
+				all &= f(element);
+			return all;
+		}
+
+		template <typename T, size_t N>
+		std::string join_values(std::array<T, N> const & values)
+		{
+			std::string result;
+			for (T const & value : values)
+			{
+				result += dodo::to_string(value);
+				result += ", ";
+			}
+			result.resize(result.size() - 2);
+			return result;
+		}
+
+		// Integer types that std::cmp_less_equal and the other safe comparisons take, which are all but bool and the character types.
+		template <typename T>
+		concept safely_comparable_integer = std::integral<T> && !std::same_as<T, bool> && !std::same_as<T, char> && !std::same_as<T, wchar_t>
+			&& !std::same_as<T, char8_t> && !std::same_as<T, char16_t> && !std::same_as<T, char32_t>;
+
+		template <typename T>
+		using validator_value_type = std::conditional_t<std::is_convertible_v<T, std::string_view>, std::string_view, T>;
+	} // namespace detail
+
+	// Value in the closed range [low, high].
+	template <typename T>
+	struct in_range
+	{
+		constexpr in_range(T low_, T high_) noexcept : low(low_), high(high_) { assert(low <= high); }
+
+		template <std::totally_ordered_with<T> U>
+		constexpr bool contains(U const & x) const noexcept
+		{
+			if constexpr (detail::safely_comparable_integer<U> && detail::safely_comparable_integer<T> && std::is_signed_v<U> == std::is_signed_v<T>)
+			{
+				// One comparison. Values under low wrap around to values over high - low. Only correct when both types have the same
+				// signedness, so that converting them to their common type keeps their values.
+				using C = std::make_unsigned_t<std::common_type_t<U, T>>;
+				return C(C(x) - C(low)) <= C(C(high) - C(low));
+			}
+			else if constexpr (detail::safely_comparable_integer<U> && detail::safely_comparable_integer<T>)
+				return std::cmp_less_equal(low, x) & std::cmp_less_equal(x, high);
+			else
+				return (low <= x) & (x <= high);
+		}
+
+		template <typename U>
+		constexpr bool operator () (U const & value) const noexcept
+		{
+			if constexpr (std::totally_ordered_with<U, T>)
+				return contains(value);
+			else
+				return detail::all_elements(value, [this](auto const & x) { return contains(x); });
+		}
+
+		std::string description() const { return "Range: [" + dodo::to_string(low) + ", " + dodo::to_string(high) + "]"; }
+		std::string error_message() const { return "Value must be in the range [" + dodo::to_string(low) + ", " + dodo::to_string(high) + "]."; }
+
+		T low;
+		T high;
+	};
+
+	// Value equal to one of a small set of values, compared one by one.
+	template <typename T, size_t N>
+	struct one_of
+	{
+		template <typename ... Ts>
+		constexpr explicit one_of(Ts ... values_) noexcept : values{T(values_)...} {}
+
+		template <std::equality_comparable_with<T> U>
+		constexpr bool contains(U const & x) const noexcept
+		{
+			bool found = false;
+			for (T const & value : values)
+				found |= (x == value);
+			return found;
+		}
+
+		template <typename U>
+		constexpr bool operator () (U const & value) const noexcept
+		{
+			if constexpr (std::equality_comparable_with<U, T>)
+				return contains(value);
+			else
+				return detail::all_elements(value, [this](auto const & x) { return contains(x); });
+		}
+
+		std::string description() const { return "Allowed values: " + detail::join_values(values); }
+		std::string error_message() const { return "Value must be one of: " + detail::join_values(values) + '.'; }
+
+		std::array<T, N> values;
+	};
+
+	template <typename T, typename ... Ts>
+	one_of(T, Ts...) -> one_of<detail::validator_value_type<T>, 1 + sizeof...(Ts)>;
+
+	// String of at most the given amount of characters.
+	struct max_len
+	{
+		constexpr explicit max_len(size_t length_) noexcept : length(length_) {}
+
+		template <typename U>
+		constexpr bool operator () (U const & value) const noexcept
+		{
+			if constexpr (std::is_convertible_v<U const &, std::string_view>)
+				return std::string_view(value).size() <= length;
+			else
+				return detail::all_elements(value, [this](auto const & x) { return std::string_view(x).size() <= length; });
+		}
+
+		std::string description() const { return "Maximum length: " + std::to_string(length); }
+		std::string error_message() const { return "Value must be at most " + std::to_string(length) + " characters long."; }
+
+		size_t length;
+	};
+
+} // namespace dodo